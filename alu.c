@@ -1,11 +1,14 @@
 #include "alu.h"
 
-#include <stdio.h>
-
 /* ── Shared constants ─────────────────────────────────────────────────────── */
 
-#define WORD_BITS   32u
-#define MSB_MASK    ((word_t)1u << 31)
+/*
+ * Bit 0 of every `period`-bit group of the word (period a power of two no
+ * larger than WORD_BITS): all-ones divided by the all-ones of one group.
+ * A constant expression, so masks built from it cost nothing at run time.
+ */
+#define EVERY(period) \
+    ((word_t)(WORD_MAX / (WORD_MAX >> (WORD_BITS - (period)))))
 
 /* ── Core ripple-carry adder (internal) ───────────────────────────────────── */
 
@@ -32,32 +35,437 @@ static word_t ripple_add(word_t a, word_t b, uint32_t carry_in, ALUFlags *f)
     uint32_t  carry  = carry_in & 1u;
 
     for (uint32_t i = 0; i < WORD_BITS; i++) {
-        uint32_t a_bit = (a >> i) & 1u;
-        uint32_t b_bit = (b >> i) & 1u;
+        uint32_t a_bit = (uint32_t)(a >> i) & 1u;
+        uint32_t b_bit = (uint32_t)(b >> i) & 1u;
 
         uint32_t sum_bit   = a_bit ^ b_bit ^ carry;
         uint32_t carry_out = (a_bit & b_bit) | (carry & (a_bit ^ b_bit));
 
-        result |= (word_t)(sum_bit << i);
+        result |= (word_t)((word_t)sum_bit << i);
         carry   = carry_out;
     }
 
-    /* Final carry out of bit 31 is the C flag. */
-    f->C = (uint8_t)(carry & 1u);
+    /*
+     * N: MSB of result (two's-complement sign bit).
+     * Z: all WORD_BITS result bits are 0.
+     * C: final carry out of the MSB.
+     */
+    f->nzcv = alu_nzcv((uint32_t)(result >> WORD_MSB) & 1u, result == 0u,
+                       carry & 1u, 0u);
+
+    return result;
+}
+
+/* ── Native adder (internal) ──────────────────────────────────────────────── */
+
+/*
+ * native_add — same contract as ripple_add, in a handful of instructions.
+ *
+ * Below 64 bits the sum is formed in a uint64_t so the carry out of the
+ * MSB lands in bit WORD_BITS.  A 64-bit word has no wider host type; its
+ * carry out is the majority of the operands' MSBs and the carry into the
+ * MSB (a ^ b ^ result there).  Either way: no branches, no per-bit loop.
+ */
+static word_t native_add(word_t a, word_t b, uint32_t carry_in, ALUFlags *f)
+{
+#if WORD_BITS < 64
+    uint64_t wide   = (uint64_t)a + (uint64_t)b + (uint64_t)(carry_in & 1u);
+    word_t   result = (word_t)wide;
+    uint32_t carry  = (uint32_t)(wide >> WORD_BITS) & 1u;
+#else
+    word_t   result = a + b + (word_t)(carry_in & 1u);
+    uint32_t carry  = (uint32_t)(((a & b) | ((a ^ b) & ~result)) >> WORD_MSB)
+                    & 1u;
+#endif
+    f->nzcv = alu_nzcv((uint32_t)(result >> WORD_MSB) & 1u, result == 0u,
+                       carry, 0u);
+
+    return result;
+}
+
+/* ── Table-driven adder (internal) ────────────────────────────────────────── */
 
-    /* Zero: all 32 result bits are 0. */
-    f->Z = (result == 0u) ? 1u : 0u;
+/*
+ * add8[c][x][y] = x + y + c for bytes x, y and carry-in c: the sum byte in
+ * bits 0-7, the carry out in bit 8.  Filled once, by ripple_add.
+ */
+static uint16_t add8[2][256][256];
+static int      add8_ready;
 
-    /* Negative: MSB of result (two's-complement sign bit). */
-    f->N = (uint8_t)((result >> 31) & 1u);
+static void table_init(void)
+{
+    if (add8_ready)
+        return;
+
+    for (uint32_t c = 0; c < 2; c++)
+        for (uint32_t x = 0; x < 256; x++)
+            for (uint32_t y = 0; y < 256; y++) {
+                ALUFlags f;
+                word_t   s = ripple_add((word_t)x, (word_t)y, c, &f);
+#if WORD_BITS == 8
+                uint32_t carry = alu_flag(f, ALU_FLAG_C);  /* bit 7 out */
+#else
+                uint32_t carry = (uint32_t)(s >> 8) & 1u;
+#endif
+                add8[c][x][y] = (uint16_t)((s & 0xFFu) | (carry << 8));
+            }
+    add8_ready = 1;
+}
+
+/*
+ * table_add — same contract as ripple_add, a byte per step: WORD_BITS/8
+ * lookups, each fed the previous one's carry out.
+ */
+static word_t table_add(word_t a, word_t b, uint32_t carry_in, ALUFlags *f)
+{
+    word_t   result = 0;
+    uint32_t carry  = carry_in & 1u;
+
+    for (uint32_t k = 0; k < WORD_BITS; k += 8) {
+        uint32_t e = add8[carry][(a >> k) & 0xFFu][(b >> k) & 0xFFu];
+
+        result |= (word_t)((word_t)(e & 0xFFu) << k);
+        carry   = e >> 8;
+    }
+
+    f->nzcv = alu_nzcv((uint32_t)(result >> WORD_MSB) & 1u, result == 0u,
+                       carry, 0u);
 
     return result;
 }
 
+/* ── Lookahead and parallel-prefix adders (internal) ──────────────────────── */
+
+/*
+ * Word-parallel models of the classic fast adders.  Each starts from the
+ * per-bit generate g = a & b and propagate p = a ^ b, combines them into
+ * group (G, P) signals with the prefix operator
+ *
+ *   (G_hi, P_hi) o (G_lo, P_lo) = (G_hi | (P_hi & G_lo), P_hi & P_lo)
+ *
+ * and ends with G bit i = carry out of bit i.  One bitwise operation on
+ * the whole word evaluates every node of a network level at once, so the
+ * software cost tracks the network depth, not the word width.
+ *
+ * carry_in is absorbed into bit 0 (G_0 = g_0 | p_0 & carry_in), which
+ * makes that group's P irrelevant; clearing it keeps spans that reach
+ * below bit 0 from picking it up again.
+ */
+
+/* Sum and Z/N/C from the carry into each bit and out of the MSB. */
+static word_t prefix_finish(word_t p, word_t G, uint32_t carry_in,
+                            ALUFlags *f)
+{
+    word_t carries = (word_t)((word_t)(G << 1) | (word_t)(carry_in & 1u));
+    word_t result  = p ^ carries;
+
+    f->nzcv = alu_nzcv((uint32_t)(result >> WORD_MSB) & 1u, result == 0u,
+                       (uint32_t)(G >> WORD_MSB) & 1u, 0u);
+
+    return result;
+}
+
+/*
+ * cla_add — carry-lookahead adder of 4-bit blocks.
+ *
+ * Inside each block, two prefix steps give the group (G, P) of every bit
+ * relative to the block's carry-in.  Block carries ripple through the
+ * WORD_BITS/4 lookahead units (c_out = G_3 | P_3 & c_in), and each bit's
+ * carry is then formed in parallel from its block's carry-in.
+ */
+static word_t cla_add(word_t a, word_t b, uint32_t carry_in, ALUFlags *f)
+{
+    const word_t in_block1 = (word_t)~EVERY(4);          /* bits 1..3 */
+    const word_t in_block2 = (word_t)~(EVERY(4) * 3u);   /* bits 2..3 */
+    word_t p = a ^ b;
+    word_t G = a & b;
+    word_t P = p;
+
+    G |= P & (G << 1) & in_block1;
+    P &= (P << 1) | ~in_block1;
+    G |= P & (G << 2) & in_block2;
+    P &= (P << 2) | ~in_block2;
+
+    word_t   block_cin = 0;                 /* carry-in at each block's bit 0 */
+    uint32_t c         = carry_in & 1u;
+    for (uint32_t k = 0; k < WORD_BITS; k += 4) {
+        block_cin |= (word_t)((word_t)c << k);
+        c = ((uint32_t)(G >> (k + 3)) & 1u)
+          | ((uint32_t)(P >> (k + 3)) & 1u & c);
+    }
+
+    /* Broadcast each block's carry-in over its 4 bits, then resolve. */
+    word_t cin_all = (word_t)(block_cin * 0xFu);
+    word_t carries = (word_t)(block_cin
+                   | (((word_t)(G << 1) | ((word_t)(P << 1) & cin_all))
+                      & in_block1));
+    word_t result  = p ^ carries;
+
+    f->nzcv = alu_nzcv((uint32_t)(result >> WORD_MSB) & 1u, result == 0u,
+                       c, 0u);
+
+    return result;
+}
+
+/*
+ * kogge_stone_add — Kogge-Stone prefix adder: WORD_LOG2 levels (5 for 32
+ * bits), every bit combining with the one 1, 2, 4, ... places below it.
+ * Minimum depth and fan-out, maximum wiring.
+ */
+static word_t kogge_stone_add(word_t a, word_t b, uint32_t carry_in,
+                              ALUFlags *f)
+{
+    word_t p = a ^ b;
+    word_t G = (a & b) | (p & (word_t)(carry_in & 1u));
+    word_t P = p & (word_t)~(word_t)1u;
+
+    for (uint32_t d = 1; d < WORD_BITS; d <<= 1) {
+        G |= P & (word_t)(G << d);
+        P &= (word_t)(P << d);
+    }
+    return prefix_finish(p, G, carry_in, f);
+}
+
+/*
+ * brent_kung_add — Brent-Kung prefix adder: an up-sweep builds prefixes at
+ * bits 2^k - 1 in WORD_LOG2 levels, and a down-sweep of WORD_LOG2 - 1 more
+ * levels fills in the bits between them.  Roughly half the nodes of
+ * Kogge-Stone for about twice the depth.
+ */
+
+/* Up-sweep nodes at distance d: bits i with (i+1) % 2d == 0. */
+#define BK_UP(d)    ((word_t)(EVERY(2 * (d)) << (2 * (d) - 1)))
+/* Down-sweep nodes at distance d: (i+1) % 2d == d, except i = d-1. */
+#define BK_DOWN(d)  ((word_t)((EVERY(2 * (d)) << ((d) - 1)) \
+                              & ~((word_t)1 << ((d) - 1))))
+
+static const word_t bk_up[WORD_LOG2] = {    /* d = 1, 2, 4, ...          */
+    BK_UP(1), BK_UP(2), BK_UP(4),
+#if WORD_BITS >= 16
+    BK_UP(8),
+#endif
+#if WORD_BITS >= 32
+    BK_UP(16),
+#endif
+#if WORD_BITS >= 64
+    BK_UP(32),
+#endif
+};
+static const word_t bk_down[WORD_LOG2 - 1] = {   /* d = WORD_BITS/4 .. 1 */
+#if WORD_BITS >= 64
+    BK_DOWN(16),
+#endif
+#if WORD_BITS >= 32
+    BK_DOWN(8),
+#endif
+#if WORD_BITS >= 16
+    BK_DOWN(4),
+#endif
+    BK_DOWN(2), BK_DOWN(1)
+};
+
+static word_t brent_kung_add(word_t a, word_t b, uint32_t carry_in,
+                             ALUFlags *f)
+{
+    word_t p = a ^ b;
+    word_t G = (a & b) | (p & (word_t)(carry_in & 1u));
+    word_t P = p & (word_t)~(word_t)1u;
+
+    for (uint32_t l = 0, d = 1; l < WORD_LOG2; l++, d <<= 1) {
+        G |= P & (word_t)(G << d) & bk_up[l];
+        P &= (word_t)((word_t)(P << d) | (word_t)~bk_up[l]);
+    }
+    for (uint32_t l = 0, d = WORD_BITS / 4; l < WORD_LOG2 - 1; l++, d >>= 1)
+        G |= P & (word_t)(G << d) & bk_down[l];
+
+    return prefix_finish(p, G, carry_in, f);
+}
+
+/* ── Mode selection ───────────────────────────────────────────────────────── */
+
+static ALUMode alu_mode = ALU_NATIVE;
+
+void alu_set_mode(ALUMode mode)
+{
+    if (mode == ALU_TABLE)
+        table_init();
+    alu_mode = mode;
+}
+
+ALUMode alu_get_mode(void)
+{
+    return alu_mode;
+}
+
+const char *alu_mode_name(ALUMode mode)
+{
+    switch (mode) {
+        case ALU_NATIVE:      return "native";
+        case ALU_RIPPLE:      return "ripple";
+        case ALU_CLA:         return "cla";
+        case ALU_KOGGE_STONE: return "kogge-stone";
+        case ALU_BRENT_KUNG:  return "brent-kung";
+        case ALU_TABLE:       return "table";
+        default:              return "?";
+    }
+}
+
+/* The adder for every mode except ALU_RIPPLE, which keeps its own path. */
+static word_t fast_add(word_t a, word_t b, uint32_t carry_in, ALUFlags *f)
+{
+    switch (alu_mode) {
+        case ALU_CLA:         return cla_add(a, b, carry_in, f);
+        case ALU_KOGGE_STONE: return kogge_stone_add(a, b, carry_in, f);
+        case ALU_BRENT_KUNG:  return brent_kung_add(a, b, carry_in, f);
+        case ALU_TABLE:       return table_add(a, b, carry_in, f);
+        default:              return native_add(a, b, carry_in, f);
+    }
+}
+
+/* ── Iterative multiplier and divider ─────────────────────────────────────── */
+
+static ALUMulDivMode            muldiv_mode = ALU_MULDIV_NATIVE;
+static _Thread_local unsigned   muldiv_iters;
+
+void alu_set_muldiv_mode(ALUMulDivMode mode)
+{
+    muldiv_mode = mode;
+}
+
+ALUMulDivMode alu_get_muldiv_mode(void)
+{
+    return muldiv_mode;
+}
+
+const char *alu_muldiv_mode_name(ALUMulDivMode mode)
+{
+    switch (mode) {
+        case ALU_MULDIV_NATIVE:    return "native";
+        case ALU_MULDIV_ITERATIVE: return "iterative";
+        default:                   return "?";
+    }
+}
+
+unsigned alu_muldiv_iterations(void)
+{
+    return muldiv_mode == ALU_MULDIV_ITERATIVE ? muldiv_iters : 0u;
+}
+
+/* hi:lo <<= n, for n < 2 * WORD_BITS. */
+static void dw_shl(word_t *hi, word_t *lo, unsigned n)
+{
+    if (n == 0)
+        return;
+    if (n >= WORD_BITS) {
+        *hi = (word_t)(*lo << (n - WORD_BITS));
+        *lo = 0;
+        return;
+    }
+    *hi = (word_t)((word_t)(*hi << n) | (word_t)(*lo >> (WORD_BITS - n)));
+    *lo = (word_t)(*lo << n);
+}
+
+/* hi:lo += xhi:xlo + carry_in, on the ripple-carry adder. */
+static void dw_add(word_t *hi, word_t *lo, word_t xhi, word_t xlo,
+                   uint32_t carry_in)
+{
+    ALUFlags f;
+
+    *lo = ripple_add(*lo, xlo, carry_in, &f);
+    *hi = ripple_add(*hi, xhi, alu_flag(f, ALU_FLAG_C), &f);
+}
+
+word_t alu_booth_mul(word_t a, word_t b, int is_signed, word_t *hi,
+                     unsigned *iters)
+{
+    /* Multiplicand and multiplier, extended past the word. */
+    word_t   mhi  = (is_signed && (a >> WORD_MSB)) ? WORD_MAX : 0u;
+    word_t   ext  = (is_signed && (b >> WORD_MSB)) ? WORD_MAX : 0u;
+    word_t   rest = b;          /* multiplier bits not yet recoded       */
+    uint32_t prev = 0;          /* the bit below them                    */
+    word_t   phi  = 0, plo = 0;
+    unsigned n    = 0;
+
+    while (rest != ext || prev != (uint32_t)(ext & 1u)) {
+        /* Booth digit of (b[2n+1], b[2n], b[2n-1]):
+         * 000 0, 001 +1, 010 +1, 011 +2, 100 -2, 101 -1, 110 -1, 111 0. */
+        uint32_t bits = ((uint32_t)(rest & 3u) << 1) | prev;
+
+        if (bits != 0 && bits != 7) {
+            word_t xhi = mhi, xlo = a;
+
+            dw_shl(&xhi, &xlo, 2 * n + (bits == 3 || bits == 4));
+            if (bits & 4u)
+                dw_add(&phi, &plo, (word_t)~xhi, (word_t)~xlo, 1u);
+            else
+                dw_add(&phi, &plo, xhi, xlo, 0u);
+        }
+        prev = (uint32_t)(rest >> 1) & 1u;
+        rest = (word_t)((word_t)(rest >> 2)
+                      | (word_t)(ext << (WORD_BITS - 2)));
+        n++;
+    }
+
+    *hi    = phi;
+    *iters = n;
+    return plo;
+}
+
+word_t alu_nr_divide(word_t a, word_t b, word_t *rem, unsigned *iters)
+{
+    unsigned n   = WORD_BITS;
+    word_t   rhi = 0, rlo = 0;  /* partial remainder, two's complement  */
+    word_t   q   = 0;
+
+    while (n > 0 && !((a >> (n - 1)) & 1u))
+        n--;
+    *iters = n;
+
+    /* Shift in the next dividend bit, then subtract b while the partial
+     * remainder is non-negative and add it back while it is negative. */
+    for (unsigned i = n; i-- > 0; ) {
+        word_t neg = rhi >> WORD_MSB;
+
+        dw_shl(&rhi, &rlo, 1);
+        rlo |= (word_t)((a >> i) & 1u);
+        if (neg)
+            dw_add(&rhi, &rlo, 0u, b, 0u);
+        else
+            dw_add(&rhi, &rlo, WORD_MAX, (word_t)~b, 1u);
+        q = (word_t)((word_t)(q << 1) | (word_t)!(rhi >> WORD_MSB));
+    }
+
+    if (rhi >> WORD_MSB) {
+        dw_add(&rhi, &rlo, 0u, b, 0u);
+        (*iters)++;
+    }
+    *rem = rlo;
+    return q;
+}
+
+/* Two's-complement negation on the ripple-carry adder. */
+static word_t ripple_neg(word_t x)
+{
+    ALUFlags f;
+    return ripple_add((word_t)~x, 0u, 1u, &f);
+}
+
+/* Signed a / b and a % b, truncating, from alu_nr_divide on magnitudes. */
+static word_t nr_sdivide(word_t a, word_t b, word_t *rem)
+{
+    word_t sa = a >> WORD_MSB, sb = b >> WORD_MSB;
+    word_t q  = alu_nr_divide(sa ? ripple_neg(a) : a,
+                              sb ? ripple_neg(b) : b, rem, &muldiv_iters);
+
+    if (sa)
+        *rem = ripple_neg(*rem);
+    return sa != sb ? ripple_neg(q) : q;
+}
+
 /* ── Public ALU operations ────────────────────────────────────────────────── */
 
 /*
- * alu_add — bit-accurate 32-bit addition.
+ * alu_add — word addition (bit-accurate in ALU_RIPPLE mode).
  *
  * Overflow rule for addition:
  *   V = (sign(a) == sign(b)) && (sign(result) != sign(a))
@@ -65,14 +473,24 @@ static word_t ripple_add(word_t a, word_t b, uint32_t carry_in, ALUFlags *f)
  */
 word_t alu_add(word_t a, word_t b, ALUFlags *f)
 {
+    if (alu_mode != ALU_RIPPLE) {
+        word_t result = fast_add(a, b, 0u, f);
+        /* Branch-free form of the rule: the result's sign differs from
+         * both operands' signs. */
+        f->nzcv |= (uint8_t)((((a ^ result) & (b ^ result)) >> WORD_MSB)
+                           & ALU_FLAG_V);
+        return result;
+    }
+
     word_t result = ripple_add(a, b, 0u, f);
 
-    uint8_t sign_a   = (uint8_t)((a      >> 31) & 1u);
-    uint8_t sign_b   = (uint8_t)((b      >> 31) & 1u);
-    uint8_t sign_res = (uint8_t)((result >> 31) & 1u);
+    uint8_t sign_a   = (uint8_t)((a      >> WORD_MSB) & 1u);
+    uint8_t sign_b   = (uint8_t)((b      >> WORD_MSB) & 1u);
+    uint8_t sign_res = (uint8_t)((result >> WORD_MSB) & 1u);
 
     /* Signed overflow: same-sign operands produced opposite-sign result. */
-    f->V = (uint8_t)((sign_a == sign_b) && (sign_res != sign_a));
+    f->nzcv |= alu_nzcv(0u, 0u, 0u,
+                        (sign_a == sign_b) && (sign_res != sign_a));
 
     return result;
 }
@@ -96,38 +514,53 @@ word_t alu_add(word_t a, word_t b, ALUFlags *f)
  */
 word_t alu_sub(word_t a, word_t b, ALUFlags *f)
 {
+    if (alu_mode != ALU_RIPPLE) {
+        word_t result = fast_add(a, ~b, 1u, f);
+        /* Branch-free: operand signs differ and the result's sign differs
+         * from a's. */
+        f->nzcv |= (uint8_t)((((a ^ b) & (a ^ result)) >> WORD_MSB)
+                           & ALU_FLAG_V);
+        return result;
+    }
+
     /*
      * Invert b; pass carry_in=1 so the adder computes a + (~b + 1).
      * ripple_add fills Z, N, C correctly for this combined operation.
      */
     word_t result = ripple_add(a, ~b, 1u, f);
 
-    uint8_t sign_a   = (uint8_t)((a      >> 31) & 1u);
-    uint8_t sign_b   = (uint8_t)((b      >> 31) & 1u);
-    uint8_t sign_res = (uint8_t)((result >> 31) & 1u);
+    uint8_t sign_a   = (uint8_t)((a      >> WORD_MSB) & 1u);
+    uint8_t sign_b   = (uint8_t)((b      >> WORD_MSB) & 1u);
+    uint8_t sign_res = (uint8_t)((result >> WORD_MSB) & 1u);
 
     /* Signed overflow: opposite-sign operands produced wrong-sign result. */
-    f->V = (uint8_t)((sign_a != sign_b) && (sign_res != sign_a));
+    f->nzcv |= alu_nzcv(0u, 0u, 0u,
+                        (sign_a != sign_b) && (sign_res != sign_a));
 
     return result;
 }
 
 /*
- * alu_mul — multiplication (lower 32 bits).
+ * alu_mul — multiplication (lower WORD_BITS bits).
  *
- * The product of two 32-bit values can be 64 bits; we retain only the lower
+ * The product of two words is twice as wide; we retain only the lower
  * half, consistent with most RISC ISAs (ARM MUL, MIPS MULT lo-word, etc.).
  * C and V are architecturally UNPREDICTABLE for multiply and are zeroed here.
  */
 word_t alu_mul(word_t a, word_t b, ALUFlags *f)
 {
-    /* Cast to 64-bit before multiplying to avoid UB on 32-bit overflow. */
-    word_t result = (word_t)((uint64_t)a * (uint64_t)b);
+    word_t result, hi;
 
-    f->Z = (result == 0u) ? 1u : 0u;
-    f->N = (uint8_t)((result >> 31) & 1u);
-    f->C = 0;
-    f->V = 0;
+    if (muldiv_mode == ALU_MULDIV_ITERATIVE) {
+        result = alu_booth_mul(a, b, 1, &hi, &muldiv_iters);
+    } else {
+        /* Cast to 64-bit before multiplying: narrow words would otherwise
+         * be promoted to int, whose overflow is UB. */
+        result = (word_t)((uint64_t)a * (uint64_t)b);
+    }
+
+    f->nzcv = alu_nzcv((uint32_t)(result >> WORD_MSB) & 1u, result == 0u,
+                       0u, 0u);
 
     return result;
 }
@@ -140,21 +573,417 @@ word_t alu_mul(word_t a, word_t b, ALUFlags *f)
  */
 word_t alu_div(word_t a, word_t b, ALUFlags *f)
 {
-    word_t result = a / b;
+    word_t result, rem;
 
-    f->Z = (result == 0u) ? 1u : 0u;
-    f->N = (uint8_t)((result >> 31) & 1u);
-    f->C = 0;
-    f->V = 0;
+    if (muldiv_mode == ALU_MULDIV_ITERATIVE)
+        result = alu_nr_divide(a, b, &rem, &muldiv_iters);
+    else
+        result = a / b;
+
+    f->nzcv = alu_nzcv((uint32_t)(result >> WORD_MSB) & 1u, result == 0u,
+                       0u, 0u);
 
     return result;
 }
 
+/* Z and N from r, C = V = 0: the multiply and divide flag rule. */
+static word_t set_muldiv_flags(word_t r, ALUFlags *f)
+{
+    f->nzcv = alu_nzcv((uint32_t)(r >> WORD_MSB) & 1u, r == 0u, 0u, 0u);
+    return r;
+}
+
+/*
+ * alu_sdiv / alu_srem — signed division, truncating toward zero.
+ *
+ * The operands are reinterpreted as sword_t.  Caller MUST verify b != 0
+ * and, for alu_sdiv, that (a, b) is not (WORD_SMIN, -1).  A divisor of -1
+ * always leaves remainder 0, which also keeps WORD_SMIN % -1 (undefined
+ * in C) out of the host division.
+ */
+word_t alu_sdiv(word_t a, word_t b, ALUFlags *f)
+{
+    word_t rem;
+
+    if (muldiv_mode == ALU_MULDIV_ITERATIVE)
+        return set_muldiv_flags(nr_sdivide(a, b, &rem), f);
+    return set_muldiv_flags((word_t)((sword_t)a / (sword_t)b), f);
+}
+
+word_t alu_srem(word_t a, word_t b, ALUFlags *f)
+{
+    word_t rem;
+
+    if (muldiv_mode == ALU_MULDIV_ITERATIVE) {
+        nr_sdivide(a, b, &rem);
+        return set_muldiv_flags(rem, f);
+    }
+    if (b == WORD_MAX)
+        return set_muldiv_flags(0u, f);
+    return set_muldiv_flags((word_t)((sword_t)a % (sword_t)b), f);
+}
+
+/* alu_urem — unsigned remainder.  Caller MUST verify b != 0. */
+word_t alu_urem(word_t a, word_t b, ALUFlags *f)
+{
+    word_t rem;
+
+    if (muldiv_mode == ALU_MULDIV_ITERATIVE) {
+        alu_nr_divide(a, b, &rem, &muldiv_iters);
+        return set_muldiv_flags(rem, f);
+    }
+    return set_muldiv_flags(a % b, f);
+}
+
+/*
+ * Unsigned double-word product hi:lo of a and b.  Up to 32-bit words the
+ * host's 64-bit multiply holds it; 64-bit words are split into 32-bit
+ * halves and the four partial products summed with their carries.
+ */
+static word_t mul_wide(word_t a, word_t b, word_t *hi)
+{
+#if WORD_BITS < 64
+    uint64_t p = (uint64_t)a * (uint64_t)b;
+    *hi = (word_t)(p >> WORD_BITS);
+    return (word_t)p;
+#else
+    const uint64_t lo32 = 0xFFFFFFFFu;
+    uint64_t ll  = (a & lo32) * (b & lo32);
+    uint64_t lh  = (a & lo32) * (b >> 32);
+    uint64_t hl  = (a >> 32)  * (b & lo32);
+    uint64_t mid = (ll >> 32) + (lh & lo32) + (hl & lo32);
+
+    *hi = (a >> 32) * (b >> 32) + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return (mid << 32) | (ll & lo32);
+#endif
+}
+
+/* Z/N of the double word hi:lo, C = V = 0.  Returns lo. */
+static word_t set_mull_flags(word_t lo, word_t hi, ALUFlags *f)
+{
+    f->nzcv = alu_nzcv((uint32_t)(hi >> WORD_MSB) & 1u,
+                       lo == 0u && hi == 0u, 0u, 0u);
+    return lo;
+}
+
+word_t alu_umull(word_t a, word_t b, word_t *hi, ALUFlags *f)
+{
+    word_t lo;
+
+    if (muldiv_mode == ALU_MULDIV_ITERATIVE)
+        lo = alu_booth_mul(a, b, 0, hi, &muldiv_iters);
+    else
+        lo = mul_wide(a, b, hi);
+    return set_mull_flags(lo, *hi, f);
+}
+
+/*
+ * The signed product differs from the unsigned one only in the high word:
+ * a negative operand x stands for x - 2^WORD_BITS, so each one subtracts
+ * the other operand from the high word (mod 2^WORD_BITS).
+ */
+word_t alu_smull(word_t a, word_t b, word_t *hi, ALUFlags *f)
+{
+    word_t lo;
+
+    if (muldiv_mode == ALU_MULDIV_ITERATIVE) {
+        lo = alu_booth_mul(a, b, 1, hi, &muldiv_iters);
+        return set_mull_flags(lo, *hi, f);
+    }
+    lo = mul_wide(a, b, hi);
+
+    if (a >> WORD_MSB)
+        *hi = (word_t)(*hi - b);
+    if (b >> WORD_MSB)
+        *hi = (word_t)(*hi - a);
+    return set_mull_flags(lo, *hi, f);
+}
+
+word_t alu_mla(word_t acc, word_t a, word_t b, ALUFlags *f)
+{
+    word_t hi, p;
+
+    if (muldiv_mode == ALU_MULDIV_ITERATIVE)
+        p = alu_booth_mul(a, b, 1, &hi, &muldiv_iters);
+    else
+        p = mul_wide(a, b, &hi);
+    return set_muldiv_flags((word_t)(acc + p), f);
+}
+
+/* ── Logical and shift operations ─────────────────────────────────────────── */
+
+/* Z and N from r; C and V are kept.  Returns r. */
+static word_t set_zn(word_t r, ALUFlags *f)
+{
+    f->nzcv = (uint8_t)((f->nzcv & (ALU_FLAG_C | ALU_FLAG_V))
+                      | alu_nzcv((uint32_t)(r >> WORD_MSB) & 1u, r == 0u,
+                                 0u, 0u));
+    return r;
+}
+
+/* Z and N from r, C = c; V is kept.  Returns r. */
+static word_t set_czn(word_t r, uint32_t c, ALUFlags *f)
+{
+    f->nzcv = (uint8_t)((f->nzcv & ALU_FLAG_V)
+                      | alu_nzcv((uint32_t)(r >> WORD_MSB) & 1u, r == 0u,
+                                 c, 0u));
+    return r;
+}
+
+word_t alu_and(word_t a, word_t b, ALUFlags *f) { return set_zn(a & b, f); }
+word_t alu_or (word_t a, word_t b, ALUFlags *f) { return set_zn(a | b, f); }
+word_t alu_xor(word_t a, word_t b, ALUFlags *f) { return set_zn(a ^ b, f); }
+word_t alu_not(word_t a, ALUFlags *f)           { return set_zn(~a, f); }
+
+/* Register-specified shift amount: the low byte, as on ARM. */
+#define SHIFT_AMOUNT(b)  ((unsigned)((b) & 0xFFu))
+
+word_t alu_shl(word_t a, word_t b, ALUFlags *f)
+{
+    unsigned n = SHIFT_AMOUNT(b);
+
+    if (n == 0)
+        return set_zn(a, f);
+    if (n < WORD_BITS)
+        return set_czn((word_t)(a << n),
+                       (uint32_t)(a >> (WORD_BITS - n)) & 1u, f);
+    return set_czn(0u, n == WORD_BITS ? (uint32_t)a & 1u : 0u, f);
+}
+
+word_t alu_lsr(word_t a, word_t b, ALUFlags *f)
+{
+    unsigned n = SHIFT_AMOUNT(b);
+
+    if (n == 0)
+        return set_zn(a, f);
+    if (n < WORD_BITS)
+        return set_czn((word_t)(a >> n), (uint32_t)(a >> (n - 1)) & 1u, f);
+    return set_czn(0u, n == WORD_BITS ? (uint32_t)(a >> WORD_MSB) & 1u : 0u,
+                   f);
+}
+
+/* Sign fill built from unsigned shifts: no implementation-defined >>. */
+word_t alu_asr(word_t a, word_t b, ALUFlags *f)
+{
+    unsigned n    = SHIFT_AMOUNT(b);
+    word_t   fill = ((a >> WORD_MSB) & 1u) ? WORD_MAX : 0u;
+
+    if (n == 0)
+        return set_zn(a, f);
+    if (n < WORD_BITS)
+        return set_czn((word_t)((a >> n) | (word_t)(fill << (WORD_BITS - n))),
+                       (uint32_t)(a >> (n - 1)) & 1u, f);
+    return set_czn(fill, (uint32_t)fill & 1u, f);
+}
+
+word_t alu_ror(word_t a, word_t b, ALUFlags *f)
+{
+    unsigned n = SHIFT_AMOUNT(b);
+
+    if (n == 0)
+        return set_zn(a, f);
+    n %= WORD_BITS;
+    word_t r = n ? (word_t)((a >> n) | (word_t)(a << (WORD_BITS - n))) : a;
+    return set_czn(r, (uint32_t)(r >> WORD_MSB) & 1u, f);
+}
+
+/* ── Lazy flags ───────────────────────────────────────────────────────────── */
+
+word_t alu_add_value(word_t a, word_t b)
+{
+    ALUFlags unused;
+
+    switch (alu_mode) {
+        case ALU_NATIVE: return (word_t)(a + b);
+        case ALU_RIPPLE: return ripple_add(a, b, 0u, &unused);
+        default:         return fast_add(a, b, 0u, &unused);
+    }
+}
+
+word_t alu_sub_value(word_t a, word_t b)
+{
+    ALUFlags unused;
+
+    switch (alu_mode) {
+        case ALU_NATIVE: return (word_t)(a - b);
+        case ALU_RIPPLE: return ripple_add(a, ~b, 1u, &unused);
+        default:         return fast_add(a, ~b, 1u, &unused);
+    }
+}
+
+/* ── Gate-level cost model ─────────────────────────────────────────────────── */
+
+/*
+ * Replays each adder's network on arrival times instead of bits.  Every
+ * gate has two inputs and a delay of 1; a, b and carry_in arrive at 0.
+ * The network is the one the software model above evaluates: per-bit
+ * g/p, the carry network, and the sum XORs.  Flag logic is not counted.
+ */
+typedef struct {
+    unsigned gates;
+    unsigned g[WORD_BITS];   /* arrival of each position's group generate */
+    unsigned p[WORD_BITS];   /* ... and group propagate                  */
+} CostNet;
+
+static unsigned gate(CostNet *n, unsigned t1, unsigned t2)
+{
+    n->gates++;
+    return (t1 > t2 ? t1 : t2) + 1u;
+}
+
+/* (G, P)[hi] o= (G, P)[lo]; P only if hi's span does not reach bit 0. */
+static void cost_node(CostNet *n, int hi, int lo, int need_p)
+{
+    n->g[hi] = gate(n, n->g[hi], gate(n, n->p[hi], n->g[lo]));
+    if (need_p)
+        n->p[hi] = gate(n, n->p[hi], n->p[lo]);
+}
+
+/* Per-bit g = a & b and p = a ^ b. */
+static void cost_pg(CostNet *n)
+{
+    for (int i = 0; i < WORD_BITS; i++) {
+        n->g[i] = gate(n, 0, 0);
+        n->p[i] = gate(n, 0, 0);
+    }
+}
+
+/* Sum XORs from the carry into each bit; returns the critical path. */
+static unsigned cost_sums(CostNet *n, const unsigned carry[WORD_BITS + 1])
+{
+    unsigned depth = carry[WORD_BITS];
+    for (int i = 0; i < WORD_BITS; i++) {
+        unsigned s = gate(n, 1u, carry[i]);   /* p_i arrives at 1 */
+        if (s > depth)
+            depth = s;
+    }
+    return depth;
+}
+
+/* Prefix adders: G_i is the carry out of bit i once the network is done. */
+static unsigned cost_prefix(CostNet *n)
+{
+    unsigned carry[WORD_BITS + 1];
+    carry[0] = 0;
+    for (int i = 0; i < WORD_BITS; i++)
+        carry[i + 1] = n->g[i];
+    return cost_sums(n, carry);
+}
+
+int alu_adder_cost(ALUMode mode, ALUAdderCost *cost)
+{
+    CostNet  n = { 0 };
+    unsigned carry[WORD_BITS + 1];
+    unsigned depth;
+
+    cost_pg(&n);
+    switch (mode) {
+        case ALU_RIPPLE:
+            carry[0] = 0;
+            for (int i = 0; i < WORD_BITS; i++)
+                carry[i + 1] = gate(&n, n.g[i], gate(&n, n.p[i], carry[i]));
+            depth = cost_sums(&n, carry);
+            break;
+
+        case ALU_CLA:
+            carry[0] = 0;
+            for (int k = 0; k < WORD_BITS; k += 4) {
+                /* In-block prefix, relative to the block carry-in. */
+                for (int i = k + 3; i > k; i--)
+                    cost_node(&n, i, i - 1, 1);
+                for (int i = k + 3; i > k + 1; i--)
+                    cost_node(&n, i, i - 2, 1);
+                for (int i = k; i < k + 4; i++)
+                    carry[i + 1] = gate(&n, n.g[i],
+                                        gate(&n, n.p[i], carry[k]));
+            }
+            depth = cost_sums(&n, carry);
+            break;
+
+        case ALU_KOGGE_STONE:
+        case ALU_BRENT_KUNG: {
+            int reaches_0[WORD_BITS] = { 0 };   /* span includes bit 0 */
+            /* Bit 0 absorbs carry_in: G_0 = g_0 | p_0 & carry_in. */
+            n.g[0] = gate(&n, n.g[0], gate(&n, n.p[0], 0));
+            reaches_0[0] = 1;
+
+            if (mode == ALU_KOGGE_STONE) {
+                for (int d = 1; d < WORD_BITS; d <<= 1)
+                    for (int i = WORD_MSB; i >= d; i--) {
+                        reaches_0[i] = reaches_0[i - d];
+                        cost_node(&n, i, i - d, !reaches_0[i]);
+                    }
+            } else {
+                for (int d = 1; d < WORD_BITS; d <<= 1)
+                    for (int i = 2 * d - 1; i < WORD_BITS; i += 2 * d) {
+                        reaches_0[i] = reaches_0[i - d];
+                        cost_node(&n, i, i - d, !reaches_0[i]);
+                    }
+                for (int d = WORD_BITS / 4; d >= 1; d >>= 1)
+                    for (int i = 3 * d - 1; i < WORD_BITS; i += 2 * d)
+                        cost_node(&n, i, i - d, 0);
+            }
+            depth = cost_prefix(&n);
+            break;
+        }
+
+        default:
+            return -1;   /* native, table: no gate model */
+    }
+
+    cost->gates = n.gates;
+    cost->depth = depth;
+    return 0;
+}
+
+/* ── Table adder check ────────────────────────────────────────────────────── */
+
+long alu_table_check(void)
+{
+    long mismatches = 0;
+
+    table_init();
+    for (uint32_t k = 0; k < WORD_BITS; k += 8) {
+        /* Below byte k: a all ones, b zero, so carry_in ripples up to k. */
+        word_t below = (word_t)(WORD_MAX >> (WORD_BITS - k - 8) >> 8);
+
+        for (uint32_t c = 0; c < 2; c++)
+            for (uint32_t x = 0; x < 256; x++)
+                for (uint32_t y = 0; y < 256; y++) {
+                    word_t   a = (word_t)((word_t)x << k) | below;
+                    word_t   b = (word_t)((word_t)y << k);
+                    ALUFlags fr, ft;
+                    word_t   rr = ripple_add(a, b, c, &fr);
+                    word_t   rt = table_add(a, b, c, &ft);
+
+                    mismatches += rr != rt || fr.nzcv != ft.nzcv;
+                }
+    }
+    return mismatches;
+}
+
 /* ── Utility ──────────────────────────────────────────────────────────────── */
 
-void alu_flags_str(const ALUFlags *f, char *buf, int buflen)
+const char *alu_flags_str(ALUFlags f)
 {
-    snprintf(buf, (size_t)buflen,
-             "Z=%u N=%u C=%u V=%u",
-             f->Z, f->N, f->C, f->V);
+    /* Indexed by the NZCV nibble. */
+    static const char *const names[16] = {
+        "Z=0 N=0 C=0 V=0",   /* 0000 */
+        "Z=0 N=0 C=0 V=1",   /* 0001 */
+        "Z=0 N=0 C=1 V=0",   /* 0010 */
+        "Z=0 N=0 C=1 V=1",   /* 0011 */
+        "Z=1 N=0 C=0 V=0",   /* 0100 */
+        "Z=1 N=0 C=0 V=1",   /* 0101 */
+        "Z=1 N=0 C=1 V=0",   /* 0110 */
+        "Z=1 N=0 C=1 V=1",   /* 0111 */
+        "Z=0 N=1 C=0 V=0",   /* 1000 */
+        "Z=0 N=1 C=0 V=1",   /* 1001 */
+        "Z=0 N=1 C=1 V=0",   /* 1010 */
+        "Z=0 N=1 C=1 V=1",   /* 1011 */
+        "Z=1 N=1 C=0 V=0",   /* 1100 */
+        "Z=1 N=1 C=0 V=1",   /* 1101 */
+        "Z=1 N=1 C=1 V=0",   /* 1110 */
+        "Z=1 N=1 C=1 V=1",   /* 1111 */
+    };
+    return names[f.nzcv & 0xFu];
 }
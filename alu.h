@@ -3,17 +3,21 @@
 
 #include <stdint.h>
 
+#include "word.h"
+
 /*
  * ALU — Arithmetic Logic Unit
  *
- * All operations are performed on 32-bit unsigned words.  Signed
- * interpretation is derived from bit patterns (two's complement), not from C
- * signed types — this avoids relying on signed overflow UB.
+ * All operations are performed on WORD_BITS-bit unsigned words (32 by
+ * default; see word.h).  Signed interpretation is derived from bit patterns
+ * (two's complement), not from C signed types — this avoids relying on
+ * signed overflow UB.
  *
  * word_t is the canonical integer type for the entire Level-3 machine.
  * Every register, immediate (after truncation), and ALU operand uses it.
+ * Bit positions below (bit 31, "32-bit") describe the default width; every
+ * rule applies to bit WORD_MSB of a WORD_BITS-bit word.
  */
-typedef uint32_t word_t;
 
 /* ── Processor flags ──────────────────────────────────────────────────────── */
 
@@ -28,22 +32,163 @@ typedef uint32_t word_t;
  *  V  — oVerflow: signed overflow; set when the result cannot be represented
  *                 as a signed 32-bit value
  */
+/*
+ * The four flags are packed into one NZCV nibble, laid out like the top of
+ * the ARM CPSR: N in bit 3 down to V in bit 0.  An operation writes the
+ * whole nibble in a single store, and a branch tests one flag with a
+ * single mask.
+ */
+#define ALU_FLAG_V  0x1u    /* overflow */
+#define ALU_FLAG_C  0x2u    /* carry    */
+#define ALU_FLAG_Z  0x4u    /* zero     */
+#define ALU_FLAG_N  0x8u    /* negative */
+
 typedef struct {
-    uint8_t Z;  /* zero     */
-    uint8_t N;  /* negative */
-    uint8_t C;  /* carry    */
-    uint8_t V;  /* overflow */
+    uint8_t nzcv;   /* ALU_FLAG_* bits; the upper nibble is always 0 */
 } ALUFlags;
 
+/* The nibble for flag values n, z, c, v (each 0 or 1). */
+static inline uint8_t alu_nzcv(uint32_t n, uint32_t z, uint32_t c,
+                               uint32_t v)
+{
+    return (uint8_t)((n << 3) | (z << 2) | (c << 1) | v);
+}
+
+/* 1 if the ALU_FLAG_* bit `flag` is set in f, else 0. */
+static inline uint32_t alu_flag(ALUFlags f, uint32_t flag)
+{
+    return (f.nzcv & flag) != 0;
+}
+
+/* ── Adder implementation ─────────────────────────────────────────────────── */
+
+/*
+ * Interchangeable adders back alu_add, alu_sub (and hence CMP):
+ *
+ *  ALU_NATIVE       — the default.  One native add; C and V come from
+ *                     the operand/result sign bits, all branch-free.
+ *  ALU_RIPPLE       — the bit-accurate reference: a WORD_BITS-step
+ *                     ripple-carry adder that never uses native `+`.
+ *  ALU_CLA          — carry-lookahead: 4-bit lookahead blocks whose block
+ *                     carries ripple from one to the next.
+ *  ALU_KOGGE_STONE  — parallel prefix, log2(WORD_BITS) levels, full fan-in.
+ *  ALU_BRENT_KUNG   — parallel prefix, up-sweep + down-sweep, fewer nodes.
+ *  ALU_TABLE        — bit-accurate like ALU_RIPPLE (no native `+`), but
+ *                     the carry crosses a byte per step: a 2x256x256
+ *                     sum/carry table, filled by the ripple adder itself
+ *                     the first time the mode is selected, gives
+ *                     WORD_BITS/8 lookups per add.
+ *
+ * The last three model their gate networks with word-wide bitwise
+ * operations, one per network level, so they run in time proportional to
+ * depth rather than width.  All produce identical results and flags for
+ * every input (bench --check tests this).  The mode is process-wide and
+ * not synchronised: select it before starting any run, not while one is
+ * in flight.
+ */
+typedef enum {
+    ALU_NATIVE = 0,
+    ALU_RIPPLE,
+    ALU_CLA,
+    ALU_KOGGE_STONE,
+    ALU_BRENT_KUNG,
+    ALU_TABLE,
+    ALU_MODE_COUNT
+} ALUMode;
+
+void        alu_set_mode(ALUMode mode);
+ALUMode     alu_get_mode(void);
+const char *alu_mode_name(ALUMode mode);   /* "native", "kogge-stone", ... */
+
+/*
+ * Hardware cost of one word add/subtract on a gate-level adder, with
+ * 2-input gates of unit delay (XOR counted as one gate).  Covers the
+ * per-bit generate/propagate, the carry network and the sum XORs, not the
+ * flag logic or the subtract-mode inverters.
+ */
+typedef struct {
+    unsigned gates;   /* gates in the network                       */
+    unsigned depth;   /* critical path (carry out or slowest sum)   */
+} ALUAdderCost;
+
+/* Fill *cost for `mode`.  Returns 0, or -1 for ALU_NATIVE and ALU_TABLE
+ * (no gate model). */
+int alu_adder_cost(ALUMode mode, ALUAdderCost *cost);
+
+/*
+ * Proof by exhaustion of the ALU_TABLE adder against ripple_add: every
+ * byte pair and carry-in, at every byte position of the word (the bytes
+ * below set up to deliver that carry).  Compares sums and Z/N/C; returns
+ * the number of mismatches, 0 when the two adders agree.
+ */
+long alu_table_check(void);
+
+/* ── Multiplier and divider implementation ────────────────────────────────── */
+
+/*
+ * Interchangeable units back the multiplies and divides (alu_mul, alu_mla,
+ * alu_umull, alu_smull, alu_div, alu_sdiv, alu_srem, alu_urem):
+ *
+ *  ALU_MULDIV_NATIVE     — the default: host `*` and `/`.
+ *  ALU_MULDIV_ITERATIVE  — bit-level sequential units that never use them:
+ *                          alu_booth_mul and alu_nr_divide below, with every
+ *                          add done by the ripple-carry adder.
+ *
+ * Both give identical results and flags for every input (bench --check
+ * tests this).  The iterative units also count their steps, for cycle
+ * accounting: see alu_muldiv_iterations.  Process-wide and not
+ * synchronised, like the adder mode.
+ */
+typedef enum {
+    ALU_MULDIV_NATIVE = 0,
+    ALU_MULDIV_ITERATIVE,
+    ALU_MULDIV_MODE_COUNT
+} ALUMulDivMode;
+
+void          alu_set_muldiv_mode(ALUMulDivMode mode);
+ALUMulDivMode alu_get_muldiv_mode(void);
+const char   *alu_muldiv_mode_name(ALUMulDivMode mode);  /* "iterative" */
+
+/*
+ * Steps taken by the calling thread's most recent multiply or divide, or 0
+ * in ALU_MULDIV_NATIVE mode.  Read it straight after the operation.
+ */
+unsigned alu_muldiv_iterations(void);
+
+/*
+ * alu_booth_mul — radix-4 Booth multiplier.  Returns the low word of the
+ * double-word product a * b and stores the high word in *hi; is_signed
+ * picks two's-complement or unsigned operands.
+ *
+ * Each step recodes two multiplier bits (plus the one below) into a digit
+ * in {-2..2} and adds that multiple of a into the product.  The unit stops
+ * early once the multiplier bits left are all copies of its sign (zeros
+ * when unsigned), so *iters runs from 0 (b == 0) to WORD_BITS/2, plus one
+ * for an unsigned b with its MSB set.
+ */
+word_t alu_booth_mul(word_t a, word_t b, int is_signed, word_t *hi,
+                     unsigned *iters);
+
+/*
+ * alu_nr_divide — radix-2 non-restoring divider, unsigned.  Returns a / b
+ * and stores a % b in *rem.  Caller must ensure b != 0.
+ *
+ * Leading zeros of the dividend are skipped, then one add or subtract of
+ * b per remaining dividend bit; a negative final remainder costs one more
+ * (restoring) add.  *iters counts them all.
+ */
+word_t alu_nr_divide(word_t a, word_t b, word_t *rem, unsigned *iters);
+
 /* ── ALU operations ───────────────────────────────────────────────────────── */
 
 /*
- * alu_add — ripple-carry addition (bit-accurate)
+ * alu_add — 32-bit addition
  *
  *   result = a + b
  *
- * Must NOT use native `+` for the final result; each bit is computed
- * explicitly via carry propagation.
+ * In ALU_RIPPLE mode each bit is computed explicitly via carry
+ * propagation, without native `+`; the other gate-level modes evaluate
+ * their carry networks with bitwise operations.
  */
 word_t alu_add(word_t a, word_t b, ALUFlags *f);
 
@@ -52,14 +197,15 @@ word_t alu_add(word_t a, word_t b, ALUFlags *f);
  *
  *   result = a - b  ≡  a + (~b) + 1
  *
- * Carry-in of 1 is passed into the ripple adder, which is exactly how
- * hardware subtract units work.
+ * Carry-in of 1 is passed into the adder, which is exactly how hardware
+ * subtract units work.
  */
 word_t alu_sub(word_t a, word_t b, ALUFlags *f);
 
 /*
- * alu_mul — multiplication (lower 32 bits; may use native *)
- * alu_div — division (may use native /)
+ * alu_mul — multiplication (low word; native * unless the multiply/divide
+ *           mode is ALU_MULDIV_ITERATIVE)
+ * alu_div — unsigned division (likewise native / by default)
  *
  * Caller must ensure b != 0 before calling alu_div.
  * Both ops update Z and N; C and V are architecturally UNPREDICTABLE for
@@ -68,7 +214,228 @@ word_t alu_sub(word_t a, word_t b, ALUFlags *f);
 word_t alu_mul(word_t a, word_t b, ALUFlags *f);
 word_t alu_div(word_t a, word_t b, ALUFlags *f);
 
-/* Human-readable flag string written into buf (must be >= 24 bytes). */
-void alu_flags_str(const ALUFlags *f, char *buf, int buflen);
+/*
+ * Signed divide and the remainders — ARM SDIV, with remainders truncated
+ * toward zero (the sign of the dividend), as in C.  IR_DIV's alu_div is
+ * the unsigned divide.
+ *
+ * Caller must ensure b != 0, and for alu_sdiv that a / b is not
+ * WORD_SMIN / -1, whose quotient does not fit in a word.  alu_srem of that
+ * pair is 0.  Flags as alu_div: Z and N from the result, C = V = 0.
+ */
+word_t alu_sdiv(word_t a, word_t b, ALUFlags *f);
+word_t alu_srem(word_t a, word_t b, ALUFlags *f);
+word_t alu_urem(word_t a, word_t b, ALUFlags *f);
+
+/*
+ * Long multiply — ARM UMULL/SMULL: the full 2*WORD_BITS-bit product of a
+ * and b.  Returns the low word and stores the high word in *hi.  Z is set
+ * when the whole product is zero and N is its sign (the MSB of *hi);
+ * C = V = 0.
+ */
+word_t alu_umull(word_t a, word_t b, word_t *hi, ALUFlags *f);
+word_t alu_smull(word_t a, word_t b, word_t *hi, ALUFlags *f);
+
+/* Multiply-accumulate — acc + a * b (low word); flags as alu_mul. */
+word_t alu_mla(word_t acc, word_t a, word_t b, ALUFlags *f);
+
+/*
+ * Logical operations — ARM AND/ORR/EOR/MVN with a register operand.
+ *
+ * Z and N come from the result.  C and V are left as they were: with an
+ * unshifted register operand the shifter's carry-out is the old C, and no
+ * logical operation touches V.  *f is therefore read as well as written.
+ */
+word_t alu_and(word_t a, word_t b, ALUFlags *f);
+word_t alu_or (word_t a, word_t b, ALUFlags *f);
+word_t alu_xor(word_t a, word_t b, ALUFlags *f);
+word_t alu_not(word_t a, ALUFlags *f);   /* ~a */
+
+/*
+ * Shifts and rotate — ARM LSL/LSR/ASR/ROR by register.
+ *
+ * The amount is the low byte of b, so it may exceed WORD_BITS.  Amount 0
+ * leaves the value and C unchanged; otherwise C is the shifter carry-out,
+ * the last bit shifted out:
+ *
+ *   alu_shl  n < WORD_BITS: a << n; C = bit WORD_BITS-n of a.
+ *            n = WORD_BITS: 0, C = bit 0.   n > WORD_BITS: 0, C = 0.
+ *   alu_lsr  n < WORD_BITS: a >> n (zero fill); C = bit n-1.
+ *            n = WORD_BITS: 0, C = MSB.     n > WORD_BITS: 0, C = 0.
+ *   alu_asr  n < WORD_BITS: a >> n (sign fill); C = bit n-1.
+ *            n >= WORD_BITS: every bit and C = the sign bit.
+ *   alu_ror  rotate right by n mod WORD_BITS; C = MSB of the result
+ *            (a multiple of WORD_BITS leaves a unchanged but still sets C).
+ *
+ * Z and N come from the result; V is unchanged.
+ */
+word_t alu_shl(word_t a, word_t b, ALUFlags *f);
+word_t alu_lsr(word_t a, word_t b, ALUFlags *f);
+word_t alu_asr(word_t a, word_t b, ALUFlags *f);
+word_t alu_ror(word_t a, word_t b, ALUFlags *f);
+
+/* ── Lazy flags ───────────────────────────────────────────────────────────── */
+
+/*
+ * Most flag results are overwritten before anything reads them: only the
+ * op feeding a JZ/JNZ matters.  A core can instead record the last
+ * flag-setting op with its operands and result, and derive NZCV from that
+ * record only when a branch, a trace event or the final state needs them.
+ *
+ * The *_lazy calls return exactly what alu_add etc. return (in every ALU
+ * mode) and overwrite *lz.  alu_lazy_resolve then fills *f with the flags
+ * the eager call would have produced; for ALU_LAZY_NONE (nothing recorded
+ * since the flags were last resolved) it leaves *f untouched, so *f is the
+ * flag state underneath the record.
+ */
+typedef enum {
+    ALU_LAZY_NONE = 0,  /* *f is current                              */
+    ALU_LAZY_ADD,       /* result = a + b                             */
+    ALU_LAZY_SUB,       /* result = a - b (also CMP)                  */
+    ALU_LAZY_ZN         /* Z and N from result, C = V = 0 (MUL, DIV)  */
+} ALULazyOp;
+
+typedef struct {
+    ALULazyOp op;
+    word_t    a, b, result;
+} ALULazyFlags;
+
+/* Results alone, through the selected adder (no flag work). */
+word_t alu_add_value(word_t a, word_t b);
+word_t alu_sub_value(word_t a, word_t b);
+
+static inline word_t alu_add_lazy(word_t a, word_t b, ALULazyFlags *lz)
+{
+    word_t r = alu_add_value(a, b);
+    *lz = (ALULazyFlags){ ALU_LAZY_ADD, a, b, r };
+    return r;
+}
+
+static inline word_t alu_sub_lazy(word_t a, word_t b, ALULazyFlags *lz)
+{
+    word_t r = alu_sub_value(a, b);
+    *lz = (ALULazyFlags){ ALU_LAZY_SUB, a, b, r };
+    return r;
+}
+
+/* MUL/DIV set Z and N only, so the result alone is enough to record. */
+static inline word_t alu_mul_lazy(word_t a, word_t b, ALULazyFlags *lz)
+{
+    ALUFlags f;
+    word_t   r = alu_mul(a, b, &f);
+    *lz = (ALULazyFlags){ ALU_LAZY_ZN, a, b, r };
+    return r;
+}
+
+static inline word_t alu_div_lazy(word_t a, word_t b, ALULazyFlags *lz)
+{
+    ALUFlags f;
+    word_t   r = alu_div(a, b, &f);
+    *lz = (ALULazyFlags){ ALU_LAZY_ZN, a, b, r };
+    return r;
+}
+
+/* SDIV/SREM/UREM/MLA follow the same rule. */
+static inline word_t alu_sdiv_lazy(word_t a, word_t b, ALULazyFlags *lz)
+{
+    ALUFlags f;
+    word_t   r = alu_sdiv(a, b, &f);
+    *lz = (ALULazyFlags){ ALU_LAZY_ZN, a, b, r };
+    return r;
+}
+
+static inline word_t alu_srem_lazy(word_t a, word_t b, ALULazyFlags *lz)
+{
+    ALUFlags f;
+    word_t   r = alu_srem(a, b, &f);
+    *lz = (ALULazyFlags){ ALU_LAZY_ZN, a, b, r };
+    return r;
+}
+
+static inline word_t alu_urem_lazy(word_t a, word_t b, ALULazyFlags *lz)
+{
+    ALUFlags f;
+    word_t   r = alu_urem(a, b, &f);
+    *lz = (ALULazyFlags){ ALU_LAZY_ZN, a, b, r };
+    return r;
+}
+
+static inline word_t alu_mla_lazy(word_t acc, word_t a, word_t b,
+                                  ALULazyFlags *lz)
+{
+    ALUFlags f;
+    word_t   r = alu_mla(acc, a, b, &f);
+    *lz = (ALULazyFlags){ ALU_LAZY_ZN, a, b, r };
+    return r;
+}
+
+/*
+ * UMULL/SMULL take Z and N from the double word.  Recording the high word
+ * with bit 0 forced on when the low word is non-zero keeps both: the
+ * stand-in is zero exactly when the product is, and its MSB is the sign.
+ */
+static inline word_t alu_mull_lazy(word_t a, word_t b, word_t *hi,
+                                   int is_signed, ALULazyFlags *lz)
+{
+    ALUFlags f;
+    word_t   lo = is_signed ? alu_smull(a, b, hi, &f)
+                            : alu_umull(a, b, hi, &f);
+    *lz = (ALULazyFlags){ ALU_LAZY_ZN, a, b, *hi | (word_t)(lo != 0u) };
+    return lo;
+}
+
+/*
+ * Materialise the recorded op's flags into *f (no-op for ALU_LAZY_NONE).
+ * C and V are recovered from the operands and the result: an add carries
+ * out exactly when the result wraps below a, a subtract borrows exactly
+ * when a < b, and V uses the sign rules of alu_add/alu_sub.
+ */
+static inline void alu_lazy_resolve(const ALULazyFlags *lz, ALUFlags *f)
+{
+    word_t   a = lz->a, b = lz->b, r = lz->result;
+    uint32_t c, v;
+
+    switch (lz->op) {
+        case ALU_LAZY_NONE:
+            return;
+        case ALU_LAZY_ADD:
+            c = r < a;
+            v = (uint32_t)((((a ^ r) & (b ^ r)) >> WORD_MSB) & 1u);
+            break;
+        case ALU_LAZY_SUB:
+            c = a >= b;
+            v = (uint32_t)((((a ^ b) & (a ^ r)) >> WORD_MSB) & 1u);
+            break;
+        default:
+            c = 0;
+            v = 0;
+            break;
+    }
+    f->nzcv = alu_nzcv((uint32_t)(r >> WORD_MSB) & 1u, r == 0u, c, v);
+}
+
+/*
+ * Resolve, then clear the record: *f is current afterwards.  Cores call
+ * this before an operation that updates *f in place (the logical and
+ * shift ops keep C and V).
+ */
+static inline void alu_lazy_flush(ALULazyFlags *lz, ALUFlags *f)
+{
+    alu_lazy_resolve(lz, f);
+    lz->op = ALU_LAZY_NONE;
+}
+
+/* Z as alu_lazy_resolve would set it: the one flag JZ/JNZ read. */
+static inline int alu_lazy_zero(const ALULazyFlags *lz, const ALUFlags *f)
+{
+    return lz->op == ALU_LAZY_NONE ? (f->nzcv & ALU_FLAG_Z) != 0
+                                   : lz->result == 0u;
+}
+
+/*
+ * Human-readable flags, "Z=1 N=0 C=1 V=0": one of 16 precomputed strings,
+ * so rendering a trace line costs a table lookup, not a format call.
+ */
+const char *alu_flags_str(ALUFlags f);
 
 #endif /* ALU_H */
@@ -0,0 +1,167 @@
+/*
+ * alu_batch.c — bitsliced ripple-carry adder (see alu_batch.h).
+ *
+ * A group of up to ALU_BATCH_LANES operand pairs is processed as
+ * BATCH_BLOCKS blocks of 64 lanes.  Each block is a 64x64 bit matrix, one
+ * row per lane, with the word_t operand in the low bits.  Transposing it
+ * turns row k into bit-plane k: bit i of row k is bit k of lane i.  Rows
+ * of the same plane from all blocks sit next to each other, so with AVX2
+ * one 256-bit load fetches a whole plane.
+ */
+
+#include "alu_batch.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define BLOCK_LANES 64u   /* lanes per uint64_t plane word */
+
+/* ── Plane type ───────────────────────────────────────────────────────────── */
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define BATCH_BLOCKS 4
+typedef __m256i plane_t;
+#  define P_LOAD(p)      _mm256_loadu_si256((const __m256i *)(const void *)(p))
+#  define P_STORE(p, x)  _mm256_storeu_si256((__m256i *)(void *)(p), (x))
+#  define P_AND          _mm256_and_si256
+#  define P_OR           _mm256_or_si256
+#  define P_XOR          _mm256_xor_si256
+#  define P_ONES         _mm256_set1_epi64x(-1)
+#  define P_ZERO         _mm256_setzero_si256()
+#else
+#  define BATCH_BLOCKS 1
+typedef uint64_t plane_t;
+#  define P_LOAD(p)      (*(p))
+#  define P_STORE(p, x)  (*(p) = (x))
+#  define P_AND(a, b)    ((a) & (b))
+#  define P_OR(a, b)     ((a) | (b))
+#  define P_XOR(a, b)    ((a) ^ (b))
+#  define P_ONES         (~(uint64_t)0)
+#  define P_ZERO         ((uint64_t)0)
+#endif
+
+_Static_assert(ALU_BATCH_LANES == BLOCK_LANES * BATCH_BLOCKS,
+               "ALU_BATCH_LANES must match the plane width");
+
+/* Index of lane i's row in a group matrix (row-major, blocks interleaved). */
+#define CELL(row, blk)  ((size_t)(row) * BATCH_BLOCKS + (size_t)(blk))
+
+/* ── Transpose ────────────────────────────────────────────────────────────── */
+
+/*
+ * In-place transpose of the 64x64 bit matrix whose rows are m[0], m[s],
+ * m[2s], ...: afterwards bit c of row r is what bit r of row c was.  Six
+ * rounds of block swaps (Hacker's Delight, 7-3); the transpose is its own
+ * inverse, so the same routine converts back.
+ */
+static void transpose64(uint64_t *m, size_t s)
+{
+    uint64_t mask = 0x00000000FFFFFFFFull;
+
+    for (unsigned j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+        for (unsigned k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((m[k * s] >> j) ^ m[(k | j) * s]) & mask;
+            m[k * s]       ^= t << j;
+            m[(k | j) * s] ^= t;
+        }
+    }
+}
+
+/* ── Bitsliced adder ──────────────────────────────────────────────────────── */
+
+/*
+ * One group of n <= ALU_BATCH_LANES lanes.  The carry chain is ripple_add
+ * from alu.c with every 1-bit signal widened to a plane:
+ *
+ *   sum_k   = a_k ^ b_k ^ carry_k
+ *   carry   = (a_k & b_k) | (carry_k & (a_k ^ b_k))
+ *
+ * with b inverted and carry_0 = 1 for subtraction.  V is the gate-level
+ * overflow detector, carry into the MSB XOR carry out of it, which equals
+ * alu.c's sign-comparison rule for both add and subtract.
+ */
+static void slice_group(const word_t *a, const word_t *b, word_t *out,
+                        ALUFlags *flags, size_t n, int sub)
+{
+    uint64_t A[BLOCK_LANES * BATCH_BLOCKS];
+    uint64_t B[BLOCK_LANES * BATCH_BLOCKS];
+    uint64_t S[BLOCK_LANES * BATCH_BLOCKS];
+    uint64_t Z[BATCH_BLOCKS], N[BATCH_BLOCKS], C[BATCH_BLOCKS],
+             V[BATCH_BLOCKS];
+
+    memset(A, 0, sizeof(A));
+    memset(B, 0, sizeof(B));
+    memset(S, 0, sizeof(S));
+    for (size_t i = 0; i < n; i++) {
+        A[CELL(i % BLOCK_LANES, i / BLOCK_LANES)] = a[i];
+        B[CELL(i % BLOCK_LANES, i / BLOCK_LANES)] = b[i];
+    }
+    for (size_t blk = 0; blk < BATCH_BLOCKS; blk++) {
+        transpose64(&A[blk], BATCH_BLOCKS);
+        transpose64(&B[blk], BATCH_BLOCKS);
+    }
+
+    plane_t invert = sub ? P_ONES : P_ZERO;
+    plane_t carry  = invert;            /* carry_in: 1 for a + ~b + 1 */
+    plane_t msb_in = P_ZERO;            /* carry into the MSB         */
+    plane_t any    = P_ZERO;            /* OR of all sum bits         */
+    plane_t sum    = P_ZERO;
+
+    for (unsigned k = 0; k < WORD_BITS; k++) {
+        plane_t x = P_LOAD(&A[CELL(k, 0)]);
+        plane_t y = P_XOR(P_LOAD(&B[CELL(k, 0)]), invert);
+        plane_t p = P_XOR(x, y);
+
+        sum    = P_XOR(p, carry);
+        msb_in = carry;
+        carry  = P_OR(P_AND(x, y), P_AND(carry, p));
+        any    = P_OR(any, sum);
+        P_STORE(&S[CELL(k, 0)], sum);
+    }
+
+    P_STORE(Z, P_XOR(any, P_ONES));
+    P_STORE(N, sum);
+    P_STORE(C, carry);
+    P_STORE(V, P_XOR(carry, msb_in));
+
+    for (size_t blk = 0; blk < BATCH_BLOCKS; blk++)
+        transpose64(&S[blk], BATCH_BLOCKS);
+
+    for (size_t i = 0; i < n; i++) {
+        size_t blk = i / BLOCK_LANES;
+        size_t bit = i % BLOCK_LANES;
+
+        out[i] = (word_t)S[CELL(bit, blk)];
+        if (flags)
+            flags[i].nzcv = alu_nzcv((uint32_t)(N[blk] >> bit) & 1u,
+                                     (uint32_t)(Z[blk] >> bit) & 1u,
+                                     (uint32_t)(C[blk] >> bit) & 1u,
+                                     (uint32_t)(V[blk] >> bit) & 1u);
+    }
+}
+
+static void slice_run(const word_t *a, const word_t *b, word_t *out,
+                      ALUFlags *flags, size_t n, int sub)
+{
+    for (size_t base = 0; base < n; base += ALU_BATCH_LANES) {
+        size_t group = n - base < ALU_BATCH_LANES ? n - base
+                                                  : ALU_BATCH_LANES;
+        slice_group(a + base, b + base, out + base,
+                    flags ? flags + base : NULL, group, sub);
+    }
+}
+
+/* ── Public entry points ──────────────────────────────────────────────────── */
+
+void alu_add_batch(const word_t *a, const word_t *b, word_t *out,
+                   ALUFlags *flags, size_t n)
+{
+    slice_run(a, b, out, flags, n, 0);
+}
+
+void alu_sub_batch(const word_t *a, const word_t *b, word_t *out,
+                   ALUFlags *flags, size_t n)
+{
+    slice_run(a, b, out, flags, n, 1);
+}
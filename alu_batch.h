@@ -0,0 +1,41 @@
+#ifndef ALU_BATCH_H
+#define ALU_BATCH_H
+
+#include <stddef.h>
+
+#include "alu.h"
+
+/*
+ * Batch ALU — bitsliced ripple-carry add/subtract over many operand pairs.
+ *
+ * ALU_BATCH_LANES pairs at a time are transposed into WORD_BITS bit-planes:
+ * plane k holds bit k of every lane, one lane per bit of a machine word
+ * (64 lanes in a uint64_t, or 256 in an AVX2 register).  The ripple-carry
+ * chain of alu.c then runs once over the planes, each gate a single
+ * bitwise operation, so every lane gets the gate-level semantics of the
+ * ALU_RIPPLE adder at a fraction of its per-pair cost.  Sums are
+ * transposed back; Z, N, C and V come out as planes too.
+ *
+ * Results and flags are identical to alu_add/alu_sub in every ALU mode,
+ * lane for lane.  n need not be a multiple of ALU_BATCH_LANES.
+ *
+ * The 256-lane form needs an AVX2 build (make SIMD=avx2); make test-simd
+ * cross-checks it against the ripple adder at every width.
+ */
+
+#if defined(__AVX2__)
+#  define ALU_BATCH_LANES 256
+#else
+#  define ALU_BATCH_LANES 64
+#endif
+
+/* out[i] = a[i] + b[i] and flags[i] as alu_add, for i < n.  flags may be
+ * NULL; out may alias a or b. */
+void alu_add_batch(const word_t *a, const word_t *b, word_t *out,
+                   ALUFlags *flags, size_t n);
+
+/* out[i] = a[i] - b[i] and flags[i] as alu_sub, for i < n. */
+void alu_sub_batch(const word_t *a, const word_t *b, word_t *out,
+                   ALUFlags *flags, size_t n);
+
+#endif /* ALU_BATCH_H */
@@ -33,6 +33,20 @@ Node *ast_make_binary(BinaryOp op, Node *left, Node *right)
     return n;
 }
 
+Node *ast_make_unary(UnaryOp op, Node *operand)
+{
+    if (!operand) {
+        fprintf(stderr, "ast error: ast_make_unary called with NULL operand\n");
+        exit(EXIT_FAILURE);
+    }
+    Node *n = malloc(sizeof(Node));
+    if (!n) { perror("malloc"); exit(EXIT_FAILURE); }
+    n->type          = NODE_UNARY_OP;
+    n->unary.op      = op;
+    n->unary.operand = operand;
+    return n;
+}
+
 /* ── Destructor ───────────────────────────────────────────────────────────── */
 
 void ast_free(Node *node)
@@ -41,6 +55,8 @@ void ast_free(Node *node)
     if (node->type == NODE_BINARY_OP) {
         ast_free(node->binary.left);
         ast_free(node->binary.right);
+    } else if (node->type == NODE_UNARY_OP) {
+        ast_free(node->unary.operand);
     }
     free(node);
 }
@@ -54,6 +70,13 @@ static const char *op_name(BinaryOp op)
         case OP_SUB: return "SUB";
         case OP_MUL: return "MUL";
         case OP_DIV: return "DIV";
+        case OP_MOD: return "MOD";
+        case OP_AND: return "AND";
+        case OP_OR:  return "OR";
+        case OP_XOR: return "XOR";
+        case OP_SHL: return "SHL";
+        case OP_ASR: return "ASR";
+        case OP_LSR: return "LSR";
     }
     return "???";
 }
@@ -64,6 +87,9 @@ void ast_dump(const Node *node, int depth)
     for (int i = 0; i < depth * 2; i++) fputc(' ', stderr);
     if (node->type == NODE_NUMBER) {
         fprintf(stderr, "NUMBER(%ld)\n", node->value);
+    } else if (node->type == NODE_UNARY_OP) {
+        fprintf(stderr, "NOT\n");
+        ast_dump(node->unary.operand, depth + 1);
     } else {
         fprintf(stderr, "%s\n", op_name(node->binary.op));
         ast_dump(node->binary.left,  depth + 1);
@@ -1,10 +1,11 @@
 #ifndef AST_H
 #define AST_H
 
-/* AST node types — extensible: add NODE_UNARY_OP, NODE_CALL, etc. later */
+/* AST node types — extensible: add NODE_CALL, etc. later */
 typedef enum {
     NODE_NUMBER,
-    NODE_BINARY_OP
+    NODE_BINARY_OP,
+    NODE_UNARY_OP
 } NodeType;
 
 /* Operator tag stored in binary nodes */
@@ -12,9 +13,21 @@ typedef enum {
     OP_ADD,
     OP_SUB,
     OP_MUL,
-    OP_DIV
+    OP_DIV,     /* signed */
+    OP_MOD,     /* signed remainder */
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_SHL,
+    OP_ASR,     /* >>  */
+    OP_LSR      /* >>> */
 } BinaryOp;
 
+/* Operator tag stored in unary nodes */
+typedef enum {
+    OP_NOT      /* ~ */
+} UnaryOp;
+
 typedef struct Node Node;
 
 struct Node {
@@ -29,12 +42,19 @@ struct Node {
             Node    *left;
             Node    *right;
         } binary;
+
+        /* NODE_UNARY_OP */
+        struct {
+            UnaryOp op;
+            Node   *operand;
+        } unary;
     };
 };
 
 /* Constructors */
 Node *ast_make_number(long value);
 Node *ast_make_binary(BinaryOp op, Node *left, Node *right);
+Node *ast_make_unary(UnaryOp op, Node *operand);
 
 /* Recursive destructor — frees the entire subtree */
 void  ast_free(Node *node);
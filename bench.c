@@ -0,0 +1,1794 @@
+/*
+ * bench.c — throughput benchmarks for the simulator core.
+ *
+ * Not part of the math_sim pipeline; built separately by `make bench`.
+ *
+ * Workload: the countdown loop from run_loop_demo (main.c), scaled up:
+ *
+ *   0  LOAD_CONST R0, <iterations>
+ *   1  LOAD_CONST R1, 1
+ *   2  SUB        R0, R1      ; loop:
+ *   3  JNZ        2
+ *
+ * Each configuration (trace mode × interpreter core) is timed with
+ * CLOCK_MONOTONIC and reported as dispatched instructions per second.
+ * The final CPU states of all trace-off runs are compared bit-for-bit,
+ * and the binary trace sink's throughput is given relative to the text
+ * sink's.
+ * The "pipeline model" row feeds the trace to the 5-stage timing model
+ * and prints its cycle count and stalls.  The "cache model" row instead
+ * runs a LOAD sweep over CACHE_BENCH_SPAN bytes (16 KiB, four times L1)
+ * through the L1/L2/L3 hierarchy of cache.h, and prints each level's hits
+ * and misses and the AMAT.  The "stack distance" row repeats that sweep
+ * under the stackdist.h analysis and prints its miss-ratio curve.
+ * A further row runs the same loop on BENCH_LANES lanes of
+ * cpu_execute_batch, splitting the iterations between lanes.
+ *
+ * The pool rows split the iterations into POOL_JOBS countdown jobs of
+ * uneven length and run them on the work-stealing pool with 1, 2, 4, ...
+ * workers up to the host CPU count, reporting the speedup over one worker
+ * and, for the widest run, per-worker utilization.
+ *
+ * The scheduler rows show tail latency: SCHED_SHORT short jobs are queued
+ * behind SCHED_RUNAWAY jobs that loop until their step budget runs out,
+ * and the finish times of the short jobs are reported for run-to-
+ * completion, round-robin quanta, and round robin with the short jobs at
+ * higher priority.  (The runaway jobs' step-limit errors are expected.)
+ *
+ * The alu rows time the bare adder (dependent ADD/SUB pairs) in each
+ * mode of alu.h, listing the gate count and depth of the gate-level ones,
+ * and independent ADD/SUBs on the bitsliced batch adder of alu_batch.h.
+ *
+ * Usage: math_sim_bench [iterations]     (default 100000000)
+ *        math_sim_bench --check [programs] (default 2000)
+ *
+ * --check runs a differential test instead; the exit status is non-zero
+ * on any mismatch.  In order:
+ *
+ *   - alu: every alu.h adder and the bitsliced one against the
+ *     ripple-carry reference, on every pair of edge operands and on
+ *     random pairs; the table adder exhaustively per byte; the iterative
+ *     multiplier and divider against native arithmetic.
+ *   - cores: random verified programs on the switch core, then on the
+ *     threaded core (predecoded once, run twice), the JIT, the verified
+ *     switch core after ir_program_fuse, and in short cpu_run slices of a
+ *     persistent context.  Status, result, registers, flags and memory
+ *     must agree.
+ *   - batch: each program over CHECK_LANES lanes of cpu_execute_batch
+ *     from random registers and flags, every lane against a
+ *     cpu_execute_verified run from the same state.
+ *   - pool and scheduler: every program queued twice on a CHECK_WORKERS
+ *     thread pool on each core, and through the scheduler in groups of
+ *     CHECK_SCHED_JOBS with random priorities and a tiny quantum.  Per-job
+ *     status and result (and, for the scheduler, memory) must match a
+ *     sequential run.
+ *   - binary trace: every record of the binary sink against the event it
+ *     came from, byte for byte at the documented offsets.
+ *   - cache: cache.h against known answers.  Address sweeps whose misses,
+ *     evictions and writebacks follow from the geometry and policies, an
+ *     access sequence on which pseudo-LRU and LRU must differ, and a CPU
+ *     run whose LOADs and STOREs must all reach the cache sink.
+ *   - stack distance: one stackdist.h pass against a separate cache.h
+ *     simulation of every LRU size it predicts, plus a hand-computed
+ *     sequence and a CPU run.
+ *   - memory stats: Memory's access, fault and per-page heatmap counters
+ *     after known sweeps and faulting accesses.
+ *   - sparse memory: random writes across the whole address space read
+ *     back and allocate exactly their pages; a mem_copy compares equal;
+ *     mem_reset keeps its pages but zeroes them; and a read-only scan
+ *     with the heatmap on counts its reads without allocating.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "ir.h"
+#include "cpu.h"
+#include "alu.h"
+#include "alu_batch.h"
+#include "trace.h"
+#include "jit.h"
+#include "cpu_batch.h"
+#include "pool.h"
+#include "scheduler.h"
+#include "pipeline.h"
+#include "cache.h"
+#include "stackdist.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 100000000L
+#define DEFAULT_CHECKS     2000L
+#define CHECK_MAX_STEPS    1000u
+#define CHECK_LANES        19     /* not a multiple of the SIMD width */
+#define CHECK_WORKERS      4
+#define CHECK_SCHED_JOBS   64
+#define CHECK_QUANTUM      3
+#define BENCH_LANES        1024u
+#define POOL_JOBS          4096u
+#define POOL_SHAPES        8u     /* distinct job lengths */
+#define SCHED_SHORT        1000u
+#define SCHED_RUNAWAY      4u
+#define SCHED_SHORT_ITERS  100
+#define SCHED_BUDGET       1000000u
+#define ALU_OPS            10000000u
+#define ALU_CHECK_PAIRS    256    /* random operand pairs per program */
+#define ALU_BENCH_PAIRS    4096u  /* operand pairs per batch ALU call  */
+#define CACHE_BENCH_SPAN   (WORD_BITS > 8 ? 16384u : 256u)  /* bytes swept */
+
+/* ── Helpers ──────────────────────────────────────────────────────────────── */
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void build_countdown(IRProgram *prog, long iterations)
+{
+    ir_program_init(prog);
+    ir_program_append(prog, (IRInstr){.op=IR_LOAD_CONST,.dst=0,.imm=iterations});
+    ir_program_append(prog, (IRInstr){.op=IR_LOAD_CONST,.dst=1,.imm=1        });
+    ir_program_append(prog, (IRInstr){.op=IR_SUB,       .dst=0,.src=1        });
+    ir_program_append(prog, (IRInstr){.op=IR_JNZ,       .target=2            });
+}
+
+/*
+ * Run the countdown once on `core` with `trace` (NULL = trace off) and
+ * print one result row.  The final CPU state is stored in *state.
+ * Returns 0 on success.
+ */
+static int bench_run(const char *label, const IRProgram *prog,
+                     long iterations, const TraceSink *trace, CPUCore core,
+                     int verified, CPU *state)
+{
+    /* 2 instructions per iteration plus the two LOAD_CONSTs. */
+    size_t     instrs = (size_t)iterations * 2u + 2u;
+    CPUOptions opts   = { .trace = trace, .max_steps = instrs, .core = core,
+                          .out_state = state };
+    long       result = -1;
+
+    double t0     = now_seconds();
+    int    status = verified
+                  ? cpu_execute_verified(prog, NULL, &result, &opts)
+                  : cpu_execute_opts(prog, NULL, &result, &opts);
+    double dt     = now_seconds() - t0;
+
+    if (status != 0 || result != 0) {
+        fprintf(stderr, "bench: %s run failed (status=%d, R0=%ld)\n",
+                label, status, result);
+        return -1;
+    }
+
+    printf("  %-24s %12zu instrs  %8.3f s  %14.0f instr/s\n",
+           label, instrs, dt, (double)instrs / dt);
+    return 0;
+}
+
+/*
+ * Run the countdown on BENCH_LANES lanes in lockstep, iterations split
+ * evenly between them, and print one result row.  Returns 0 on success.
+ */
+static int bench_batch(long iterations)
+{
+    long      per    = iterations / (long)BENCH_LANES > 0
+                     ? iterations / (long)BENCH_LANES : 1;
+    size_t    instrs = BENCH_LANES * ((size_t)per * 2u + 2u);
+    word_t   *regs   = calloc(CPU_MAX_REGS * BENCH_LANES, sizeof(word_t));
+    int      *status = calloc(BENCH_LANES, sizeof(int));
+    IRProgram prog;
+    char      label[32];
+
+    if (!regs || !status) { perror("calloc"); exit(EXIT_FAILURE); }
+    build_countdown(&prog, per);
+    ir_program_verify(&prog, CPU_MAX_REGS);
+
+    CPUBatch batch = { .lanes = BENCH_LANES, .regs = regs,
+                       .status = status };
+    double t0 = now_seconds();
+    int    rc = cpu_execute_batch(&prog, &batch, instrs);
+    double dt = now_seconds() - t0;
+
+    for (size_t i = 0; rc == 0 && i < BENCH_LANES; i++)
+        if (regs[i] != 0u)   /* R0 row */
+            rc = -1;
+    if (rc != 0)
+        fprintf(stderr, "bench: batch run failed\n");
+    else {
+        snprintf(label, sizeof(label), "batch x%u, trace off", BENCH_LANES);
+        printf("  %-24s %12zu instrs  %8.3f s  %14.0f instr/s\n",
+               label, instrs, dt, (double)instrs / dt);
+    }
+
+    ir_program_free(&prog);
+    free(regs);
+    free(status);
+    return rc;
+}
+
+/*
+ * Scaling of the work-stealing pool.  Job j counts down
+ * per * (SHAPES + j % SHAPES) / (2 * SHAPES) iterations, so deques drain
+ * unevenly and stealing has work to do.  Returns 0 on success.
+ */
+static int bench_pool(long iterations)
+{
+    IRProgram shapes[POOL_SHAPES];
+    PoolJob  *jobs  = calloc(POOL_JOBS, sizeof(PoolJob));
+    long      per   = iterations / (long)POOL_JOBS > 0
+                    ? iterations / (long)POOL_JOBS : 1;
+    size_t    instrs = 0;
+    int       rc     = 0;
+
+    if (!jobs) { perror("calloc"); exit(EXIT_FAILURE); }
+    for (size_t s = 0; s < POOL_SHAPES; s++) {
+        long n = per * (long)(POOL_SHAPES + s) / (long)(2 * POOL_SHAPES);
+        build_countdown(&shapes[s], n > 0 ? n : 1);
+        ir_program_verify(&shapes[s], CPU_MAX_REGS);
+    }
+    for (size_t j = 0; j < POOL_JOBS; j++) {
+        jobs[j].prog = &shapes[j % POOL_SHAPES];
+        instrs += (size_t)jobs[j].prog->data[0].imm * 2u + 2u;
+    }
+
+    size_t    max_workers = pool_default_workers();
+    double    base        = 0.0;
+    PoolStats stats;
+
+    for (size_t w = 1; ; w = w * 2 < max_workers ? w * 2 : max_workers) {
+        char label[32];
+        for (size_t j = 0; j < POOL_JOBS; j++)
+            jobs[j].max_steps = instrs;
+        rc = pool_run(jobs, POOL_JOBS, w, CPU_CORE_SWITCH, &stats);
+        if (rc != 0) {
+            fprintf(stderr, "bench: pool run failed\n");
+            break;
+        }
+        if (w == 1)
+            base = stats.wall_seconds;
+        snprintf(label, sizeof(label), "pool x%zu, trace off", w);
+        printf("  %-24s %12zu instrs  %8.3f s  %14.0f instr/s  %5.2fx\n",
+               label, instrs, stats.wall_seconds,
+               (double)instrs / stats.wall_seconds,
+               base / stats.wall_seconds);
+        if (w >= max_workers)
+            break;
+    }
+    if (rc == 0)
+        pool_print_stats(&stats, stdout);
+
+    for (size_t s = 0; s < POOL_SHAPES; s++)
+        ir_program_free(&shapes[s]);
+    free(jobs);
+    return rc;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Finish-time percentiles of the short jobs for one scheduler setup. */
+static int bench_sched_row(const char *label, SchedJob *jobs, size_t quantum,
+                           int short_priority)
+{
+    static double finish[SCHED_SHORT];
+    size_t        n = SCHED_RUNAWAY + SCHED_SHORT;
+
+    for (size_t j = 0; j < n; j++)
+        jobs[j].priority = j < SCHED_RUNAWAY ? 0 : short_priority;
+
+    SchedOptions opts = { .quantum = quantum };
+    double t0 = now_seconds();
+    scheduler_run(jobs, n, &opts);
+    double dt = now_seconds() - t0;
+
+    for (size_t j = 0; j < SCHED_SHORT; j++) {
+        if (jobs[SCHED_RUNAWAY + j].status != 0) {
+            fprintf(stderr, "bench: short scheduler job failed\n");
+            return -1;
+        }
+        finish[j] = jobs[SCHED_RUNAWAY + j].finish_seconds;
+    }
+    qsort(finish, SCHED_SHORT, sizeof(finish[0]), cmp_double);
+
+    printf("  %-24s p50 %8.3f ms  p99 %8.3f ms  max %8.3f ms  "
+           "(all jobs %.3f s)\n", label,
+           finish[SCHED_SHORT / 2] * 1e3, finish[SCHED_SHORT * 99 / 100] * 1e3,
+           finish[SCHED_SHORT - 1] * 1e3, dt);
+    return 0;
+}
+
+/*
+ * Short-job latency with runaway jobs queued first: run to completion
+ * (quantum = budget), round robin, and round robin with priorities.
+ */
+static int bench_sched(void)
+{
+    IRProgram shortp, runaway;
+    SchedJob *jobs = calloc(SCHED_RUNAWAY + SCHED_SHORT, sizeof(SchedJob));
+    int       rc   = 0;
+
+    if (!jobs) { perror("calloc"); exit(EXIT_FAILURE); }
+    build_countdown(&shortp, SCHED_SHORT_ITERS);
+    build_countdown(&runaway, 0);   /* 0 - 1 wraps: ~2^32 iterations */
+    ir_program_verify(&shortp, CPU_MAX_REGS);
+    ir_program_verify(&runaway, CPU_MAX_REGS);
+
+    for (size_t j = 0; j < SCHED_RUNAWAY + SCHED_SHORT; j++) {
+        jobs[j].prog      = j < SCHED_RUNAWAY ? &runaway : &shortp;
+        jobs[j].max_steps = SCHED_BUDGET;
+    }
+
+    printf("scheduler, %u short jobs behind %u runaway jobs "
+           "(short-job finish times):\n", SCHED_SHORT, SCHED_RUNAWAY);
+    rc |= bench_sched_row("run to completion", jobs, SCHED_BUDGET, 0);
+    rc |= bench_sched_row("round robin, q=1000", jobs, 1000, 0);
+    rc |= bench_sched_row("priority + rr, q=1000", jobs, 1000, 2);
+
+    ir_program_free(&shortp);
+    ir_program_free(&runaway);
+    free(jobs);
+    return rc;
+}
+
+/*
+ * ALU_OPS dependent ADD/SUB pairs on the current adder.  Returns the
+ * elapsed time; the folded result goes to *sink so nothing is elided.
+ */
+static double bench_alu_mode(ALUMode mode, word_t *sink)
+{
+    ALUFlags f;
+    word_t   x = (word_t)0x12345678u, k = (word_t)0x9E3779B9u;
+
+    alu_set_mode(mode);
+    double t0 = now_seconds();
+    for (uint32_t i = 0; i < ALU_OPS / 2u; i++) {
+        x = alu_add(x, k, &f);
+        x = alu_sub(x, (word_t)alu_flag(f, ALU_FLAG_C) + i, &f);
+    }
+    double dt = now_seconds() - t0;
+    alu_set_mode(ALU_NATIVE);
+
+    *sink = x ^ (word_t)alu_flag(f, ALU_FLAG_V);
+    return dt;
+}
+
+/*
+ * ALU_OPS independent ADD/SUB operations through the bitsliced batch
+ * entry points, ALU_BENCH_PAIRS at a time.  Returns the elapsed time.
+ */
+static double bench_alu_batch(void)
+{
+    static word_t a[ALU_BENCH_PAIRS], b[ALU_BENCH_PAIRS];
+    static ALUFlags flags[ALU_BENCH_PAIRS];
+
+    for (size_t i = 0; i < ALU_BENCH_PAIRS; i++) {
+        a[i] = (word_t)(0x9E3779B9u * (i + 1u));
+        b[i] = (word_t)(0x85EBCA6Bu * (i + 7u));
+    }
+
+    double t0 = now_seconds();
+    for (uint32_t done = 0; done < ALU_OPS; done += 2u * ALU_BENCH_PAIRS) {
+        alu_add_batch(a, b, a, flags, ALU_BENCH_PAIRS);
+        alu_sub_batch(a, b, b, flags, ALU_BENCH_PAIRS);
+    }
+    return now_seconds() - t0;
+}
+
+/*
+ * Every alu.h adder on the bare operation, with the gate count and depth
+ * of the modelled hardware, then the bitsliced batch adder.
+ */
+static int bench_alu(void)
+{
+    word_t sink[ALU_MODE_COUNT];
+    double native = 0.0;
+    char   label[32];
+    int    rc = 0;
+
+    printf("alu add/sub, %u ops:\n", ALU_OPS);
+    for (int m = 0; m < ALU_MODE_COUNT; m++) {
+        ALUAdderCost cost;
+        double       dt = bench_alu_mode((ALUMode)m, &sink[m]);
+
+        if (m == ALU_NATIVE)
+            native = dt;
+        printf("  %-24s %12u ops     %8.3f s  %14.0f ops/s  %5.2fx slower",
+               alu_mode_name((ALUMode)m), ALU_OPS, dt,
+               (double)ALU_OPS / dt, dt / native);
+        if (alu_adder_cost((ALUMode)m, &cost) == 0)
+            printf("  %4u gates, depth %2u", cost.gates, cost.depth);
+        printf("\n");
+
+        if (sink[m] != sink[ALU_NATIVE]) {
+            fprintf(stderr, "bench: %s and native adders disagree\n",
+                    alu_mode_name((ALUMode)m));
+            rc = -1;
+        }
+    }
+
+    double sliced = bench_alu_batch();
+    snprintf(label, sizeof(label), "bitsliced x%d", ALU_BATCH_LANES);
+    printf("  %-24s %12u ops     %8.3f s  %14.0f ops/s  %5.2fx slower\n",
+           label, ALU_OPS, sliced, (double)ALU_OPS / sliced,
+           sliced / native);
+    return rc;
+}
+
+/* Compare registers and flags against the reference run. */
+static int check_same_state(const char *label, const CPU *ref,
+                            const CPU *got)
+{
+    int same = memcmp(ref->regs, got->regs, sizeof(ref->regs)) == 0
+            && memcmp(&ref->flags, &got->flags, sizeof(ref->flags)) == 0;
+    if (!same)
+        fprintf(stderr, "bench: %s registers/flags differ from the "
+                        "switch core\n", label);
+    return same ? 0 : -1;
+}
+
+/* ── Differential check: JIT and fusion vs switch core ────────────────────── */
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+/* xorshift64 — deterministic, so failures are reproducible. */
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 16);
+}
+
+/* Operand values biased toward flag edge cases and valid addresses. */
+static long random_imm(void)
+{
+    static const uint32_t edges[] = {
+        0u, 1u, 2u, 0x7FFFFFFFu, 0x80000000u, 0xFFFFFFFFu, 0xFFFFFFFEu
+    };
+    size_t n_edges = sizeof(edges) / sizeof(edges[0]);
+    switch (rng() % 4) {
+        case 0:  return (long)edges[rng() % n_edges];
+        case 1:  return (long)((rng() % 256u) * 4u);       /* aligned addr */
+        case 2:  return (long)(rng() % 16u);
+        default: return (long)rng();
+    }
+}
+
+/* Random program over R0..R7; always passes ir_program_verify. */
+static void random_program(IRProgram *prog)
+{
+    static const IROpcode ops[] = {
+        IR_LOAD_CONST, IR_LOAD_CONST, IR_ADD, IR_SUB, IR_MUL, IR_DIV,
+        IR_CMP, IR_JMP, IR_JZ, IR_JNZ, IR_LOAD, IR_STORE,
+        IR_AND, IR_OR, IR_XOR, IR_NOT, IR_SHL, IR_LSR, IR_ASR, IR_ROR,
+        IR_SDIV, IR_SREM, IR_UREM, IR_UMULL, IR_SMULL, IR_MLA
+    };
+    size_t len = 1u + rng() % 16u;
+
+    ir_program_init(prog);
+    for (size_t i = 0; i < len; i++) {
+        IRInstr in = {
+            .op     = ops[rng() % (sizeof(ops) / sizeof(ops[0]))],
+            .dst    = (int)(rng() % 8u),
+            .src    = (int)(rng() % 8u),
+            .imm    = random_imm(),
+            .target = (int)(rng() % (len + 1u)),
+            .addr   = (int)(rng() % 8u)
+        };
+        ir_program_append(prog, in);
+    }
+    ir_program_verify(prog, CPU_MAX_REGS);
+}
+
+/* Same status, memory and (on success) result, registers and flags? */
+static int same_outcome(int ref_status, long ref_result, const CPU *ref,
+                        const Memory *ref_mem, int got_status, long got_result,
+                        const CPU *got, const Memory *got_mem)
+{
+    int same = ref_status == got_status && mem_equal(ref_mem, got_mem);
+    if (same && ref_status == 0)
+        same = ref_result == got_result
+            && memcmp(ref->regs, got->regs, sizeof(ref->regs)) == 0
+            && memcmp(&ref->flags, &got->flags, sizeof(ref->flags)) == 0;
+    return same;
+}
+
+/* Add and subtract `a`, `b` on every adder; 1 if all match ripple's. */
+static int alu_modes_agree(word_t a, word_t b)
+{
+    ALUFlags fr[2], fm[2];
+    word_t   rr[2], rm[2];
+
+    alu_set_mode(ALU_RIPPLE);
+    rr[0] = alu_add(a, b, &fr[0]);
+    rr[1] = alu_sub(a, b, &fr[1]);
+
+    for (int m = 0; m < ALU_MODE_COUNT; m++) {
+        alu_set_mode((ALUMode)m);
+        rm[0] = alu_add(a, b, &fm[0]);
+        rm[1] = alu_sub(a, b, &fm[1]);
+
+        for (int k = 0; k < 2; k++) {
+            if (rm[k] != rr[k]
+                    || memcmp(&fm[k], &fr[k], sizeof(ALUFlags)) != 0) {
+                printf("ALU MISMATCH: %s 0x%08x, 0x%08x %s 0x%08x "
+                       "ripple 0x%08x\n", k ? "sub" : "add", (unsigned)a,
+                       (unsigned)b, alu_mode_name((ALUMode)m),
+                       (unsigned)rm[k], (unsigned)rr[k]);
+                alu_set_mode(ALU_NATIVE);
+                return 0;
+            }
+        }
+    }
+    alu_set_mode(ALU_NATIVE);
+    return 1;
+}
+
+/* Every multiply and divide of `a`, `b` in `mode`: results, then flags. */
+#define MULDIV_OPS 8
+static void muldiv_all(ALUMulDivMode mode, word_t a, word_t b,
+                       word_t r[MULDIV_OPS + 2], ALUFlags f[MULDIV_OPS])
+{
+    memset(r, 0, (MULDIV_OPS + 2) * sizeof(word_t));
+    memset(f, 0, MULDIV_OPS * sizeof(ALUFlags));
+    alu_set_muldiv_mode(mode);
+    r[0] = alu_mul(a, b, &f[0]);
+    r[1] = alu_mla(b, a, b, &f[1]);
+    r[2] = alu_umull(a, b, &r[MULDIV_OPS], &f[2]);
+    r[3] = alu_smull(a, b, &r[MULDIV_OPS + 1], &f[3]);
+    if (b != 0) {
+        r[4] = alu_div(a, b, &f[4]);
+        r[5] = alu_urem(a, b, &f[5]);
+        r[6] = alu_srem(a, b, &f[6]);
+        if (a != WORD_SMIN || b != WORD_MAX)
+            r[7] = alu_sdiv(a, b, &f[7]);
+    }
+    alu_set_muldiv_mode(ALU_MULDIV_NATIVE);
+}
+
+/* 1 if the iterative multiply/divide unit matches native on `a`, `b`. */
+static int muldiv_modes_agree(word_t a, word_t b)
+{
+    word_t   rn[MULDIV_OPS + 2], ri[MULDIV_OPS + 2];
+    ALUFlags fn[MULDIV_OPS], fi[MULDIV_OPS];
+
+    muldiv_all(ALU_MULDIV_NATIVE, a, b, rn, fn);
+    muldiv_all(ALU_MULDIV_ITERATIVE, a, b, ri, fi);
+    if (memcmp(rn, ri, sizeof(rn)) != 0 || memcmp(fn, fi, sizeof(fn)) != 0) {
+        printf("MULDIV MISMATCH: 0x%08x, 0x%08x\n", (unsigned)a,
+               (unsigned)b);
+        return 0;
+    }
+    return 1;
+}
+
+/* Bitsliced add and sub of pairs [0, n) vs the ripple adder; mismatches. */
+static long batch_alu_mismatches(const word_t *a, const word_t *b, size_t n)
+{
+    word_t   *out   = malloc((n ? n : 1) * sizeof(word_t));
+    ALUFlags *flags = malloc((n ? n : 1) * sizeof(ALUFlags));
+    long      mismatches = 0;
+
+    if (!out || !flags) { perror("malloc"); exit(EXIT_FAILURE); }
+    alu_set_mode(ALU_RIPPLE);
+    for (int sub = 0; sub < 2; sub++) {
+        if (sub)
+            alu_sub_batch(a, b, out, flags, n);
+        else
+            alu_add_batch(a, b, out, flags, n);
+        for (size_t i = 0; i < n; i++) {
+            ALUFlags f;
+            word_t   r = sub ? alu_sub(a[i], b[i], &f)
+                             : alu_add(a[i], b[i], &f);
+            if (r != out[i] || memcmp(&f, &flags[i], sizeof(f)) != 0) {
+                if (mismatches++ < 10)
+                    printf("BATCH ALU MISMATCH: %s 0x%08x, 0x%08x ripple "
+                           "0x%08x bitsliced 0x%08x\n", sub ? "sub" : "add",
+                           (unsigned)a[i], (unsigned)b[i], (unsigned)r,
+                           (unsigned)out[i]);
+            }
+        }
+    }
+    alu_set_mode(ALU_NATIVE);
+
+    free(out);
+    free(flags);
+    return mismatches;
+}
+
+/*
+ * Every adder, and the bitsliced one, vs the ripple-carry reference:
+ * every pair of edge operands (each carry/overflow boundary and its
+ * neighbours), then ALU_CHECK_PAIRS random pairs per program.  The batch
+ * is not a multiple of ALU_BATCH_LANES, so a partial group is covered too.
+ */
+static int run_alu_check(long programs)
+{
+    static const uint32_t edges[] = {
+        0u, 1u, 2u, 3u, 0x7FFFFFFEu, 0x7FFFFFFFu, 0x80000000u, 0x80000001u,
+        0xFFFFFFFEu, 0xFFFFFFFFu, 0x0000FFFFu, 0x00010000u, 0x55555555u,
+        0xAAAAAAAAu, 0x40000000u, 0xC0000000u
+    };
+    size_t  n_edges = sizeof(edges) / sizeof(edges[0]);
+    size_t  pairs   = n_edges * n_edges
+                    + (size_t)programs * ALU_CHECK_PAIRS + 1u;
+    word_t *a       = malloc(pairs * sizeof(word_t));
+    word_t *b       = malloc(pairs * sizeof(word_t));
+    size_t  n       = 0;
+    long    mismatches = 0, batch_mismatches, table_mismatches;
+    long    muldiv_mismatches = 0;
+
+    if (!a || !b) { perror("malloc"); exit(EXIT_FAILURE); }
+    for (size_t i = 0; i < n_edges; i++)
+        for (size_t j = 0; j < n_edges; j++, n++) {
+            a[n] = edges[i];
+            b[n] = edges[j];
+        }
+    for (; n < pairs; n++) {
+        a[n] = rng();
+        b[n] = rng();
+    }
+
+    for (size_t i = 0; i < pairs; i++)
+        mismatches += !alu_modes_agree(a[i], b[i]);
+    for (size_t i = 0; i < pairs; i++)
+        muldiv_mismatches += !muldiv_modes_agree(a[i], b[i]);
+    batch_mismatches = batch_alu_mismatches(a, b, pairs);
+    table_mismatches = alu_table_check();
+
+    printf("alu differential check: %zu operand pairs, all adders vs "
+           "ripple %ld mismatches, bitsliced x%d vs ripple %ld mismatches\n",
+           pairs, mismatches, ALU_BATCH_LANES, batch_mismatches);
+    printf("table adder exhaustive check: %d byte positions x 2x256x256, "
+           "%ld mismatches\n", WORD_BYTES, table_mismatches);
+    printf("mul/div differential check: %zu operand pairs, iterative vs "
+           "native %ld mismatches\n", pairs, muldiv_mismatches);
+
+    free(a);
+    free(b);
+    return mismatches == 0 && batch_mismatches == 0
+        && table_mismatches == 0 && muldiv_mismatches == 0 ? 0 : -1;
+}
+
+static int run_check(long programs)
+{
+    static Memory ref_mem, jit_mem, fused_mem;
+    long mismatches = 0, compiled = 0, fused = 0, slices = 0;
+    long threaded = 0;
+
+    for (long n = 0; n < programs; n++) {
+        IRProgram prog;
+        random_program(&prog);
+        mem_reset(&ref_mem);
+        mem_reset(&jit_mem);
+
+        CPU  ref, got;
+        long ref_result = 0, got_result = 0;
+        memset(&ref, 0, sizeof(ref));
+        memset(&got, 0, sizeof(got));
+
+        CPUOptions opts = { .max_steps = CHECK_MAX_STEPS, .out_state = &ref };
+        int ref_status = cpu_execute_opts(&prog, &ref_mem, &ref_result, &opts);
+
+        /* The threaded core on the same program, predecoded once and run
+         * twice: the stream must carry no state from one run to the next. */
+        CPUCode   *tcode = cpu_prepare(&prog, CPU_CORE_THREADED);
+        CPUOptions topts = { .max_steps = CHECK_MAX_STEPS, .out_state = &got,
+                             .core = CPU_CORE_THREADED, .code = tcode };
+        for (int run = 0; run < 2; run++) {
+            mem_reset(&fused_mem);
+            memset(&got, 0, sizeof(got));
+            got_result = 0;
+            int thr_status = cpu_execute_opts(&prog, &fused_mem, &got_result,
+                                              &topts);
+            if (!same_outcome(ref_status, ref_result, &ref, &ref_mem,
+                              thr_status, got_result, &got, &fused_mem)) {
+                printf("THREADED MISMATCH on program %ld, run %d (status %d "
+                       "vs %d, result %ld vs %ld):\n", n, run, ref_status,
+                       thr_status, ref_result, got_result);
+                ir_program_dump(&prog);
+                mismatches++;
+            }
+        }
+        cpu_code_free(tcode);
+        threaded++;
+        memset(&got, 0, sizeof(got));
+        got_result = 0;
+
+        /* Fusion on a copy: the JIT below still sees the plain program. */
+        IRProgram fprog = prog;
+        fprog.data = malloc(prog.count * sizeof(IRInstr));
+        if (!fprog.data) { perror("malloc"); exit(EXIT_FAILURE); }
+        memcpy(fprog.data, prog.data, prog.count * sizeof(IRInstr));
+        fprog.capacity = prog.count;
+        if (ir_program_fuse(&fprog) > 0) {
+            mem_reset(&fused_mem);
+            memset(&got, 0, sizeof(got));
+            CPUOptions fopts = { .max_steps = CHECK_MAX_STEPS,
+                                 .out_state = &got };
+            int got_status = cpu_execute_verified(&fprog, &fused_mem,
+                                                  &got_result, &fopts);
+            fused++;
+            if (!same_outcome(ref_status, ref_result, &ref, &ref_mem,
+                              got_status, got_result, &got, &fused_mem)) {
+                printf("FUSION MISMATCH on program %ld (status %d vs %d, "
+                       "result %ld vs %ld):\n",
+                       n, ref_status, got_status, ref_result, got_result);
+                ir_program_dump(&fprog);
+                mismatches++;
+            }
+        }
+
+        /* The same (possibly fused) program resumed in short slices. */
+        mem_reset(&fused_mem);
+        CPUContext  *ctx    = cpu_create(&fprog, &fused_mem, NULL);
+        CPURunStatus status = CPU_RUN_BUDGET;
+        while (status == CPU_RUN_BUDGET && cpu_steps(ctx) < CHECK_MAX_STEPS) {
+            size_t left  = CHECK_MAX_STEPS - cpu_steps(ctx);
+            size_t slice = 1u + rng() % 5u;
+            status = cpu_run(ctx, slice < left ? slice : left);
+            slices++;
+        }
+        int got_status = status == CPU_RUN_HALTED ? 0 : -1;
+        if (!same_outcome(ref_status, ref_result, &ref, &ref_mem,
+                          got_status, cpu_result(ctx), cpu_state(ctx),
+                          &fused_mem)) {
+            printf("RESUME MISMATCH on program %ld (status %d vs %d):\n",
+                   n, ref_status, got_status);
+            ir_program_dump(&fprog);
+            mismatches++;
+        }
+        cpu_destroy(ctx);
+        ir_program_free(&fprog);
+
+        memset(&got, 0, sizeof(got));
+        got_result = 0;
+        JitCode *code = jit_compile(&prog);
+        if (!code) {
+            ir_program_free(&prog);
+            continue;
+        }
+        compiled++;
+        got_status = jit_run(code, &jit_mem, &got_result, CHECK_MAX_STEPS,
+                             NULL, &got);
+        jit_free(code);
+
+        if (!same_outcome(ref_status, ref_result, &ref, &ref_mem,
+                          got_status, got_result, &got, &jit_mem)) {
+            printf("MISMATCH on program %ld (status %d vs %d, "
+                   "result %ld vs %ld):\n",
+                   n, ref_status, got_status, ref_result, got_result);
+            ir_program_dump(&prog);
+            mismatches++;
+        }
+        ir_program_free(&prog);
+    }
+
+    /* The countdown's SUB+JNZ loop body must win over the LOAD_CONST+SUB
+     * pair before it, or the fused bench row fuses nothing that loops. */
+    IRProgram loop;
+    build_countdown(&loop, 5);
+    ir_program_fuse(&loop);
+    if (loop.data[1].op != IR_LOAD_CONST
+            || loop.data[2].op != IR_FUSED_SUB_JNZ) {
+        printf("FUSION MISMATCH: countdown loop body not fused:\n");
+        ir_program_dump(&loop);
+        mismatches++;
+    }
+    ir_program_free(&loop);
+
+    printf("differential check: %ld programs, %ld threaded, "
+           "%ld jit-compiled, %ld fused, %ld run slices, %ld mismatches\n",
+           programs, threaded, compiled, fused, slices, mismatches);
+    /* The JIT only exists for 32-bit words (word.h). */
+    return mismatches == 0 && (compiled > 0 || WORD_BITS != 32) ? 0 : -1;
+}
+
+/* Every lane of a batch run must match a scalar run from its state. */
+static int run_batch_check(long programs)
+{
+    static Memory ref_mem, lane_mem[CHECK_LANES];
+    Memory  *mems[CHECK_LANES];
+    word_t   regs[CPU_MAX_REGS * CHECK_LANES];
+    ALUFlags flags[CHECK_LANES];
+    long     results[CHECK_LANES];
+    int      status[CHECK_LANES];
+    CPU      init[CHECK_LANES];
+    long     mismatches = 0;
+
+    for (long n = 0; n < programs; n++) {
+        IRProgram prog;
+        random_program(&prog);
+
+        memset(init, 0, sizeof(init));
+        memset(regs, 0, sizeof(regs));
+        for (size_t i = 0; i < CHECK_LANES; i++) {
+            for (int r = 0; r < 8; r++) {
+                init[i].regs[r] = (word_t)random_imm();
+                regs[(size_t)r * CHECK_LANES + i] = init[i].regs[r];
+            }
+            uint32_t bits = rng();
+            init[i].flags.nzcv = alu_nzcv((bits >> 1) & 1u, bits & 1u,
+                                          (bits >> 2) & 1u, (bits >> 3) & 1u);
+            flags[i]   = init[i].flags;
+            results[i] = 0;
+            mems[i]    = &lane_mem[i];
+            mem_reset(mems[i]);
+        }
+
+        CPUBatch batch = { .lanes = CHECK_LANES, .regs = regs,
+                           .flags = flags, .results = results,
+                           .status = status, .mems = mems };
+        cpu_execute_batch(&prog, &batch, CHECK_MAX_STEPS);
+
+        for (size_t i = 0; i < CHECK_LANES; i++) {
+            CPU  ref, got;
+            long ref_result = 0;
+            memset(&ref, 0, sizeof(ref));
+            memset(&got, 0, sizeof(got));
+            mem_reset(&ref_mem);
+
+            CPUOptions opts = { .max_steps = CHECK_MAX_STEPS,
+                                .in_state = &init[i], .out_state = &ref };
+            int ref_status = cpu_execute_verified(&prog, &ref_mem,
+                                                  &ref_result, &opts);
+            for (int r = 0; r < CPU_MAX_REGS; r++)
+                got.regs[r] = regs[(size_t)r * CHECK_LANES + i];
+            got.flags = flags[i];
+
+            if (!same_outcome(ref_status, ref_result, &ref, &ref_mem,
+                              status[i], results[i], &got, &lane_mem[i])) {
+                printf("BATCH MISMATCH on program %ld lane %zu (status %d "
+                       "vs %d, result %ld vs %ld):\n", n, i, ref_status,
+                       status[i], ref_result, results[i]);
+                ir_program_dump(&prog);
+                mismatches++;
+                break;
+            }
+        }
+        ir_program_free(&prog);
+    }
+
+    printf("batch differential check: %ld programs x %d lanes, "
+           "%ld mismatches\n", programs, CHECK_LANES, mismatches);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/*
+ * Jobs spread over a pool must finish exactly as they do one by one, on
+ * every core.  Each program is queued twice, so the pool's per-program
+ * code (see pool.h) is shared between jobs.
+ */
+static int run_pool_check(long programs)
+{
+    static const CPUCore cores[] = { CPU_CORE_SWITCH, CPU_CORE_THREADED,
+                                     CPU_CORE_JIT };
+    size_t     count   = (size_t)(uint32_t)programs;
+    IRProgram *progs   = calloc(count, sizeof(IRProgram));
+    PoolJob   *jobs    = calloc(2 * count, sizeof(PoolJob));
+    int       *status  = calloc(count, sizeof(int));
+    long      *results = calloc(count, sizeof(long));
+    static Memory mem;
+    PoolStats  stats;
+    long mismatches = 0;
+
+    if (!progs || !jobs || !status || !results) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t n = 0; n < count; n++) {
+        CPUOptions opts = { .max_steps = CHECK_MAX_STEPS };
+        random_program(&progs[n]);
+        mem_reset(&mem);
+        status[n] = cpu_execute_verified(&progs[n], &mem, &results[n],
+                                         &opts);
+    }
+
+    for (size_t c = 0; c < sizeof(cores) / sizeof(cores[0]); c++) {
+        for (size_t j = 0; j < 2 * count; j++)
+            jobs[j] = (PoolJob){ .prog = &progs[j % count],
+                                 .max_steps = CHECK_MAX_STEPS };
+        pool_run(jobs, 2 * count, CHECK_WORKERS, cores[c], &stats);
+
+        for (size_t j = 0; j < 2 * count; j++) {
+            size_t n = j % count;
+            if (status[n] != jobs[j].status
+                    || (status[n] == 0 && results[n] != jobs[j].result)) {
+                printf("POOL MISMATCH on program %zu, core %zu (status %d "
+                       "vs %d, result %ld vs %ld)\n", n, c, status[n],
+                       jobs[j].status, results[n], jobs[j].result);
+                mismatches++;
+            }
+        }
+    }
+    for (size_t n = 0; n < count; n++)
+        ir_program_free(&progs[n]);
+
+    printf("pool differential check: %ld programs as %zu jobs on %zu "
+           "workers x %zu cores, %ld mismatches\n", programs, 2 * count,
+           stats.workers, sizeof(cores) / sizeof(cores[0]), mismatches);
+
+    free(progs);
+    free(jobs);
+    free(status);
+    free(results);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/* Jobs interleaved by the scheduler must finish as they do one by one. */
+static int run_sched_check(long programs)
+{
+    static Memory mems[CHECK_SCHED_JOBS], ref_mem;
+    IRProgram     progs[CHECK_SCHED_JOBS];
+    SchedJob      jobs[CHECK_SCHED_JOBS];
+    SchedOptions  opts = { .threads = CHECK_WORKERS,
+                           .quantum = CHECK_QUANTUM };
+    long mismatches = 0;
+
+    for (long base = 0; base < programs; base += CHECK_SCHED_JOBS) {
+        size_t n = (size_t)(programs - base) < CHECK_SCHED_JOBS
+                 ? (size_t)(programs - base) : CHECK_SCHED_JOBS;
+
+        memset(jobs, 0, sizeof(jobs));
+        for (size_t j = 0; j < n; j++) {
+            random_program(&progs[j]);
+            mem_reset(&mems[j]);
+            jobs[j].prog      = &progs[j];
+            jobs[j].mem       = &mems[j];
+            jobs[j].priority  = (int)(rng() % SCHED_PRIORITIES);
+            jobs[j].max_steps = CHECK_MAX_STEPS;
+        }
+        scheduler_run(jobs, n, &opts);
+
+        for (size_t j = 0; j < n; j++) {
+            CPUOptions ropts  = { .max_steps = CHECK_MAX_STEPS };
+            long       result = 0;
+            mem_reset(&ref_mem);
+            int status = cpu_execute_verified(&progs[j], &ref_mem, &result,
+                                              &ropts);
+            int same = status == jobs[j].status
+                    && mem_equal(&ref_mem, &mems[j])
+                    && (status != 0 || result == jobs[j].result);
+            if (!same) {
+                printf("SCHEDULER MISMATCH on program %ld (status %d vs %d, "
+                       "result %ld vs %ld)\n", base + (long)j, status,
+                       jobs[j].status, result, jobs[j].result);
+                mismatches++;
+            }
+            ir_program_free(&progs[j]);
+        }
+    }
+
+    printf("scheduler differential check: %ld programs, quantum %d, "
+           "%ld mismatches\n", programs, CHECK_QUANTUM, mismatches);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/* ── Binary trace check ───────────────────────────────────────────────────── */
+
+/* Every event of one run, for the binary sink's records to be held to. */
+typedef struct {
+    TraceEvent *ev;
+    size_t      count, capacity;
+} EventLog;
+
+static void log_emit(void *ctx, const TraceEvent *ev)
+{
+    EventLog *log = ctx;
+    if (log->count == log->capacity) {
+        log->capacity = log->capacity ? log->capacity * 2 : 64;
+        log->ev = realloc(log->ev, log->capacity * sizeof(TraceEvent));
+        if (!log->ev) { perror("realloc"); exit(EXIT_FAILURE); }
+    }
+    log->ev[log->count++] = *ev;
+}
+
+/*
+ * Each random program runs once into an EventLog and once into the binary
+ * sink; the file must hold exactly one record per event, little-endian at
+ * the documented offsets, with every operand (MLA's multiplier and the
+ * whole UMULL/SMULL high word included) intact.
+ */
+static int run_trace_check(long programs)
+{
+    static Memory mem;
+    long          mismatches = 0, records = 0;
+    EventLog      log = { 0 };
+    FILE         *file = tmpfile();
+
+    if (!file) { perror("tmpfile"); exit(EXIT_FAILURE); }
+    for (long n = 0; n < programs; n++) {
+        IRProgram prog;
+        long      result;
+        random_program(&prog);
+
+        TraceSink  logged = { .emit = log_emit, .ctx = &log };
+        TraceSink  binary = trace_sink_binary(file);
+        CPUOptions opts   = { .max_steps = CHECK_MAX_STEPS, .trace = &logged };
+        log.count = 0;
+        mem_reset(&mem);
+        cpu_execute_opts(&prog, &mem, &result, &opts);
+        rewind(file);
+        opts.trace = &binary;
+        mem_reset(&mem);
+        cpu_execute_opts(&prog, &mem, &result, &opts);
+        long written = ftell(file);
+        rewind(file);
+
+        if (written != (long)(log.count * TRACE_RECORD_SIZE)) {
+            printf("TRACE MISMATCH on program %ld: %ld bytes for %zu "
+                   "events\n", n, written, log.count);
+            mismatches++;
+        }
+        for (size_t i = 0; i < log.count; i++) {
+            unsigned char     buf[TRACE_RECORD_SIZE];
+            const TraceEvent *ev = &log.ev[i];
+            if (fread(buf, sizeof(buf), 1, file) != 1)
+                break;
+
+            uint64_t aux = 0, value = ev->value;
+            if (ev->op == IR_JMP || ev->op == IR_JZ || ev->op == IR_JNZ)
+                aux = (uint32_t)ev->target;
+            else if (ev->op == IR_LOAD || ev->op == IR_STORE)
+                aux = ev->mem_addr;
+            else if (ev->op == IR_UMULL || ev->op == IR_SMULL)
+                aux = ev->value_hi;
+
+            TraceRecord rec;
+            trace_record_decode(buf, &rec);
+            uint64_t got_value = rec.value, got_aux = rec.aux;
+#if WORD_BITS > 32
+            got_value |= (uint64_t)rec.value_hi << 32;
+            got_aux   |= (uint64_t)rec.aux_hi << 32;
+#endif
+            int bits = ev->flags.nzcv | (ev->taken ? 1 << 4 : 0);
+            if (rec.pc != ev->pc || rec.op != ev->op
+                    || rec.dst != ev->dst || rec.src != ev->src
+                    || rec.addr != ev->addr || rec.bits != bits
+                    || got_value != value || got_aux != aux
+                    || buf[0] != (ev->pc & 0xFFu) || buf[4] != ev->op
+                    || buf[8] != (value & 0xFFu)
+                    || buf[17] | buf[18] | buf[19]) {
+                printf("TRACE MISMATCH on program %ld, record %zu (%s)\n",
+                       n, i, ir_opcode_name(ev->op));
+                mismatches++;
+                break;
+            }
+            records++;
+        }
+        rewind(file);
+        ir_program_free(&prog);
+    }
+    fclose(file);
+    free(log.ev);
+
+    printf("binary trace check: %ld programs, %ld records of %d bytes, "
+           "%ld mismatches\n", programs, records, TRACE_RECORD_SIZE,
+           mismatches);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/* ── Cache model check ────────────────────────────────────────────────────── */
+
+/* Word sweeps of `span` bytes, `passes` times, and the counts they imply. */
+typedef struct {
+    CacheConfig cfg;
+    int         write;         /* sweep with stores instead of loads */
+    uint32_t    span;
+    int         passes;
+    uint64_t    misses, evictions, writebacks, write_throughs;
+} CacheCase;
+
+/* 1 if the stats of `c` are the expected ones; prints a line if not. */
+static int cache_counts_ok(const char *what, const Cache *c, uint64_t misses,
+                           uint64_t evictions, uint64_t writebacks,
+                           uint64_t write_throughs)
+{
+    const CacheStats *s = &c->stats;
+    uint64_t got = s->reads + s->writes - s->read_hits - s->write_hits;
+
+    if (got == misses && s->evictions == evictions
+            && s->writebacks == writebacks
+            && s->write_throughs == write_throughs)
+        return 1;
+    printf("CACHE MISMATCH: %s: misses %llu/%llu, evictions %llu/%llu, "
+           "writebacks %llu/%llu, write-throughs %llu/%llu\n", what,
+           (unsigned long long)got, (unsigned long long)misses,
+           (unsigned long long)s->evictions, (unsigned long long)evictions,
+           (unsigned long long)s->writebacks, (unsigned long long)writebacks,
+           (unsigned long long)s->write_throughs,
+           (unsigned long long)write_throughs);
+    return 0;
+}
+
+/*
+ * STORE or LOAD every word of [0, span) `passes` times, in a loop:
+ *   R0 = count, R1 = address, R2 = 1, R3 = word size, R4 = span - 1
+ */
+static void build_sweep(IRProgram *prog, int write, uint32_t span,
+                        int passes)
+{
+    long count = (long)passes * (long)(span / MEM_WORD_SIZE);
+
+    ir_program_init(prog);
+    ir_program_append(prog, (IRInstr){.op=IR_LOAD_CONST,.dst=0,.imm=count});
+    ir_program_append(prog, (IRInstr){.op=IR_LOAD_CONST,.dst=1,.imm=0});
+    ir_program_append(prog, (IRInstr){.op=IR_LOAD_CONST,.dst=2,.imm=1});
+    ir_program_append(prog, (IRInstr){.op=IR_LOAD_CONST,.dst=3,
+                                      .imm=MEM_WORD_SIZE});
+    ir_program_append(prog, (IRInstr){.op=IR_LOAD_CONST,.dst=4,
+                                      .imm=(long)span - 1});
+    if (write)
+        ir_program_append(prog, (IRInstr){.op=IR_STORE,.src=2,.addr=1});
+    else
+        ir_program_append(prog, (IRInstr){.op=IR_LOAD,.dst=5,.addr=1});
+    ir_program_append(prog, (IRInstr){.op=IR_ADD,.dst=1,.src=3});
+    ir_program_append(prog, (IRInstr){.op=IR_AND,.dst=1,.src=4});
+    ir_program_append(prog, (IRInstr){.op=IR_SUB,.dst=0,.src=2});
+    ir_program_append(prog, (IRInstr){.op=IR_JNZ,.target=5});
+}
+
+static int run_cache_check(void)
+{
+    /* 1 KiB of 16-byte lines, 2-way: 32 sets, 64 lines. */
+#define C1K(repl, wb, wa) \
+    { .size = 1024, .line_size = 16, .ways = 2, .replacement = (repl), \
+      .write_back = (wb), .write_allocate = (wa) }
+    static const CacheCase cases[] = {
+        /* Fits: only the first pass misses. */
+        { C1K(CACHE_LRU,    1, 1), 0, 1024, 2,  64,   0,  0,   0 },
+        { C1K(CACHE_PLRU,   1, 1), 0, 1024, 2,  64,   0,  0,   0 },
+        { C1K(CACHE_RANDOM, 1, 1), 0, 1024, 2,  64,   0,  0,   0 },
+        /* Twice the capacity: LRU (= PLRU at 2 ways) misses every line. */
+        { C1K(CACHE_LRU,    1, 1), 0, 2048, 2, 256, 192,  0,   0 },
+        { C1K(CACHE_PLRU,   1, 1), 0, 2048, 2, 256, 192,  0,   0 },
+        /* Stores: dirty evictions are written back... */
+        { C1K(CACHE_LRU,    1, 1), 1, 2048, 1, 128,  64, 64,   0 },
+        /* ...or every store goes through to memory. */
+        { C1K(CACHE_LRU,    0, 1), 1, 1024, 2,  64,   0,  0, 512 },
+        { C1K(CACHE_LRU,    0, 0), 1, 1024, 2, 512,   0,  0, 512 },
+    };
+#undef C1K
+    size_t n_cases = sizeof(cases) / sizeof(cases[0]);
+    long   mismatches = 0;
+
+    for (size_t i = 0; i < n_cases; i++) {
+        const CacheCase *k = &cases[i];
+        Cache c;
+        char  what[32];
+
+        if (cache_init(&c, &k->cfg, NULL) != 0)
+            return -1;
+        for (int p = 0; p < k->passes; p++)
+            for (uint32_t a = 0; a < k->span; a += 4)
+                cache_access(&c, a, k->write);
+        snprintf(what, sizeof(what), "sweep case %zu", i);
+        mismatches += !cache_counts_ok(what, &c, k->misses, k->evictions,
+                                       k->writebacks, k->write_throughs);
+        cache_free(&c);
+    }
+
+    /*
+     * One 4-way set, lines A B C D A E B.  After A is reused, LRU evicts B
+     * for E and misses B again; the PLRU tree points at C instead.
+     */
+    static const uint32_t seq[] = { 0, 1, 2, 3, 0, 4, 1 };
+    for (int plru = 0; plru < 2; plru++) {
+        CacheConfig cfg = { .size = 64, .line_size = 16, .ways = 4,
+                            .replacement = plru ? CACHE_PLRU : CACHE_LRU,
+                            .write_back = 1, .write_allocate = 1 };
+        Cache c;
+
+        if (cache_init(&c, &cfg, NULL) != 0)
+            return -1;
+        for (size_t i = 0; i < sizeof(seq) / sizeof(seq[0]); i++)
+            cache_access(&c, seq[i] * 16u, 0);
+        mismatches += !cache_counts_ok(plru ? "plru sequence"
+                                            : "lru sequence",
+                                       &c, plru ? 5 : 6, plru ? 1 : 2, 0, 0);
+        cache_free(&c);
+    }
+
+    /*
+     * L1 (2 cycles) over L2 (10 cycles) over a 50-cycle memory.  2 KiB
+     * read twice misses every L1 line both times (256 fills from L2) but
+     * L2 only on the first pass (64 fills from memory).  Stored once, it
+     * misses 128 L1 lines, and the 64 dirty evictions reach L2 as
+     * buffered writes that add no cycles.
+     */
+    static Memory slow;
+    mem_reset(&slow);
+    slow.latency_cycles = 50;
+    for (int write = 0; write < 2; write++) {
+        CacheConfig l1 = { .size = 1024, .line_size = 16, .ways = 2,
+                           .replacement = CACHE_LRU, .write_back = 1,
+                           .write_allocate = 1, .hit_latency = 2 };
+        CacheConfig l2 = { .size = 4096, .line_size = 32, .ways = 4,
+                           .replacement = CACHE_LRU, .write_back = 1,
+                           .write_allocate = 1, .hit_latency = 10 };
+        int         passes   = write ? 1 : 2;
+        uint64_t    accesses = (uint64_t)passes * 512u;
+        uint64_t    cycles   = write ? 5504 : 7808;
+        Cache       c1, c2;
+
+        if (cache_init(&c1, &l1, NULL) != 0 || cache_init(&c2, &l2, NULL) != 0
+                || cache_connect(&c1, &c2, NULL) != 0
+                || cache_connect(&c2, NULL, &slow) != 0)
+            return -1;
+        for (int p = 0; p < passes; p++)
+            for (uint32_t a = 0; a < 2048; a += 4)
+                cache_access(&c1, a, write);
+        if (c1.stats.cycles != cycles
+                || cache_stall_cycles(&c1) != cycles - 2 * accesses
+                || c2.stats.writes != (write ? 64u : 0u)
+                || !cache_counts_ok(write ? "l1 stores" : "l1 loads", &c1,
+                                    write ? 128 : 256, write ? 64 : 192,
+                                    write ? 64 : 0, 0)
+                || !cache_counts_ok(write ? "l2 stores" : "l2 loads", &c2,
+                                    64, 0, 0, 0)) {
+            printf("CACHE MISMATCH: %s hierarchy: %llu cycles (expected "
+                   "%llu), %llu L2 writes\n", write ? "store" : "load",
+                   (unsigned long long)c1.stats.cycles,
+                   (unsigned long long)cycles,
+                   (unsigned long long)c2.stats.writes);
+            mismatches++;
+        }
+        cache_free(&c1);
+        cache_free(&c2);
+    }
+
+    /* Through the CPU: 64 bytes fit in any word width's address space. */
+    static Memory mem;
+    for (int write = 0; write < 2; write++) {
+        CacheConfig cfg = { .size = 128, .line_size = 16, .ways = 2,
+                            .replacement = CACHE_LRU,
+                            .write_back = 1, .write_allocate = 1 };
+        uint64_t   words = 2u * (64u / MEM_WORD_SIZE);
+        IRProgram  prog;
+        Cache      c;
+
+        if (cache_init(&c, &cfg, NULL) != 0)
+            return -1;
+        TraceSink  sink = cache_sink(&c);
+        CPUOptions opts = { .trace = &sink };
+        long       result;
+
+        build_sweep(&prog, write, 64u, 2);
+        mem_reset(&mem);
+        if (cpu_execute_opts(&prog, &mem, &result, &opts) != 0
+                || (write ? c.stats.writes : c.stats.reads) != words
+                || (write ? c.stats.reads : c.stats.writes) != 0
+                || !cache_counts_ok(write ? "cpu stores" : "cpu loads", &c,
+                                    4, 0, 0, 0)) {
+            printf("CACHE MISMATCH: cpu %s sweep\n",
+                   write ? "store" : "load");
+            mismatches++;
+        }
+        ir_program_free(&prog);
+        cache_free(&c);
+    }
+
+    printf("cache check: %zu sweeps, 2 replacement sequences, "
+           "2 hierarchies, 2 cpu runs, %ld mismatches\n",
+           n_cases, mismatches);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/*
+ * A LOAD sweep over CACHE_BENCH_SPAN bytes, about `iterations` instructions
+ * long, on the switch core with the cache_level_config() hierarchy
+ * attached; prints the row and the hierarchy's statistics.
+ */
+static int bench_cache(long iterations)
+{
+    static Memory mem;
+    long       words  = (long)(CACHE_BENCH_SPAN / MEM_WORD_SIZE);
+    long       passes = iterations / 5 / words;
+    int        np     = passes < 1 ? 1 : passes > INT32_MAX ? INT32_MAX
+                                                            : (int)passes;
+    size_t     instrs = 5u + 5u * (size_t)np * (size_t)words;
+    IRProgram  prog;
+    Cache      level[3];
+    long       result = -1;
+
+    mem_reset(&mem);
+    for (int i = 0; i < 3; i++) {
+        CacheConfig cfg = cache_level_config(i + 1);
+        if (cache_init(&level[i], &cfg, NULL) != 0)
+            return -1;
+    }
+    cache_connect(&level[0], &level[1], NULL);
+    cache_connect(&level[1], &level[2], NULL);
+    cache_connect(&level[2], NULL, &mem);
+    TraceSink  sink = cache_sink(&level[0]);
+    CPUOptions opts = { .trace = &sink, .max_steps = instrs };
+
+    build_sweep(&prog, 0, CACHE_BENCH_SPAN, np);
+    double t0     = now_seconds();
+    int    status = cpu_execute_opts(&prog, &mem, &result, &opts);
+    double dt     = now_seconds() - t0;
+    ir_program_free(&prog);
+
+    if (status != 0) {
+        fprintf(stderr, "bench: cache model run failed\n");
+        status = -1;
+    } else {
+        printf("  %-24s %12zu instrs  %8.3f s  %14.0f instr/s\n",
+               "switch,   cache model", instrs, dt, (double)instrs / dt);
+        cache_print_stats(&level[0], stdout);
+    }
+    for (int i = 0; i < 3; i++)
+        cache_free(&level[i]);
+    return status;
+}
+
+/* ── Stack distance check ─────────────────────────────────────────────────── */
+
+#define SD_CHECK_ACCESSES 50000
+#define SD_CHECK_SPAN     8192u  /* bytes the random accesses fall in */
+#define SD_LINE           32u
+
+/*
+ * One pass of random accesses through stackdist must predict the misses
+ * of every LRU write-allocate cache of the same line size and set count,
+ * each simulated separately by cache.h.  Plus a hand-computed sequence
+ * and a run through the CPU's trace.
+ */
+static int run_stackdist_check(void)
+{
+    static const uint32_t set_counts[] = { 1, 4, 16 };
+    uint32_t *addr  = malloc(SD_CHECK_ACCESSES * sizeof(uint32_t));
+    uint8_t  *write = malloc(SD_CHECK_ACCESSES);
+    long      mismatches = 0;
+    int       configs    = 0;
+
+    if (!addr || !write) { perror("malloc"); exit(EXIT_FAILURE); }
+    for (int i = 0; i < SD_CHECK_ACCESSES; i++) {
+        addr[i]  = (rng() % SD_CHECK_SPAN) & ~(MEM_WORD_SIZE - 1u);
+        write[i] = (uint8_t)(rng() % 4 == 0);
+    }
+
+    for (size_t s = 0; s < sizeof(set_counts) / sizeof(set_counts[0]); s++) {
+        StackDistConfig sc = { .line_size = SD_LINE, .sets = set_counts[s] };
+        StackDist       sd;
+
+        if (stackdist_init(&sd, &sc, NULL) != 0)
+            return -1;
+        for (int i = 0; i < SD_CHECK_ACCESSES; i++)
+            stackdist_access(&sd, addr[i]);
+
+        for (uint32_t ways = 1; ways <= 64; ways *= 2) {
+            CacheConfig cfg = { .size = set_counts[s] * ways * SD_LINE,
+                                .line_size = SD_LINE, .ways = ways,
+                                .replacement = CACHE_LRU,
+                                .write_back = 1, .write_allocate = 1 };
+            Cache c;
+
+            if (cache_init(&c, &cfg, NULL) != 0)
+                return -1;
+            for (int i = 0; i < SD_CHECK_ACCESSES; i++)
+                cache_access(&c, addr[i], write[i]);
+            uint64_t misses = c.stats.reads + c.stats.writes
+                            - c.stats.read_hits - c.stats.write_hits;
+            if (misses != stackdist_misses(&sd, ways)) {
+                printf("STACKDIST MISMATCH: %u sets, %u ways: cache %llu "
+                       "misses, stack distances %llu\n", set_counts[s],
+                       ways, (unsigned long long)misses,
+                       (unsigned long long)stackdist_misses(&sd, ways));
+                mismatches++;
+            }
+            cache_free(&c);
+            configs++;
+        }
+        stackdist_free(&sd);
+    }
+    free(addr);
+    free(write);
+
+    /* Lines A B C A B B: A and B come back at distance 2, then B at 0. */
+    static const uint32_t seq[]  = { 0, 1, 2, 0, 1, 1 };
+    static const uint32_t want[] = { UINT32_MAX, UINT32_MAX, UINT32_MAX,
+                                     2, 2, 0 };
+    StackDistConfig one = { .line_size = SD_LINE, .sets = 1 };
+    StackDist       sd;
+
+    if (stackdist_init(&sd, &one, NULL) != 0)
+        return -1;
+    for (size_t i = 0; i < sizeof(seq) / sizeof(seq[0]); i++) {
+        uint32_t got = stackdist_access(&sd, seq[i] * SD_LINE + 4u);
+        if (got != want[i]) {
+            printf("STACKDIST MISMATCH: sequence access %zu: distance %u, "
+                   "expected %u\n", i, got, want[i]);
+            mismatches++;
+        }
+    }
+    stackdist_free(&sd);
+
+    /* Through the CPU: 64 bytes of 16-byte lines swept twice.  The first
+     * word of each line comes back at distance 3, the rest at 0, so 4
+     * ways miss only the cold lines and 3 miss those words too. */
+    static Memory   mem;
+    StackDistConfig cfg   = { .line_size = 16, .sets = 1 };
+    uint64_t        words = 2u * (64u / MEM_WORD_SIZE);
+    IRProgram       prog;
+    long            result;
+
+    if (stackdist_init(&sd, &cfg, NULL) != 0)
+        return -1;
+    TraceSink  sink = stackdist_sink(&sd);
+    CPUOptions opts = { .trace = &sink };
+
+    build_sweep(&prog, 0, 64u, 2);
+    mem_reset(&mem);
+    if (cpu_execute_opts(&prog, &mem, &result, &opts) != 0
+            || sd.accesses != words || sd.cold != 4
+            || stackdist_misses(&sd, 4) != 4
+            || stackdist_misses(&sd, 3) != 8) {
+        printf("STACKDIST MISMATCH: cpu sweep\n");
+        mismatches++;
+    }
+    ir_program_free(&prog);
+    stackdist_free(&sd);
+
+    printf("stack distance check: %d cache configs from 3 passes, "
+           "1 sequence, 1 cpu run, %ld mismatches\n", configs, mismatches);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/*
+ * The cache row's LOAD sweep once more, with the fully associative
+ * stack-distance analysis attached instead; prints the row and the
+ * miss-ratio curve.
+ */
+static int bench_stackdist(long iterations)
+{
+    static Memory   mem;
+    long            words  = (long)(CACHE_BENCH_SPAN / MEM_WORD_SIZE);
+    long            passes = iterations / 5 / words;
+    int             np     = passes < 1 ? 1 : passes > INT32_MAX
+                                                ? INT32_MAX : (int)passes;
+    size_t          instrs = 5u + 5u * (size_t)np * (size_t)words;
+    StackDistConfig cfg    = { .line_size = SD_LINE, .sets = 1 };
+    StackDist       sd;
+    IRProgram       prog;
+    long            result = -1;
+
+    if (stackdist_init(&sd, &cfg, NULL) != 0)
+        return -1;
+    TraceSink  sink = stackdist_sink(&sd);
+    CPUOptions opts = { .trace = &sink, .max_steps = instrs };
+
+    build_sweep(&prog, 0, CACHE_BENCH_SPAN, np);
+    mem_reset(&mem);
+    double t0     = now_seconds();
+    int    status = cpu_execute_opts(&prog, &mem, &result, &opts);
+    double dt     = now_seconds() - t0;
+    ir_program_free(&prog);
+
+    if (status != 0) {
+        fprintf(stderr, "bench: stack distance run failed\n");
+    } else {
+        printf("  %-24s %12zu instrs  %8.3f s  %14.0f instr/s\n",
+               "switch,   stack distance", instrs, dt, (double)instrs / dt);
+        stackdist_print_curve(&sd, stdout);
+    }
+    stackdist_free(&sd);
+    return status;
+}
+
+/* ── Memory statistics check ──────────────────────────────────────────────── */
+
+/*
+ * Memory's counters against what a run must have done: a store sweep and a
+ * load sweep over CACHE_BENCH_SPAN bytes with the heatmap on, then one
+ * faulting access of each kind the word width allows.
+ */
+static int run_mem_stats_check(void)
+{
+#if MEM_STATS
+    static Memory mem;
+    uint64_t      words = CACHE_BENCH_SPAN / MEM_WORD_SIZE;
+    long          mismatches = 0, result;
+    IRProgram     prog;
+
+    mem_reset(&mem);
+    mem_heatmap_enable(&mem, 1);
+    for (int write = 1; write >= 0; write--) {
+        build_sweep(&prog, write, CACHE_BENCH_SPAN, 1);
+        if (cpu_execute_opts(&prog, &mem, &result, NULL) != 0)
+            mismatches++;
+        ir_program_free(&prog);
+    }
+    if (mem.read_count != words || mem.write_count != words
+            || mem.align_faults != 0 || mem.bounds_faults != 0) {
+        printf("MEMORY STATS MISMATCH: sweeps: ");
+        mem_print_stats(&mem, stdout);
+        mismatches++;
+    }
+    uint32_t pages = CACHE_BENCH_SPAN / MEM_PAGE_SIZE + 2;
+    for (uint32_t p = 0; p < pages; p++) {
+        uint32_t base = p * MEM_PAGE_SIZE;
+        uint32_t end  = base + MEM_PAGE_SIZE < CACHE_BENCH_SPAN
+                      ? base + MEM_PAGE_SIZE : CACHE_BENCH_SPAN;
+        uint64_t want = end > base ? (end - base) / MEM_WORD_SIZE : 0;
+        uint64_t reads, writes;
+        mem_page_heat(&mem, p, &reads, &writes);
+        if (reads != want || writes != want) {
+            printf("MEMORY STATS MISMATCH: page %u: %llu reads, %llu "
+                   "writes, expected %llu\n", p, (unsigned long long)reads,
+                   (unsigned long long)writes, (unsigned long long)want);
+            mismatches++;
+        }
+    }
+
+    int faults = 0;
+#if WORD_BITS > 8
+    {
+        /* Unaligned; and past the end where the address can get there. */
+        static const long bad[] = { 1,
+#if WORD_BITS > 32
+                                    (long)MEM_SIZE,
+#endif
+        };
+        faults = (int)(sizeof(bad) / sizeof(bad[0]));
+        mem_stats_reset(&mem);
+        for (int i = 0; i < faults; i++) {
+            ir_program_init(&prog);
+            ir_program_append(&prog, (IRInstr){.op=IR_LOAD_CONST,.dst=0,
+                                               .imm=bad[i]});
+            ir_program_append(&prog, (IRInstr){.op=IR_LOAD,.dst=1,.addr=0});
+            if (cpu_execute_opts(&prog, &mem, &result, NULL) == 0)
+                mismatches++;
+            ir_program_free(&prog);
+        }
+        if (mem.align_faults != 1 || mem.bounds_faults != (uint64_t)faults - 1
+                || mem.read_count != 0) {
+            printf("MEMORY STATS MISMATCH: faults: ");
+            mem_print_stats(&mem, stdout);
+            mismatches++;
+        }
+    }
+#endif
+
+    printf("memory stats check: 2 sweeps over %u pages, %d faults, "
+           "%ld mismatches\n", pages, faults, mismatches);
+    return mismatches == 0 ? 0 : -1;
+#else
+    printf("memory stats check: skipped (MEM_STATS=0)\n");
+    return 0;
+#endif
+}
+
+/* ── Sparse memory check ───────────────────────────────────────────────────── */
+
+#define SPARSE_CHECK_WORDS 256
+
+/*
+ * Words written at random aligned addresses across the whole address
+ * space must read back (the last write to each winning), allocate exactly
+ * their distinct pages, and leave every other word reading zero; copies
+ * must compare equal until one of them changes.
+ */
+static int run_sparse_mem_check(void)
+{
+    static Memory mem, copy;
+    static word_t addr[SPARSE_CHECK_WORDS], value[SPARSE_CHECK_WORDS];
+    long          mismatches = 0;
+    uint64_t      pages = 0;
+
+    mem_reset(&mem);
+    for (int i = 0; i < SPARSE_CHECK_WORDS; i++) {
+        addr[i]  = (word_t)rng() & (word_t)~(word_t)(MEM_WORD_SIZE - 1u);
+        value[i] = (word_t)rng();
+        if (mem_write_word(&mem, addr[i], value[i]) != 0)
+            mismatches++;
+    }
+
+    for (int i = 0; i < SPARSE_CHECK_WORDS; i++) {
+        word_t want = value[i], got = 0;
+        int    first_page = 1;
+        for (int j = i + 1; j < SPARSE_CHECK_WORDS; j++)
+            if (addr[j] == addr[i])
+                want = value[j];
+        for (int j = 0; j < i; j++)
+            if ((uint64_t)addr[j] >> MEM_PAGE_BITS
+                    == (uint64_t)addr[i] >> MEM_PAGE_BITS)
+                first_page = 0;
+        pages += (uint64_t)first_page;
+        if (mem_read_word(&mem, addr[i], &got) != 0 || got != want) {
+            printf("SPARSE MISMATCH: 0x%llx reads 0x%llx, expected "
+                   "0x%llx\n", (unsigned long long)addr[i],
+                   (unsigned long long)got, (unsigned long long)want);
+            mismatches++;
+        }
+    }
+    if (mem.resident != pages) {
+        printf("SPARSE MISMATCH: %llu pages resident, expected %llu\n",
+               (unsigned long long)mem.resident, (unsigned long long)pages);
+        mismatches++;
+    }
+
+    /* A word no write touched, in a page none did if there is one. */
+    word_t hole = 0;
+    for (int i = 0; i < SPARSE_CHECK_WORDS; i++)
+        hole = (word_t)(hole > addr[i] ? hole : addr[i]);
+    hole = (word_t)(hole + MEM_WORD_SIZE);
+    for (int i = 0; i < SPARSE_CHECK_WORDS; i++)
+        if (addr[i] == hole)
+            hole = (word_t)(hole + MEM_WORD_SIZE);
+    word_t got = 1;
+    if (mem_read_word(&mem, hole, &got) != 0 || got != 0
+            || mem.resident != pages) {
+        printf("SPARSE MISMATCH: unwritten 0x%llx reads 0x%llx\n",
+               (unsigned long long)hole, (unsigned long long)got);
+        mismatches++;
+    }
+
+    /* Copies: equal, unequal once changed, equal again once changed back
+     * (now with a zero page only the copy has). */
+    mem_reset(&copy);
+    mem_copy(&copy, &mem);
+    int same = mem_equal(&mem, &copy);
+    mem_write_word(&copy, hole, 1);
+    int differ = !mem_equal(&mem, &copy) && !mem_equal(&copy, &mem);
+    mem_write_word(&copy, hole, 0);
+    if (!same || !differ || !mem_equal(&copy, &mem)) {
+        printf("SPARSE MISMATCH: copy compared %d/%d/%d\n", same, differ,
+               mem_equal(&copy, &mem));
+        mismatches++;
+    }
+
+    /* Reset zeroes the pages in place: same pages, all reading zero. */
+    mem_reset(&mem);
+    got = 1;
+    if (mem.resident != pages || mem_read_word(&mem, addr[0], &got) != 0
+            || got != 0 || mem.write_count != 0) {
+        printf("SPARSE MISMATCH: after reset %llu pages resident, "
+               "0x%llx reads 0x%llx\n", (unsigned long long)mem.resident,
+               (unsigned long long)addr[0], (unsigned long long)got);
+        mismatches++;
+    }
+    mem_free(&mem);
+
+#if MEM_STATS
+    /* A read-only scan with the heatmap on counts every page it reads
+     * without allocating any of them. */
+    mem_heatmap_enable(&mem, 1);
+    for (int i = 0; i < SPARSE_CHECK_WORDS; i++)
+        mem_read_word(&mem, addr[i], &got);
+    for (int i = 0; i < SPARSE_CHECK_WORDS; i++) {
+        uint32_t vpn  = (uint32_t)((uint64_t)addr[i] >> MEM_PAGE_BITS);
+        uint64_t want = 0, reads, writes;
+        for (int j = 0; j < SPARSE_CHECK_WORDS; j++)
+            want += (uint64_t)addr[j] >> MEM_PAGE_BITS == vpn;
+        mem_page_heat(&mem, vpn, &reads, &writes);
+        if (reads != want || writes != 0) {
+            printf("SPARSE MISMATCH: page %u heat %llu/%llu, expected "
+                   "%llu/0\n", vpn, (unsigned long long)reads,
+                   (unsigned long long)writes, (unsigned long long)want);
+            mismatches++;
+            break;
+        }
+    }
+    if (mem.resident != 0) {
+        printf("SPARSE MISMATCH: read-only scan allocated %llu pages\n",
+               (unsigned long long)mem.resident);
+        mismatches++;
+    }
+    mem_free(&mem);
+#endif
+    mem_free(&copy);
+
+    printf("sparse memory check: %d words over %llu pages, %ld mismatches\n",
+           SPARSE_CHECK_WORDS, (unsigned long long)pages, mismatches);
+    return mismatches == 0 ? 0 : -1;
+}
+
+/* ── Entry point ──────────────────────────────────────────────────────────── */
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--check") == 0) {
+        long programs = argc > 2 ? strtol(argv[2], NULL, 10)
+                                 : DEFAULT_CHECKS;
+        if (programs <= 0 || programs > INT32_MAX) {
+            fprintf(stderr, "usage: %s --check [programs (1..%ld)]\n",
+                    argv[0], (long)INT32_MAX);
+            return EXIT_FAILURE;
+        }
+        int rc = run_alu_check(programs);
+        rc |= run_check(programs);
+        rc |= run_batch_check(programs);
+        rc |= run_pool_check(programs);
+        rc |= run_sched_check(programs);
+        rc |= run_trace_check(programs);
+        rc |= run_cache_check();
+        rc |= run_stackdist_check();
+        rc |= run_mem_stats_check();
+        rc |= run_sparse_mem_check();
+        return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    long iterations = DEFAULT_ITERATIONS;
+    if (argc > 1) {
+        iterations = strtol(argv[1], NULL, 10);
+        if (iterations <= 0 || iterations > INT32_MAX) {
+            fprintf(stderr, "usage: %s [iterations (1..%ld)]\n",
+                    argv[0], (long)INT32_MAX);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Traced output is discarded; we measure the cost of producing it. */
+    FILE *sink_file = fopen("/dev/null", "w");
+    if (!sink_file) { perror("/dev/null"); return EXIT_FAILURE; }
+
+    IRProgram prog;
+    build_countdown(&prog, iterations);
+
+    TraceSink text   = trace_sink_text(sink_file);
+    TraceSink binary = trace_sink_binary(sink_file);
+
+    if (ir_program_verify(&prog, CPU_MAX_REGS) != 0)
+        return EXIT_FAILURE;
+
+    CPU ref, state;
+    memset(&ref,   0, sizeof(ref));
+    memset(&state, 0, sizeof(state));
+
+    printf("countdown loop, %ld iterations:\n", iterations);
+    int rc = 0;
+    rc |= bench_run("switch,   trace off", &prog, iterations, NULL,
+                    CPU_CORE_SWITCH, 0, &ref);
+    rc |= bench_run("verified, trace off", &prog, iterations, NULL,
+                    CPU_CORE_SWITCH, 1, &state);
+    rc |= check_same_state("verified core", &ref, &state);
+    rc |= bench_run("threaded, trace off", &prog, iterations, NULL,
+                    CPU_CORE_THREADED, 0, &state);
+    rc |= check_same_state("threaded core", &ref, &state);
+    rc |= bench_run("jit,      trace off", &prog, iterations, NULL,
+                    CPU_CORE_JIT, 1, &state);
+    rc |= check_same_state("jit", &ref, &state);
+
+    IRProgram fused;
+    build_countdown(&fused, iterations);
+    ir_program_verify(&fused, CPU_MAX_REGS);
+    ir_program_fuse(&fused);
+    rc |= bench_run("fused,    trace off", &fused, iterations, NULL,
+                    CPU_CORE_SWITCH, 1, &state);
+    rc |= check_same_state("fused switch core", &ref, &state);
+    ir_program_free(&fused);
+    double t0 = now_seconds();
+    rc |= bench_run("switch,   trace binary", &prog, iterations, &binary,
+                    CPU_CORE_SWITCH, 0, &state);
+    double t1 = now_seconds();
+    rc |= bench_run("switch,   trace text", &prog, iterations, &text,
+                    CPU_CORE_SWITCH, 0, &state);
+    double t2 = now_seconds();
+    printf("  binary trace sink: %.1fx the text sink's throughput\n",
+           (t2 - t1) / (t1 - t0));
+
+    PipelineModel pipeline;
+    pipeline_init(&pipeline, NULL, NULL);
+    TraceSink timed = pipeline_sink(&pipeline);
+    rc |= bench_run("switch,   pipeline model", &prog, iterations, &timed,
+                    CPU_CORE_SWITCH, 0, &state);
+    pipeline_print_stats(&pipeline.stats, stdout);
+    rc |= bench_cache(iterations);
+    rc |= bench_stackdist(iterations);
+    rc |= bench_batch(iterations);
+    rc |= bench_pool(iterations);
+    rc |= bench_sched();
+    rc |= bench_alu();
+
+    ir_program_free(&prog);
+    fclose(sink_file);
+    return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,352 @@
+#include "cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* ── Configuration ────────────────────────────────────────────────────────── */
+
+CacheConfig cache_default_config(void)
+{
+    return (CacheConfig){ .size           = 4096,
+                          .line_size      = 32,
+                          .ways           = 4,
+                          .replacement    = CACHE_LRU,
+                          .write_back     = 1,
+                          .write_allocate = 1,
+                          .hit_latency    = 4 };
+}
+
+CacheConfig cache_level_config(int level)
+{
+    CacheConfig cfg = cache_default_config();
+
+    if (level == 2) {
+        cfg.size        = 16384;
+        cfg.line_size   = 64;
+        cfg.ways        = 8;
+        cfg.hit_latency = 12;
+    } else if (level >= 3) {
+        cfg.size        = 65536;
+        cfg.line_size   = 64;
+        cfg.ways        = 16;
+        cfg.hit_latency = 40;
+    }
+    return cfg;
+}
+
+static int is_pow2(uint32_t x)
+{
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+static uint32_t log2u(uint32_t x)
+{
+    uint32_t n = 0;
+    while (x >>= 1)
+        n++;
+    return n;
+}
+
+int cache_init(Cache *c, const CacheConfig *cfg, const TraceSink *next)
+{
+    memset(c, 0, sizeof(*c));
+    c->cfg  = cfg ? *cfg : cache_default_config();
+    c->next = next;
+
+    const CacheConfig *k = &c->cfg;
+    if (!is_pow2(k->size) || !is_pow2(k->line_size) || !is_pow2(k->ways)) {
+        fprintf(stderr, "cache error: size (%u), line size (%u) and ways "
+                        "(%u) must be powers of two\n",
+                k->size, k->line_size, k->ways);
+        return -1;
+    }
+    if (k->line_size < MEM_WORD_SIZE || k->ways > 64
+            || k->size < k->line_size * k->ways) {
+        fprintf(stderr, "cache error: need word <= line size (%u), ways "
+                        "(%u) <= 64 and line size * ways <= size (%u)\n",
+                k->line_size, k->ways, k->size);
+        return -1;
+    }
+
+    c->sets        = k->size / (k->line_size * k->ways);
+    c->offset_bits = log2u(k->line_size);
+    c->index_bits  = log2u(c->sets);
+    c->lines       = calloc((size_t)c->sets * k->ways, sizeof(CacheLine));
+    c->plru        = calloc(c->sets, sizeof(uint64_t));
+    if (!c->lines || !c->plru) { perror("calloc"); exit(EXIT_FAILURE); }
+    c->rng = 0x9E3779B97F4A7C15ull;
+    return 0;
+}
+
+void cache_free(Cache *c)
+{
+    free(c->lines);
+    free(c->plru);
+    c->lines = NULL;
+    c->plru  = NULL;
+}
+
+int cache_connect(Cache *c, Cache *lower, const Memory *mem)
+{
+    if (lower && lower->cfg.line_size < c->cfg.line_size) {
+        fprintf(stderr, "cache error: lower level lines (%u B) shorter than "
+                        "upper level lines (%u B)\n",
+                lower->cfg.line_size, c->cfg.line_size);
+        return -1;
+    }
+    c->lower = lower;
+    c->mem   = mem;
+    return 0;
+}
+
+/* ── Replacement ──────────────────────────────────────────────────────────── */
+
+/*
+ * Tree pseudo-LRU: a binary tree over the ways, heap-numbered from node 1,
+ * one bit per internal node pointing at the half to evict from next.  An
+ * access flips the bits on its path to point away from it; the victim is
+ * found by following them down.
+ */
+static void plru_touch(uint64_t *bits, uint32_t ways, uint32_t way)
+{
+    uint32_t node = 1;
+
+    for (uint32_t span = ways >> 1; span != 0; span >>= 1) {
+        uint32_t right = (way & span) != 0;
+
+        if (right)
+            *bits &= ~((uint64_t)1 << node);
+        else
+            *bits |= (uint64_t)1 << node;
+        node = 2 * node + right;
+    }
+}
+
+static uint32_t plru_victim(uint64_t bits, uint32_t ways)
+{
+    uint32_t node = 1, way = 0;
+
+    for (uint32_t span = ways >> 1; span != 0; span >>= 1) {
+        uint32_t right = (uint32_t)(bits >> node) & 1u;
+
+        way |= right ? span : 0u;
+        node = 2 * node + right;
+    }
+    return way;
+}
+
+static uint64_t xorshift64(uint64_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+/* Way of `set` to fill: an invalid one if any, else the policy's pick. */
+static uint32_t choose_victim(Cache *c, uint32_t set, const CacheLine *way)
+{
+    uint32_t ways = c->cfg.ways;
+
+    for (uint32_t w = 0; w < ways; w++)
+        if (!way[w].valid)
+            return w;
+
+    switch (c->cfg.replacement) {
+        case CACHE_PLRU:
+            return plru_victim(c->plru[set], ways);
+        case CACHE_RANDOM:
+            return (uint32_t)(xorshift64(&c->rng) & (ways - 1));
+        default: {
+            uint32_t oldest = 0;
+            for (uint32_t w = 1; w < ways; w++)
+                if (way[w].stamp < way[oldest].stamp)
+                    oldest = w;
+            return oldest;
+        }
+    }
+}
+
+static void touch(Cache *c, uint32_t set, CacheLine *line, uint32_t w)
+{
+    line->stamp = ++c->clock;
+    if (c->cfg.replacement == CACHE_PLRU)
+        plru_touch(&c->plru[set], c->cfg.ways, w);
+}
+
+/* ── Access ───────────────────────────────────────────────────────────────── */
+
+static uint32_t lookup(Cache *c, uint32_t addr, int is_write, int demand);
+
+/* An access to the level below c; returns its latency. */
+static uint32_t forward(Cache *c, uint32_t addr, int is_write, int demand)
+{
+    if (c->lower)
+        return lookup(c->lower, addr, is_write, demand);
+    return c->mem ? c->mem->latency_cycles : 0;
+}
+
+/* Write buffered for the level below: costs the access nothing. */
+static void write_down(Cache *c, uint32_t addr)
+{
+    forward(c, addr, 1, 0);
+}
+
+/*
+ * The access proper.  `demand` is 0 for buffered writes from the level
+ * above: they change state and traffic counts but not the latency totals.
+ */
+static uint32_t lookup(Cache *c, uint32_t addr, int is_write, int demand)
+{
+    uint32_t   block = addr >> c->offset_bits;
+    uint32_t   set   = block & (c->sets - 1u);
+    uint32_t   tag   = block >> c->index_bits;
+    CacheLine *way   = &c->lines[(size_t)set * c->cfg.ways];
+    uint32_t   cost  = c->cfg.hit_latency;
+
+    if (is_write)
+        c->stats.writes++;
+    else
+        c->stats.reads++;
+
+    for (uint32_t w = 0; w < c->cfg.ways; w++) {
+        if (way[w].valid && way[w].tag == tag) {
+            touch(c, set, &way[w], w);
+            if (!is_write) {
+                c->stats.read_hits++;
+            } else {
+                c->stats.write_hits++;
+                if (c->cfg.write_back) {
+                    way[w].dirty = 1;
+                } else {
+                    c->stats.write_throughs++;
+                    write_down(c, addr);
+                }
+            }
+            goto done;
+        }
+    }
+
+    /* Miss.  Without write-allocate a store bypasses the cache. */
+    if (is_write && !c->cfg.write_allocate) {
+        c->stats.write_throughs++;
+        write_down(c, addr);
+        goto done;
+    }
+
+    uint32_t   w    = choose_victim(c, set, way);
+    CacheLine *line = &way[w];
+    if (line->valid) {
+        c->stats.evictions++;
+        if (line->dirty) {
+            c->stats.writebacks++;
+            write_down(c, ((line->tag << c->index_bits) | set)
+                              << c->offset_bits);
+        }
+    }
+    line->tag   = tag;
+    line->valid = 1;
+    line->dirty = (uint8_t)(is_write && c->cfg.write_back);
+    c->stats.fills++;
+    cost += forward(c, block << c->offset_bits, 0, demand);
+    if (is_write && !c->cfg.write_back) {
+        c->stats.write_throughs++;
+        write_down(c, addr);
+    }
+    touch(c, set, line, w);
+
+done:
+    if (demand) {
+        c->stats.demand++;
+        c->stats.cycles += cost;
+    }
+    return cost;
+}
+
+uint32_t cache_access(Cache *c, uint32_t addr, int is_write)
+{
+    return lookup(c, addr, is_write, 1);
+}
+
+static void cache_emit(void *ctx, const TraceEvent *ev)
+{
+    Cache *c = ctx;
+
+    if (ev->op == IR_LOAD || ev->op == IR_STORE)
+        cache_access(c, ev->mem_addr, ev->op == IR_STORE);
+    if (c->next)
+        c->next->emit(c->next->ctx, ev);
+}
+
+TraceSink cache_sink(Cache *c)
+{
+    return (TraceSink){ .emit = cache_emit, .ctx = c };
+}
+
+/* ── Reporting ────────────────────────────────────────────────────────────── */
+
+const char *cache_replacement_name(CacheReplacement r)
+{
+    switch (r) {
+        case CACHE_LRU:    return "lru";
+        case CACHE_PLRU:   return "plru";
+        case CACHE_RANDOM: return "random";
+        default:           return "?";
+    }
+}
+
+double cache_amat(const Cache *c)
+{
+    if (c->stats.demand == 0)
+        return 0.0;
+    return (double)c->stats.cycles / (double)c->stats.demand;
+}
+
+uint64_t cache_stall_cycles(const Cache *c)
+{
+    return c->stats.cycles - c->stats.demand * c->cfg.hit_latency;
+}
+
+void cache_print_stats(const Cache *c, FILE *out)
+{
+    const Cache *last  = c;
+    int          level = 1;
+
+    for (const Cache *l = c; l; l = l->lower, level++) {
+        const CacheStats *s        = &l->stats;
+        uint64_t          accesses = s->reads + s->writes;
+        uint64_t          hits     = s->read_hits + s->write_hits;
+
+        fprintf(out, "CACHE L%d: %u B, %u B lines, %u-way (%u sets), %s, "
+                     "%s, %s, %u cycles\n",
+                level, l->cfg.size, l->cfg.line_size, l->cfg.ways, l->sets,
+                cache_replacement_name(l->cfg.replacement),
+                l->cfg.write_back ? "write-back" : "write-through",
+                l->cfg.write_allocate ? "write-allocate"
+                                      : "no-write-allocate",
+                l->cfg.hit_latency);
+        fprintf(out, "  reads %llu (hits %llu), writes %llu (hits %llu), "
+                     "misses %llu, hit rate %.2f%%\n",
+                (unsigned long long)s->reads,
+                (unsigned long long)s->read_hits,
+                (unsigned long long)s->writes,
+                (unsigned long long)s->write_hits,
+                (unsigned long long)(accesses - hits),
+                accesses ? 100.0 * (double)hits / (double)accesses : 0.0);
+        fprintf(out, "  fills %llu, evictions %llu, writebacks %llu, "
+                     "write-throughs %llu, AMAT %.2f cycles\n",
+                (unsigned long long)s->fills,
+                (unsigned long long)s->evictions,
+                (unsigned long long)s->writebacks,
+                (unsigned long long)s->write_throughs, cache_amat(l));
+        last = l;
+    }
+    fprintf(out, "MEMORY: %u cycles, %llu line reads, %llu writes\n",
+            last->mem ? last->mem->latency_cycles : 0u,
+            (unsigned long long)last->stats.fills,
+            (unsigned long long)(last->stats.writebacks
+                                 + last->stats.write_throughs));
+    fprintf(out, "  AMAT %.2f cycles over %llu accesses, %llu stall cycles\n",
+            cache_amat(c), (unsigned long long)c->stats.demand,
+            (unsigned long long)cache_stall_cycles(c));
+}
@@ -0,0 +1,158 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "memory.h"
+#include "trace.h"
+
+/*
+ * Cache model — a configurable set-associative cache between the CPU and
+ * Memory, driven by the trace of a functional run.
+ *
+ * Like the pipeline model, the cache is a TraceSink: attach cache_sink()
+ * as CPUOptions.trace and every LOAD/STORE the CPU performs through
+ * mem_read_word/mem_write_word is looked up in the cache as it retires.
+ * Memory stays the single copy of the data (the machine has one core, so
+ * nothing can observe a stale line), which lets the model keep tags and
+ * state bits only.  Runs without it attached take the trace-free path and
+ * pay nothing.
+ *
+ * Geometry: `size` bytes in `line_size`-byte lines, `ways` lines per set;
+ * all three are powers of two and line_size is at least a word.  An
+ * address splits into  tag | set index | line offset.
+ *
+ * Policies:
+ *   - Replacement, among the valid lines of a full set (an invalid way is
+ *     always filled first): true LRU, tree pseudo-LRU (ways-1 bits per
+ *     set) or random (a fixed-seed xorshift, so runs repeat).
+ *   - Write hits: write-back marks the line dirty and writes it to memory
+ *     when it is evicted; write-through writes memory every time.
+ *   - Write misses: write-allocate fills the line first, no-write-allocate
+ *     sends the word straight to memory and leaves the cache unchanged.
+ *
+ * Hierarchy: cache_connect() chains levels (L1 -> L2 -> L3 -> Memory).
+ * "Memory" in the policies above then means the next level down: a miss
+ * fills from it, and writebacks and write-throughs become writes to it.
+ * Levels are neither inclusive nor exclusive; each keeps its own contents.
+ * Only the top level is attached as the sink.
+ *
+ * Latency: an access costs the hit latency of every level it probes, plus
+ * Memory.latency_cycles if it misses them all.  Writebacks, write-throughs
+ * and no-write-allocate misses go to a write buffer: they update the lower
+ * levels but stall nothing.  Each level sums the cost of the accesses that
+ * reach it, so stats.cycles / accesses at L1 is the AMAT of the run, and
+ * the cycles beyond an L1 hit are memory stall cycles.
+ */
+
+typedef enum {
+    CACHE_LRU = 0,
+    CACHE_PLRU,
+    CACHE_RANDOM
+} CacheReplacement;
+
+typedef struct {
+    uint32_t         size;            /* capacity in bytes                  */
+    uint32_t         line_size;       /* bytes per line                     */
+    uint32_t         ways;            /* lines per set (1 = direct-mapped)  */
+    CacheReplacement replacement;
+    int              write_back;      /* 1 write-back, 0 write-through      */
+    int              write_allocate;  /* 1 fill the line on a write miss    */
+    uint32_t         hit_latency;     /* cycles to look up this level       */
+} CacheConfig;
+
+typedef struct {
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t read_hits;
+    uint64_t write_hits;
+    uint64_t fills;           /* lines read from the level below        */
+    uint64_t evictions;       /* valid lines replaced by a fill         */
+    uint64_t writebacks;      /* dirty lines written back on eviction   */
+    uint64_t write_throughs;  /* stores sent straight to memory         */
+    uint64_t demand;          /* accesses that had to wait for a result */
+    uint64_t cycles;          /* their latency, this level and below    */
+} CacheStats;
+
+typedef struct {
+    uint32_t tag;
+    uint8_t  valid;
+    uint8_t  dirty;
+    uint64_t stamp;           /* LRU: clock of the last access          */
+} CacheLine;
+
+typedef struct Cache Cache;
+
+struct Cache {
+    CacheConfig      cfg;
+    CacheStats       stats;
+    const TraceSink *next;        /* events are forwarded here if non-NULL */
+    Cache           *lower;       /* next level; NULL = main memory        */
+    const Memory    *mem;         /* latency source below the last level   */
+
+    uint32_t   sets;
+    uint32_t   offset_bits;       /* log2(line_size)                       */
+    uint32_t   index_bits;        /* log2(sets)                            */
+    CacheLine *lines;             /* sets * ways, set-major                */
+    uint64_t  *plru;              /* tree bits, one word per set           */
+    uint64_t   clock;             /* accesses so far (LRU stamps)          */
+    uint64_t   rng;               /* xorshift state (random replacement)   */
+};
+
+/* 4 KiB, 32-byte lines, 4-way, LRU, write-back, write-allocate, 4 cycles:
+ * the L1 preset. */
+CacheConfig cache_default_config(void);
+
+/*
+ * Preset for level 1, 2 or 3 of a hierarchy sized for the demo and bench
+ * working sets (up to the bench's 16 KiB sweep): L1 as above, L2 16 KiB /
+ * 64 B / 8-way / 12 cycles, L3 64 KiB / 64 B / 16-way / 40 cycles, all
+ * LRU, write-back, write-allocate.
+ */
+CacheConfig cache_level_config(int level);
+
+/*
+ * Set `c` up, empty, for `cfg` (NULL = defaults); next may be NULL.
+ * Returns 0, or -1 with a "cache error: ..." message if the geometry is
+ * invalid.  Release with cache_free.
+ */
+int cache_init(Cache *c, const CacheConfig *cfg, const TraceSink *next);
+
+void cache_free(Cache *c);
+
+/*
+ * Send c's misses and write traffic to `lower`, or to main memory costing
+ * mem->latency_cycles when lower is NULL (mem NULL: free).  Returns 0, or
+ * -1 with a "cache error: ..." message if lower's lines are shorter than
+ * c's (a fill must be one lower-level access).
+ */
+int cache_connect(Cache *c, Cache *lower, const Memory *mem);
+
+/*
+ * One word access at byte address `addr`: look it up, update the
+ * replacement state and the statistics, and pass misses down.  Returns
+ * the access's latency in cycles.
+ */
+uint32_t cache_access(Cache *c, uint32_t addr, int is_write);
+
+/* Average memory access time at `c` in cycles (0 before any access). */
+double cache_amat(const Cache *c);
+
+/* Cycles c's accesses spent beyond a hit in c: the memory stall cycles. */
+uint64_t cache_stall_cycles(const Cache *c);
+
+/* Sink that feeds the LOADs and STOREs of a run to `c` (then c->next). */
+TraceSink cache_sink(Cache *c);
+
+/* "lru", "plru" or "random". */
+const char *cache_replacement_name(CacheReplacement r);
+
+/*
+ * "CACHE L1: ..." summary of `c` and each level below it: geometry,
+ * policies, hits, misses and traffic; then the memory traffic, the AMAT
+ * and the stall cycles of the whole hierarchy.
+ */
+void cache_print_stats(const Cache *c, FILE *out);
+
+#endif /* CACHE_H */
@@ -27,7 +27,14 @@ static IROpcode ast_op_to_ir(BinaryOp op)
         case OP_ADD: return IR_ADD;
         case OP_SUB: return IR_SUB;
         case OP_MUL: return IR_MUL;
-        case OP_DIV: return IR_DIV;
+        case OP_DIV: return IR_SDIV;
+        case OP_MOD: return IR_SREM;
+        case OP_AND: return IR_AND;
+        case OP_OR:  return IR_OR;
+        case OP_XOR: return IR_XOR;
+        case OP_SHL: return IR_SHL;
+        case OP_ASR: return IR_ASR;
+        case OP_LSR: return IR_LSR;
     }
     /* Unreachable if the AST is well-formed. */
     fprintf(stderr, "codegen error: unknown BinaryOp %d\n", (int)op);
@@ -87,6 +94,25 @@ int codegen_expr(Codegen *cg, const Node *node)
 
             return left_reg;
         }
+
+        case NODE_UNARY_OP: {
+            /*
+             * Unary node — the only operator is bitwise NOT, computed in
+             * place in the operand's register:
+             *
+             *   NOT  Rn, Rn
+             */
+            int reg = codegen_expr(cg, node->unary.operand);
+
+            ir_program_append(cg->prog, (IRInstr){
+                .op  = IR_NOT,
+                .dst = reg,
+                .src = reg,
+                .imm = 0
+            });
+
+            return reg;
+        }
     }
 
     fprintf(stderr, "codegen error: unknown node type %d\n", (int)node->type);
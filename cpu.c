@@ -1,15 +1,15 @@
 #include "cpu.h"
+#include "cpu_internal.h"
+#include "jit.h"
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
-/* Flags string buffer: "Z=0 N=0 C=0 V=0" + NUL */
-#define FLAGS_BUF 24
-
 /* ── Internal validation ──────────────────────────────────────────────────── */
 
-static int check_reg(int r, const char *role, size_t pc)
+int cpu_check_reg(int r, const char *role, size_t pc)
 {
     if (r < 0 || r >= CPU_MAX_REGS) {
         fprintf(stderr, "cpu error: %s register R%d out of range "
@@ -27,7 +27,7 @@ static int check_reg(int r, const char *role, size_t pc)
  *   - prog_count         jumps past the last instruction → loop exits (halt)
  * target outside this range is a bug.
  */
-static int check_target(int target, size_t prog_count, size_t pc)
+int cpu_check_target(int target, size_t prog_count, size_t pc)
 {
     if (target < 0 || (size_t)target > prog_count) {
         fprintf(stderr, "cpu error: jump target %d out of bounds "
@@ -38,22 +38,171 @@ static int check_target(int target, size_t prog_count, size_t pc)
     return 0;
 }
 
-/* ── PC-driven execution loop ─────────────────────────────────────────────── */
+/* ── Runtime error reports ────────────────────────────────────────────────── */
 
-int cpu_execute(const IRProgram *prog, Memory *mem, long *out_result)
+/*
+ * Each prints the canonical message and returns -1, so every core reports
+ * the same failure with the same text.
+ */
+int cpu_report_step_limit(size_t max_steps, size_t pc)
 {
-    if (!prog || prog->count == 0) {
-        fprintf(stderr, "cpu error: empty program\n");
-        return -1;
+    fprintf(stderr, "cpu error: execution limit (%zu steps) exceeded "
+                    "— possible infinite loop at pc=%zu\n",
+            max_steps, pc);
+    return -1;
+}
+
+int cpu_report_div_zero(int src, size_t pc)
+{
+    fprintf(stderr, "cpu error: division by zero (R%d = 0) at pc=%zu\n",
+            src, pc);
+    return -1;
+}
+
+int cpu_report_div_overflow(int dst, int src, size_t pc)
+{
+    fprintf(stderr, "cpu error: signed division overflow (R%d = MIN, "
+                    "R%d = -1) at pc=%zu\n", dst, src, pc);
+    return -1;
+}
+
+int cpu_report_no_mem(IROpcode op, size_t pc)
+{
+    fprintf(stderr, "cpu error: %s at pc=%zu but no memory "
+                    "was attached to this CPU\n", ir_opcode_name(op), pc);
+    return -1;
+}
+
+int cpu_report_bad_opcode(int op, size_t pc)
+{
+    fprintf(stderr, "cpu error: unknown opcode %d at pc=%zu\n", op, pc);
+    return -1;
+}
+
+/* ── Logical and shift operations ─────────────────────────────────────────── */
+
+word_t cpu_logic(IROpcode op, word_t a, word_t b, ALUFlags *f)
+{
+    switch (op) {
+        case IR_AND: return alu_and(a, b, f);
+        case IR_OR:  return alu_or(a, b, f);
+        case IR_XOR: return alu_xor(a, b, f);
+        case IR_NOT: return alu_not(b, f);
+        case IR_SHL: return alu_shl(a, b, f);
+        case IR_LSR: return alu_lsr(a, b, f);
+        case IR_ASR: return alu_asr(a, b, f);
+        default:     return alu_ror(a, b, f);   /* IR_ROR */
+    }
+}
+
+/* ── Initial state ────────────────────────────────────────────────────────── */
+
+void cpu_init_state(CPU *cpu, Memory *mem, const CPU *in_state)
+{
+    memset(cpu, 0, sizeof(*cpu));
+    cpu->mem = mem;   /* may be NULL for arithmetic-only programs */
+    if (in_state) {
+        memcpy(cpu->regs, in_state->regs, sizeof(cpu->regs));
+        cpu->flags = in_state->flags;
+    }
+}
+
+/* ── Tracing ──────────────────────────────────────────────────────────────── */
+
+/* Opcodes run on the multiply/divide unit (see alu_muldiv_iterations). */
+static int is_muldiv(IROpcode op)
+{
+    switch (op) {
+        case IR_MUL:   case IR_DIV:   case IR_SDIV:  case IR_SREM:
+        case IR_UREM:  case IR_UMULL: case IR_SMULL: case IR_MLA:
+            return 1;
+        default:
+            return 0;
     }
+}
+
+/*
+ * Build one TraceEvent for the instruction at cpu->pc and hand it to the
+ * sink.  Call sites guard this with `if (trace)`, so a trace-free run never
+ * builds an event, formats a string, or touches stdio.  The event's flags
+ * are cpu->flags with the core's pending lazy record applied.
+ */
+void cpu_trace_instr(const TraceSink *trace, const CPU *cpu,
+                     const ALULazyFlags *lazy, const IRInstr *in,
+                     word_t value, uint32_t mem_addr, int taken)
+{
+    TraceEvent ev = {
+        .pc       = cpu->pc,
+        .op       = ir_opcode_unfused(in->op),  /* fusion is invisible */
+        .dst      = in->dst,
+        .src      = in->src,
+        .addr     = in->addr,
+        .target   = in->target,
+        .value    = value,
+        .value_hi = (in->op == IR_UMULL || in->op == IR_SMULL)
+                    ? cpu->regs[in->addr] : 0u,
+        .mem_addr = mem_addr,
+        .flags    = cpu->flags,
+        .taken    = taken
+    };
+    if (is_muldiv(ev.op))
+        ev.iterations = alu_muldiv_iterations();
+    alu_lazy_resolve(lazy, &ev.flags);
+    trace->emit(trace->ctx, &ev);
+}
+
+/* ── PC-driven execution loop ─────────────────────────────────────────────── */
+
+/* Persistent execution context (see cpu_create). */
+struct CPUContext {
+    CPU              cpu;
+    const IRProgram *prog;
+    const TraceSink *trace;
+    int              last_dst;  /* register reported as the result        */
+    size_t           steps;     /* instructions dispatched since reset    */
+    CPURunStatus     status;    /* outcome of the most recent cpu_run     */
+};
+
+static void context_init(CPUContext *ctx, const IRProgram *prog, Memory *mem,
+                         const TraceSink *trace, const CPU *in_state)
+{
+    cpu_init_state(&ctx->cpu, mem, in_state);
+    ctx->prog     = prog;
+    ctx->trace    = trace;
+    ctx->last_dst = 0;
+    ctx->steps    = 0;
+    ctx->status   = CPU_RUN_HALTED;
+}
+
+/*
+ * Switch core.  Resumes ctx from ctx->cpu.pc and dispatches at most
+ * `budget` instructions; the CPU state, result register and step count
+ * live in ctx, so a later call continues exactly where this one stopped.
+ * Returns CPU_RUN_BUDGET with pc at the next undispatched instruction when
+ * the budget runs out (for a superinstruction, possibly its partner).
+ *
+ * `checked` selects per-step validation of register indices, jump targets
+ * and memory attachment; it is a compile-time constant at each call site,
+ * so the trusted (verified) instantiation carries none of those tests.
+ * Dynamic errors are always reported.
+ *
+ * Flags are lazy: ALU instructions only record their operands and result
+ * in `lazy`, and NZCV are derived from it when a JZ/JNZ tests Z, when a
+ * trace event is built, and on every exit, so ctx->cpu.flags is exact
+ * whenever the caller can see it.
+ */
+static inline CPURunStatus run_switch(CPUContext *ctx, size_t budget,
+                                      int checked)
+{
+    const IRProgram *prog  = ctx->prog;
+    const TraceSink *trace = ctx->trace;
+    CPU             *cpu   = &ctx->cpu;
 
-    CPU cpu;
-    memset(&cpu, 0, sizeof(cpu));
-    cpu.mem = mem;   /* may be NULL for arithmetic-only programs */
+    ALULazyFlags lazy = { .op = ALU_LAZY_NONE };  /* cpu->flags is current */
 
-    char   fbuf[FLAGS_BUF];
-    int    last_dst   = 0;
-    size_t step_count = 0;  /* total instructions dispatched (loop guard) */
+    int    last_dst = ctx->last_dst;
+    size_t limit    = ctx->steps + budget < ctx->steps   /* saturate */
+                    ? SIZE_MAX : ctx->steps + budget;
 
     /*
      * PC-driven fetch-decode-execute loop.
@@ -66,93 +215,89 @@ int cpu_execute(const IRProgram *prog, Memory *mem, long *out_result)
      * `jumped` is set to 1 when an instruction has already written pc;
      * the post-switch increment is skipped in that case.
      */
-    while (cpu.pc < prog->count) {
+    while (cpu->pc < prog->count) {
 
-        if (++step_count > CPU_MAX_STEPS) {
-            fprintf(stderr, "cpu error: execution limit (%d steps) exceeded "
-                            "— possible infinite loop at pc=%zu\n",
-                    CPU_MAX_STEPS, cpu.pc);
-            return -1;
+        if (ctx->steps == limit) {
+            ctx->last_dst = last_dst;
+            alu_lazy_resolve(&lazy, &cpu->flags);
+            return CPU_RUN_BUDGET;
         }
+        ctx->steps++;
 
-        const IRInstr *in     = &prog->data[cpu.pc];
+        const IRInstr *in     = &prog->data[cpu->pc];
         int            jumped = 0;  /* set to 1 if this instruction wrote pc */
 
         switch (in->op) {
 
             /* ── LOAD_CONST ──────────────────────────────────────────────── */
             case IR_LOAD_CONST: {
-                if (check_reg(in->dst, "dst", cpu.pc) != 0) return -1;
-                cpu.regs[in->dst] = (word_t)(uint32_t)in->imm;
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                cpu->regs[in->dst] = (word_t)in->imm;
                 /* LOAD_CONST does NOT modify flags. */
-                printf("[CPU pc=%zu] R%d = %u\n",
-                       cpu.pc, in->dst, (unsigned)cpu.regs[in->dst]);
+                if (trace)
+                    cpu_trace_instr(trace, cpu, &lazy, in, cpu->regs[in->dst],
+                                    0, 0);
                 last_dst = in->dst;
                 break;
             }
 
             /* ── ADD ─────────────────────────────────────────────────────── */
             case IR_ADD: {
-                if (check_reg(in->dst, "dst", cpu.pc) != 0) return -1;
-                if (check_reg(in->src, "src", cpu.pc) != 0) return -1;
-                word_t res = alu_add(cpu.regs[in->dst], cpu.regs[in->src],
-                                     &cpu.flags);
-                cpu.regs[in->dst] = res;
-                alu_flags_str(&cpu.flags, fbuf, FLAGS_BUF);
-                printf("[CPU pc=%zu] R%d = R%d + R%d -> %u  (%s)\n",
-                       cpu.pc, in->dst, in->dst, in->src,
-                       (unsigned)res, fbuf);
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src, "src", cpu->pc) != 0)
+                    goto fault;
+                word_t res = alu_add_lazy(cpu->regs[in->dst],
+                                          cpu->regs[in->src], &lazy);
+                cpu->regs[in->dst] = res;
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, res, 0, 0);
                 last_dst = in->dst;
                 break;
             }
 
             /* ── SUB ─────────────────────────────────────────────────────── */
             case IR_SUB: {
-                if (check_reg(in->dst, "dst", cpu.pc) != 0) return -1;
-                if (check_reg(in->src, "src", cpu.pc) != 0) return -1;
-                word_t res = alu_sub(cpu.regs[in->dst], cpu.regs[in->src],
-                                     &cpu.flags);
-                cpu.regs[in->dst] = res;
-                alu_flags_str(&cpu.flags, fbuf, FLAGS_BUF);
-                printf("[CPU pc=%zu] R%d = R%d - R%d -> %u  (%s)\n",
-                       cpu.pc, in->dst, in->dst, in->src,
-                       (unsigned)res, fbuf);
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src, "src", cpu->pc) != 0)
+                    goto fault;
+                word_t res = alu_sub_lazy(cpu->regs[in->dst],
+                                          cpu->regs[in->src], &lazy);
+                cpu->regs[in->dst] = res;
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, res, 0, 0);
                 last_dst = in->dst;
                 break;
             }
 
             /* ── MUL ─────────────────────────────────────────────────────── */
             case IR_MUL: {
-                if (check_reg(in->dst, "dst", cpu.pc) != 0) return -1;
-                if (check_reg(in->src, "src", cpu.pc) != 0) return -1;
-                word_t res = alu_mul(cpu.regs[in->dst], cpu.regs[in->src],
-                                     &cpu.flags);
-                cpu.regs[in->dst] = res;
-                alu_flags_str(&cpu.flags, fbuf, FLAGS_BUF);
-                printf("[CPU pc=%zu] R%d = R%d * R%d -> %u  (%s)\n",
-                       cpu.pc, in->dst, in->dst, in->src,
-                       (unsigned)res, fbuf);
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src, "src", cpu->pc) != 0)
+                    goto fault;
+                word_t res = alu_mul_lazy(cpu->regs[in->dst],
+                                          cpu->regs[in->src], &lazy);
+                cpu->regs[in->dst] = res;
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, res, 0, 0);
                 last_dst = in->dst;
                 break;
             }
 
             /* ── DIV ─────────────────────────────────────────────────────── */
             case IR_DIV: {
-                if (check_reg(in->dst, "dst", cpu.pc) != 0) return -1;
-                if (check_reg(in->src, "src", cpu.pc) != 0) return -1;
-                if (cpu.regs[in->src] == 0u) {
-                    fprintf(stderr,
-                            "cpu error: division by zero (R%d = 0) at pc=%zu\n",
-                            in->src, cpu.pc);
-                    return -1;
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src, "src", cpu->pc) != 0)
+                    goto fault;
+                if (cpu->regs[in->src] == 0u) {
+                    cpu_report_div_zero(in->src, cpu->pc);
+                    goto fault;
                 }
-                word_t res = alu_div(cpu.regs[in->dst], cpu.regs[in->src],
-                                     &cpu.flags);
-                cpu.regs[in->dst] = res;
-                alu_flags_str(&cpu.flags, fbuf, FLAGS_BUF);
-                printf("[CPU pc=%zu] R%d = R%d / R%d -> %u  (%s)\n",
-                       cpu.pc, in->dst, in->dst, in->src,
-                       (unsigned)res, fbuf);
+                word_t res = alu_div_lazy(cpu->regs[in->dst],
+                                          cpu->regs[in->src], &lazy);
+                cpu->regs[in->dst] = res;
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, res, 0, 0);
                 last_dst = in->dst;
                 break;
             }
@@ -165,23 +310,23 @@ int cpu_execute(const IRProgram *prog, Memory *mem, long *out_result)
              * CMP does NOT update last_dst (no register is written).
              */
             case IR_CMP: {
-                if (check_reg(in->dst, "dst", cpu.pc) != 0) return -1;
-                if (check_reg(in->src, "src", cpu.pc) != 0) return -1;
-                alu_sub(cpu.regs[in->dst], cpu.regs[in->src], &cpu.flags);
-                alu_flags_str(&cpu.flags, fbuf, FLAGS_BUF);
-                printf("[CPU pc=%zu] CMP R%d, R%d  (%s)\n",
-                       cpu.pc, in->dst, in->src, fbuf);
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src, "src", cpu->pc) != 0)
+                    goto fault;
+                alu_sub_lazy(cpu->regs[in->dst], cpu->regs[in->src], &lazy);
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, 0, 0, 0);
                 /* flags updated; no register written */
                 break;
             }
 
             /* ── JMP ─────────────────────────────────────────────────────── */
             case IR_JMP: {
-                if (check_target(in->target, prog->count, cpu.pc) != 0)
-                    return -1;
-                printf("[CPU pc=%zu] JMP -> target=%d\n",
-                       cpu.pc, in->target);
-                cpu.pc = (size_t)in->target;
+                if (checked && cpu_check_target(in->target, prog->count,
+                                                cpu->pc) != 0)
+                    goto fault;
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, 0, 0, 1);
+                cpu->pc = (size_t)in->target;
                 jumped = 1;
                 /* JMP does NOT modify flags or registers */
                 break;
@@ -189,30 +334,30 @@ int cpu_execute(const IRProgram *prog, Memory *mem, long *out_result)
 
             /* ── JZ ──────────────────────────────────────────────────────── */
             case IR_JZ: {
-                if (cpu.flags.Z) {
-                    if (check_target(in->target, prog->count, cpu.pc) != 0)
-                        return -1;
-                    printf("[CPU pc=%zu] JZ -> taken (target=%d)\n",
-                           cpu.pc, in->target);
-                    cpu.pc = (size_t)in->target;
+                if (alu_lazy_zero(&lazy, &cpu->flags)) {
+                    if (checked && cpu_check_target(in->target, prog->count,
+                                                    cpu->pc) != 0)
+                        goto fault;
+                    if (trace) cpu_trace_instr(trace, cpu, &lazy, in, 0, 0, 1);
+                    cpu->pc = (size_t)in->target;
                     jumped = 1;
                 } else {
-                    printf("[CPU pc=%zu] JZ -> not taken\n", cpu.pc);
+                    if (trace) cpu_trace_instr(trace, cpu, &lazy, in, 0, 0, 0);
                 }
                 break;
             }
 
             /* ── JNZ ─────────────────────────────────────────────────────── */
             case IR_JNZ: {
-                if (!cpu.flags.Z) {
-                    if (check_target(in->target, prog->count, cpu.pc) != 0)
-                        return -1;
-                    printf("[CPU pc=%zu] JNZ -> taken (target=%d)\n",
-                           cpu.pc, in->target);
-                    cpu.pc = (size_t)in->target;
+                if (!alu_lazy_zero(&lazy, &cpu->flags)) {
+                    if (checked && cpu_check_target(in->target, prog->count,
+                                                    cpu->pc) != 0)
+                        goto fault;
+                    if (trace) cpu_trace_instr(trace, cpu, &lazy, in, 0, 0, 1);
+                    cpu->pc = (size_t)in->target;
                     jumped = 1;
                 } else {
-                    printf("[CPU pc=%zu] JNZ -> not taken\n", cpu.pc);
+                    if (trace) cpu_trace_instr(trace, cpu, &lazy, in, 0, 0, 0);
                 }
                 break;
             }
@@ -221,22 +366,23 @@ int cpu_execute(const IRProgram *prog, Memory *mem, long *out_result)
             /*
              * R[dst] = MEM[R[addr]]
              * The address register holds a byte address; access must be
-             * 32-bit aligned.  Flags are NOT modified.
+             * word-aligned (MEM_WORD_SIZE).  Flags are NOT modified.
              */
             case IR_LOAD: {
-                if (check_reg(in->dst,  "dst",  cpu.pc) != 0) return -1;
-                if (check_reg(in->addr, "addr", cpu.pc) != 0) return -1;
-                if (!cpu.mem) {
-                    fprintf(stderr, "cpu error: LOAD at pc=%zu but no memory "
-                                    "was attached to this CPU\n", cpu.pc);
-                    return -1;
+                if (checked && cpu_check_reg(in->dst,  "dst",  cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->addr, "addr", cpu->pc) != 0)
+                    goto fault;
+                if (checked && !cpu->mem) {
+                    cpu_report_no_mem(in->op, cpu->pc);
+                    goto fault;
                 }
-                uint32_t addr  = cpu.regs[in->addr];
-                uint32_t value = 0;
-                if (mem_read_word(cpu.mem, addr, &value) != 0) return -1;
-                cpu.regs[in->dst] = (word_t)value;
-                printf("[CPU pc=%zu] LOAD R%d <- MEM[0x%04x] -> %u\n",
-                       cpu.pc, in->dst, (unsigned)addr, (unsigned)value);
+                word_t addr  = cpu->regs[in->addr];
+                word_t value = 0;
+                if (mem_read_word(cpu->mem, addr, &value) != 0) goto fault;
+                cpu->regs[in->dst] = (word_t)value;
+                if (trace)
+                    cpu_trace_instr(trace, cpu, &lazy, in, value, addr, 0);
                 last_dst = in->dst;
                 break;
             }
@@ -247,37 +393,456 @@ int cpu_execute(const IRProgram *prog, Memory *mem, long *out_result)
              * Flags are NOT modified.
              */
             case IR_STORE: {
-                if (check_reg(in->src,  "src",  cpu.pc) != 0) return -1;
-                if (check_reg(in->addr, "addr", cpu.pc) != 0) return -1;
-                if (!cpu.mem) {
-                    fprintf(stderr, "cpu error: STORE at pc=%zu but no memory "
-                                    "was attached to this CPU\n", cpu.pc);
-                    return -1;
+                if (checked && cpu_check_reg(in->src,  "src",  cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->addr, "addr", cpu->pc) != 0)
+                    goto fault;
+                if (checked && !cpu->mem) {
+                    cpu_report_no_mem(in->op, cpu->pc);
+                    goto fault;
                 }
-                uint32_t addr  = cpu.regs[in->addr];
-                uint32_t value = cpu.regs[in->src];
-                if (mem_write_word(cpu.mem, addr, value) != 0) return -1;
-                printf("[CPU pc=%zu] STORE MEM[0x%04x] <- R%d (%u)\n",
-                       cpu.pc, (unsigned)addr, in->src, (unsigned)value);
+                word_t addr  = cpu->regs[in->addr];
+                word_t value = cpu->regs[in->src];
+                if (mem_write_word(cpu->mem, addr, value) != 0) goto fault;
+                if (trace)
+                    cpu_trace_instr(trace, cpu, &lazy, in, value, addr, 0);
                 /* STORE writes no register; last_dst unchanged */
                 break;
             }
 
+            /* ── AND / OR / XOR / NOT / SHL / LSR / ASR / ROR ────────────── */
+            /*
+             * These keep C (or set it from the shifter) and keep V, so the
+             * pending flags are materialised first and updated in place.
+             */
+            case IR_AND:
+            case IR_OR:
+            case IR_XOR:
+            case IR_NOT:
+            case IR_SHL:
+            case IR_LSR:
+            case IR_ASR:
+            case IR_ROR: {
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src, "src", cpu->pc) != 0)
+                    goto fault;
+                alu_lazy_flush(&lazy, &cpu->flags);
+                word_t res = cpu_logic(in->op, cpu->regs[in->dst],
+                                       cpu->regs[in->src], &cpu->flags);
+                cpu->regs[in->dst] = res;
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, res, 0, 0);
+                last_dst = in->dst;
+                break;
+            }
+
+            /* ── SDIV / SREM / UREM ──────────────────────────────────────── */
+            case IR_SDIV:
+            case IR_SREM:
+            case IR_UREM: {
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src, "src", cpu->pc) != 0)
+                    goto fault;
+                word_t a = cpu->regs[in->dst];
+                word_t b = cpu->regs[in->src];
+                if (b == 0u) {
+                    cpu_report_div_zero(in->src, cpu->pc);
+                    goto fault;
+                }
+                if (in->op == IR_SDIV && a == WORD_SMIN && b == WORD_MAX) {
+                    cpu_report_div_overflow(in->dst, in->src, cpu->pc);
+                    goto fault;
+                }
+                word_t res = in->op == IR_SDIV ? alu_sdiv_lazy(a, b, &lazy)
+                           : in->op == IR_SREM ? alu_srem_lazy(a, b, &lazy)
+                                               : alu_urem_lazy(a, b, &lazy);
+                cpu->regs[in->dst] = res;
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, res, 0, 0);
+                last_dst = in->dst;
+                break;
+            }
+
+            /* ── UMULL / SMULL ───────────────────────────────────────────── */
+            /*
+             * Low word to R[dst], high word to R[addr].  The high word is
+             * written last, so it is what R[dst] holds if addr == dst.
+             */
+            case IR_UMULL:
+            case IR_SMULL: {
+                if (checked && cpu_check_reg(in->dst,  "dst",  cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src,  "src",  cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->addr, "addr", cpu->pc) != 0)
+                    goto fault;
+                word_t hi;
+                word_t lo = alu_mull_lazy(cpu->regs[in->dst],
+                                          cpu->regs[in->src], &hi,
+                                          in->op == IR_SMULL, &lazy);
+                cpu->regs[in->dst]  = lo;
+                cpu->regs[in->addr] = hi;
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, lo, 0, 0);
+                last_dst = in->dst;
+                break;
+            }
+
+            /* ── MLA ─────────────────────────────────────────────────────── */
+            case IR_MLA: {
+                if (checked && cpu_check_reg(in->dst,  "dst",  cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src,  "src",  cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->addr, "addr", cpu->pc) != 0)
+                    goto fault;
+                word_t res = alu_mla_lazy(cpu->regs[in->dst],
+                                          cpu->regs[in->src],
+                                          cpu->regs[in->addr], &lazy);
+                cpu->regs[in->dst] = res;
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, res, 0, 0);
+                last_dst = in->dst;
+                break;
+            }
+
+            /* ── Superinstructions (see ir_program_fuse) ─────────────────── */
+            /*
+             * Each executes the instruction at pc and its partner at pc+1 in
+             * one dispatch.  The partner still counts as its own step (and
+             * trips the step limit at pc+1), and traces as its own line.
+             */
+            case IR_FUSED_SUB_JNZ:
+            case IR_FUSED_CMP_JZ:
+            case IR_FUSED_CMP_JNZ: {
+                if (checked && cpu->pc + 1 >= prog->count) {
+                    cpu_report_bad_opcode((int)in->op, cpu->pc);
+                    goto fault;
+                }
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(in->src, "src", cpu->pc) != 0)
+                    goto fault;
+                word_t res = alu_sub_lazy(cpu->regs[in->dst],
+                                          cpu->regs[in->src], &lazy);
+                if (in->op == IR_FUSED_SUB_JNZ) {
+                    cpu->regs[in->dst] = res;
+                    last_dst = in->dst;
+                } else {
+                    res = 0;   /* CMP discards the result */
+                }
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, in, res, 0, 0);
+
+                /* Partner: the conditional branch at pc+1. */
+                const IRInstr *br = in + 1;
+                cpu->pc++;
+                if (ctx->steps == limit)
+                    continue;   /* out of budget before the partner */
+                ctx->steps++;
+                int z     = alu_lazy_zero(&lazy, &cpu->flags);
+                int taken = (in->op == IR_FUSED_CMP_JZ) ? z : !z;
+                if (taken) {
+                    if (checked && cpu_check_target(br->target, prog->count,
+                                                    cpu->pc) != 0)
+                        goto fault;
+                    if (trace) cpu_trace_instr(trace, cpu, &lazy, br, 0, 0, 1);
+                    cpu->pc = (size_t)br->target;
+                    jumped = 1;
+                } else {
+                    if (trace) cpu_trace_instr(trace, cpu, &lazy, br, 0, 0, 0);
+                }
+                break;
+            }
+
+            case IR_FUSED_CONST_ALU: {
+                if (checked && cpu->pc + 1 >= prog->count) {
+                    cpu_report_bad_opcode((int)in->op, cpu->pc);
+                    goto fault;
+                }
+                if (checked && cpu_check_reg(in->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                cpu->regs[in->dst] = (word_t)in->imm;
+                if (trace)
+                    cpu_trace_instr(trace, cpu, &lazy, in, cpu->regs[in->dst],
+                                    0, 0);
+                last_dst = in->dst;
+
+                /* Partner: the ALU instruction at pc+1. */
+                const IRInstr *op2 = in + 1;
+                cpu->pc++;
+                if (ctx->steps == limit)
+                    continue;   /* out of budget before the partner */
+                ctx->steps++;
+                if (checked && cpu_check_reg(op2->dst, "dst", cpu->pc) != 0)
+                    goto fault;
+                if (checked && cpu_check_reg(op2->src, "src", cpu->pc) != 0)
+                    goto fault;
+                word_t a = cpu->regs[op2->dst];
+                word_t b = cpu->regs[op2->src];
+                word_t res;
+                switch (op2->op) {
+                    case IR_ADD: res = alu_add_lazy(a, b, &lazy); break;
+                    case IR_SUB: res = alu_sub_lazy(a, b, &lazy); break;
+                    case IR_MUL: res = alu_mul_lazy(a, b, &lazy); break;
+                    case IR_DIV:
+                        if (b == 0u) {
+                            cpu_report_div_zero(op2->src, cpu->pc);
+                            goto fault;
+                        }
+                        res = alu_div_lazy(a, b, &lazy);
+                        break;
+                    default:   /* IR_CMP */
+                        alu_sub_lazy(a, b, &lazy);
+                        res = 0;
+                        break;
+                }
+                if (op2->op != IR_CMP) {
+                    cpu->regs[op2->dst] = res;
+                    last_dst = op2->dst;
+                }
+                if (trace) cpu_trace_instr(trace, cpu, &lazy, op2, res, 0, 0);
+                break;
+            }
+
             default:
-                fprintf(stderr, "cpu error: unknown opcode %d at pc=%zu\n",
-                        (int)in->op, cpu.pc);
-                return -1;
+                cpu_report_bad_opcode((int)in->op, cpu->pc);
+                goto fault;
         }
 
         /* Advance PC unless a jump already set it. */
         if (!jumped)
-            cpu.pc++;
+            cpu->pc++;
     }
 
+    ctx->last_dst = last_dst;
+    alu_lazy_resolve(&lazy, &cpu->flags);
+    return CPU_RUN_HALTED;
+
+fault:
+    alu_lazy_resolve(&lazy, &cpu->flags);
+    return CPU_RUN_ERROR;
+}
+
+/*
+ * One-shot run of a fresh context: the cpu_execute_opts contract, where an
+ * exhausted budget is the step-limit error.
+ */
+static inline int run_switch_once(const IRProgram *prog, Memory *mem,
+                                  long *out_result, const TraceSink *trace,
+                                  size_t max_steps, const CPU *in_state,
+                                  CPU *out_state, int checked)
+{
+    CPUContext ctx;
+    context_init(&ctx, prog, mem, trace, in_state);
+
+    CPURunStatus status = run_switch(&ctx, max_steps, checked);
+    if (status == CPU_RUN_BUDGET)
+        return cpu_report_step_limit(max_steps, ctx.cpu.pc);
+    if (status != CPU_RUN_HALTED)
+        return -1;
+
     if (out_result)
-        *out_result = (long)(int32_t)cpu.regs[last_dst];
+        *out_result = (long)(sword_t)ctx.cpu.regs[ctx.last_dst];
+    if (out_state)
+        *out_state = ctx.cpu;
+    return 0;
+}
+
+/* ── Prepared code ────────────────────────────────────────────────────────── */
+
+struct CPUCode {
+    const IRProgram *prog;
+    CPUCore          core;
+    ThreadedCode    *threaded;  /* CPU_CORE_THREADED                      */
+    JitCode         *jit;       /* CPU_CORE_JIT; NULL if not translatable */
+};
+
+CPUCode *cpu_prepare(const IRProgram *prog, CPUCore core)
+{
+    CPUCode *code = calloc(1, sizeof(*code));
+    if (!code) { perror("calloc"); exit(EXIT_FAILURE); }
+    code->prog = prog;
+    code->core = core;
+    if (core == CPU_CORE_THREADED && prog)
+        code->threaded = cpu_threaded_prepare(prog);
+    else if (core == CPU_CORE_JIT && prog)
+        code->jit = jit_compile(prog);
+    return code;
+}
 
+void cpu_code_free(CPUCode *code)
+{
+    if (!code) return;
+    cpu_threaded_free(code->threaded);
+    jit_free(code->jit);
+    free(code);
+}
+
+/* opts->code, if any, must have been prepared for this program and core. */
+static int check_code(const IRProgram *prog, const CPUOptions *opts)
+{
+    if (opts && opts->code
+            && (opts->code->prog != prog || opts->code->core != opts->core)) {
+        fprintf(stderr, "cpu error: prepared code is for another program "
+                        "or core\n");
+        return -1;
+    }
     return 0;
 }
 
+/* The threaded core, on the prepared stream or a one-off predecode. */
+static int run_threaded(const IRProgram *prog, const CPUCode *code,
+                        Memory *mem, long *out_result,
+                        const TraceSink *trace, size_t max_steps,
+                        const CPU *in_state, CPU *out_state)
+{
+    if (code)
+        return cpu_run_threaded(code->threaded, mem, out_result, trace,
+                                max_steps, in_state, out_state);
+
+    ThreadedCode *tc     = cpu_threaded_prepare(prog);
+    int           status = cpu_run_threaded(tc, mem, out_result, trace,
+                                            max_steps, in_state, out_state);
+    cpu_threaded_free(tc);
+    return status;
+}
+
+/* ── Entry points ─────────────────────────────────────────────────────────── */
+
+int cpu_execute(const IRProgram *prog, Memory *mem, long *out_result)
+{
+    TraceSink  text = trace_sink_text(stdout);
+    CPUOptions opts = { .trace = &text, .max_steps = CPU_MAX_STEPS };
+    return cpu_execute_opts(prog, mem, out_result, &opts);
+}
+
+int cpu_execute_opts(const IRProgram *prog, Memory *mem, long *out_result,
+                     const CPUOptions *opts)
+{
+    if (!prog || prog->count == 0) {
+        fprintf(stderr, "cpu error: empty program\n");
+        return -1;
+    }
+    if (check_code(prog, opts) != 0)
+        return -1;
+
+    /* Options are resolved once; the loop only reads locals. */
+    const TraceSink *trace     = opts ? opts->trace : NULL;
+    size_t           max_steps = (opts && opts->max_steps) ? opts->max_steps
+                                                           : CPU_MAX_STEPS;
+    const CPU       *in_state  = opts ? opts->in_state  : NULL;
+    CPU             *out_state = opts ? opts->out_state : NULL;
+
+    if (opts && opts->core == CPU_CORE_THREADED)
+        return run_threaded(prog, opts->code, mem, out_result, trace,
+                            max_steps, in_state, out_state);
+
+    return run_switch_once(prog, mem, out_result, trace, max_steps, in_state,
+                           out_state, 1);
+}
+
+int cpu_execute_verified(const IRProgram *prog, Memory *mem,
+                         long *out_result, const CPUOptions *opts)
+{
+    if (!prog || prog->count == 0) {
+        fprintf(stderr, "cpu error: empty program\n");
+        return -1;
+    }
+    if (!prog->verified) {
+        fprintf(stderr, "cpu error: program has not been verified "
+                        "(call ir_program_verify first)\n");
+        return -1;
+    }
+    if (check_code(prog, opts) != 0)
+        return -1;
+    /* The one memory-attachment check, hoisted out of the loop. */
+    if (prog->uses_memory && !mem) {
+        fprintf(stderr, "cpu error: program uses LOAD/STORE but no memory "
+                        "was attached to this CPU\n");
+        return -1;
+    }
+
+    const TraceSink *trace     = opts ? opts->trace : NULL;
+    size_t           max_steps = (opts && opts->max_steps) ? opts->max_steps
+                                                           : CPU_MAX_STEPS;
+    const CPU       *in_state  = opts ? opts->in_state  : NULL;
+    CPU             *out_state = opts ? opts->out_state : NULL;
+
+    /* The threaded core already resolves every static check at predecode. */
+    if (opts && opts->core == CPU_CORE_THREADED)
+        return run_threaded(prog, opts->code, mem, out_result, trace,
+                            max_steps, in_state, out_state);
+
+    /* Native code cannot trace; unsupported programs use the interpreter. */
+    if (opts && opts->core == CPU_CORE_JIT && !trace) {
+        JitCode *own = opts->code ? NULL : jit_compile(prog);
+        JitCode *jit = opts->code ? opts->code->jit : own;
+        if (jit) {
+            int status = jit_run(jit, mem, out_result, max_steps,
+                                 in_state, out_state);
+            jit_free(own);
+            return status;
+        }
+    }
+
+    return run_switch_once(prog, mem, out_result, trace, max_steps, in_state,
+                           out_state, 0);
+}
+
+/* ── Persistent contexts ──────────────────────────────────────────────────── */
+
+CPUContext *cpu_create(const IRProgram *prog, Memory *mem,
+                       const TraceSink *trace)
+{
+    CPUContext *ctx = malloc(sizeof(*ctx));
+    if (!ctx) { perror("malloc"); exit(EXIT_FAILURE); }
+    context_init(ctx, prog, mem, trace, NULL);
+    return ctx;
+}
+
+void cpu_reset(CPUContext *ctx)
+{
+    context_init(ctx, ctx->prog, ctx->cpu.mem, ctx->trace, NULL);
+}
 
+void cpu_load(CPUContext *ctx, const IRProgram *prog)
+{
+    context_init(ctx, prog, ctx->cpu.mem, ctx->trace, NULL);
+}
+
+CPURunStatus cpu_run(CPUContext *ctx, size_t budget)
+{
+    const IRProgram *prog = ctx->prog;
+
+    if (ctx->status == CPU_RUN_ERROR)
+        return CPU_RUN_ERROR;   /* sticky until cpu_reset */
+    if (!prog || prog->count == 0) {
+        fprintf(stderr, "cpu error: empty program\n");
+        return ctx->status = CPU_RUN_ERROR;
+    }
+
+    /* Skip per-step checks only when verification covers all of them. */
+    if (prog->verified && !(prog->uses_memory && !ctx->cpu.mem))
+        ctx->status = run_switch(ctx, budget, 0);
+    else
+        ctx->status = run_switch(ctx, budget, 1);
+    return ctx->status;
+}
+
+void cpu_destroy(CPUContext *ctx)
+{
+    free(ctx);
+}
+
+CPU *cpu_state(CPUContext *ctx)
+{
+    return &ctx->cpu;
+}
+
+long cpu_result(const CPUContext *ctx)
+{
+    return (long)(sword_t)ctx->cpu.regs[ctx->last_dst];
+}
+
+size_t cpu_steps(const CPUContext *ctx)
+{
+    return ctx->steps;
+}
@@ -4,6 +4,7 @@
 #include "ir.h"
 #include "alu.h"
 #include "memory.h"
+#include "trace.h"
 
 /*
  * Virtual CPU — Level-5 load/store architecture.
@@ -18,7 +19,7 @@
  *   - cpu_execute now takes a `Memory *mem` parameter.
  *
  * Invariants preserved from Level-4:
- *   - Register file is `word_t` (uint32_t).
+ *   - Register file is `word_t`, WORD_BITS wide (word.h; 32 by default).
  *   - All arithmetic still flows through the ALU.
  *   - PC-driven fetch-decode-execute loop.
  *   - `flags` reflects the most recent ALU-touching operation.
@@ -29,24 +30,150 @@
 #define CPU_MAX_STEPS 1000000   /* infinite-loop guard */
 
 typedef struct {
-    word_t   regs[CPU_MAX_REGS]; /* 32-bit register file          */
+    word_t   regs[CPU_MAX_REGS]; /* WORD_BITS-wide register file  */
     ALUFlags flags;              /* flags from last ALU operation  */
     size_t   pc;                 /* program counter               */
     Memory  *mem;                /* RAM — not owned by CPU        */
 } CPU;
 
+/*
+ * Interpreter cores.  All cores produce bit-identical registers, flags,
+ * traces and error messages; they differ only in how they dispatch.
+ *
+ *   CPU_CORE_SWITCH    reference core: decodes each IRInstr with a switch.
+ *   CPU_CORE_THREADED  predecodes the program once into a handler stream
+ *                      with register operands range-checked, then
+ *                      dispatches by direct threading (GCC labels-as-values)
+ *                      or a portable switch where that is unavailable.
+ *                      Pass cpu_prepare's stream in CPUOptions.code to
+ *                      predecode once for many runs.
+ *   CPU_CORE_JIT       translates the program to x86-64 machine code (see
+ *                      jit.h).  Only used by cpu_execute_verified with the
+ *                      trace off; otherwise, on other hosts, or for opcodes
+ *                      the JIT does not translate, the switch core runs.
+ *                      CPUOptions.code likewise saves recompiling.
+ */
+typedef enum {
+    CPU_CORE_SWITCH = 0,
+    CPU_CORE_THREADED,
+    CPU_CORE_JIT
+} CPUCore;
+
+/*
+ * Code prepared once for one program and core, for reuse across runs (and
+ * threads: it is only read while running).  For CPU_CORE_THREADED this is
+ * the predecoded handler stream, for CPU_CORE_JIT the native code (or
+ * none, if the JIT cannot translate the program); the switch core needs
+ * nothing.  The program must not change while its code is in use.
+ */
+typedef struct CPUCode CPUCode;
+
+CPUCode *cpu_prepare(const IRProgram *prog, CPUCore core);
+void cpu_code_free(CPUCode *code);
+
+/*
+ * Per-run execution options, chosen once before the run starts.
+ *
+ *   trace      sink that receives one TraceEvent per instruction, or NULL
+ *              to run trace-free (no event is built, nothing is formatted).
+ *   max_steps  infinite-loop guard; 0 selects CPU_MAX_STEPS.
+ *   core       interpreter core to run on.
+ *   in_state   if non-NULL, initial registers and flags (its pc and mem are
+ *              ignored); otherwise the CPU starts zeroed.
+ *   out_state  if non-NULL, receives the final CPU state on success.
+ *   code       if non-NULL, cpu_prepare(prog, core)'s code, run instead of
+ *              preparing the program again; a mismatch is an error.
+ */
+typedef struct {
+    const TraceSink *trace;
+    size_t           max_steps;
+    CPUCore          core;
+    const CPU       *in_state;
+    CPU             *out_state;
+    const CPUCode   *code;
+} CPUOptions;
+
 /*
  * Execute `prog` on a freshly zeroed CPU backed by `mem`.
  *
  * `mem` may be NULL if the program contains no LOAD/STORE instructions;
  * a NULL mem with a LOAD/STORE will produce a cpu error at runtime.
  *
- * Prints a trace line per instruction.
+ * Prints a text trace line per instruction to stdout.
  * Stores sign-extended result of the last-written register in *out_result.
  * Returns 0 on success, -1 on error.
  */
 int cpu_execute(const IRProgram *prog, Memory *mem, long *out_result);
 
+/*
+ * As cpu_execute, but with explicit options (trace sink, step limit).
+ * A NULL `opts` means trace off and the default step limit.
+ * Errors are always reported on stderr, regardless of the trace sink.
+ */
+int cpu_execute_opts(const IRProgram *prog, Memory *mem, long *out_result,
+                     const CPUOptions *opts);
+
+/*
+ * Trusted entry point for programs that passed ir_program_verify(prog,
+ * CPU_MAX_REGS).  Register indices, jump targets and the memory attachment
+ * are checked once up front instead of on every step.  Dynamic errors
+ * (division by zero, bad memory addresses, step limit) are reported exactly
+ * as cpu_execute_opts reports them.
+ *
+ * Refuses (returns -1) an unverified program, or one that uses LOAD/STORE
+ * when `mem` is NULL.
+ */
+int cpu_execute_verified(const IRProgram *prog, Memory *mem,
+                         long *out_result, const CPUOptions *opts);
+
+/* ── Persistent contexts ──────────────────────────────────────────────────── */
+
+/*
+ * A CPUContext keeps the register file, flags, pc, step count and attached
+ * Memory between calls, so a program can be run in slices: cpu_run
+ * dispatches at most `budget` instructions and reports why it stopped.
+ * Contexts run on the switch core (the trusted variant for verified
+ * programs); the budget replaces CPU_MAX_STEPS as the loop guard.
+ */
+typedef struct CPUContext CPUContext;
+
+typedef enum {
+    CPU_RUN_ERROR  = -1,  /* fault reported on stderr; sticky until reset */
+    CPU_RUN_HALTED =  0,  /* pc ran past the last instruction             */
+    CPU_RUN_BUDGET =  1   /* budget exhausted; cpu_run again to resume    */
+} CPURunStatus;
+
+/*
+ * Allocate a context for `prog` (may be NULL until cpu_load) on `mem` (not
+ * owned; may be NULL for programs without LOAD/STORE), tracing each step
+ * to `trace` (NULL = trace off).  The CPU starts zeroed at pc 0.
+ */
+CPUContext *cpu_create(const IRProgram *prog, Memory *mem,
+                       const TraceSink *trace);
+
+/* Rewind to pc 0 with zeroed registers, flags and step count. */
+void cpu_reset(CPUContext *ctx);
+
+/* Replace the program, then reset (the Memory stays attached). */
+void cpu_load(CPUContext *ctx, const IRProgram *prog);
+
+/* Run for at most `budget` instructions from where the last call stopped. */
+CPURunStatus cpu_run(CPUContext *ctx, size_t budget);
+
+void cpu_destroy(CPUContext *ctx);
+
+/*
+ * Live CPU state.  Registers and flags may be seeded between cpu_reset and
+ * the first cpu_run (the equivalent of CPUOptions.in_state).
+ */
+CPU *cpu_state(CPUContext *ctx);
+
+/* Sign-extended value of the last-written register (valid once halted). */
+long cpu_result(const CPUContext *ctx);
+
+/* Instructions dispatched since the last reset. */
+size_t cpu_steps(const CPUContext *ctx);
+
 #endif /* CPU_H */
 
 
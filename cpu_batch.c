@@ -0,0 +1,626 @@
+/*
+ * cpu_batch.c — lockstep execution of one program over many lanes.
+ *
+ * See cpu_batch.h for the execution model.  Per step:
+ *
+ *   1. pc    = lowest pc of any lane; a faulted lane is parked at
+ *              prog->count, where halted lanes end up too.
+ *   2. mask  = lanes at that pc whose step budget is not exhausted.
+ *   3. Execute prog->data[pc] for the masked lanes and advance their pc.
+ *
+ * Flags are kept struct-of-arrays too, one uint32_t per lane holding 0 or
+ * 1, so the vector kernels can compute and blend all four with whole-vector
+ * operations.  Results are blended under the mask, so inactive lanes keep
+ * their registers and flags untouched.  The per-step bookkeeping (pc, step
+ * counts, mask, last-written register) is 32 bits per lane as well, and
+ * steps 1-3 run on whole vectors; a lane that faults drops out of the
+ * mask at once, so the pc update after the kernel needs no status test.
+ */
+
+#include "cpu_batch.h"
+#include "cpu_internal.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ── Vector width ─────────────────────────────────────────────────────────── */
+
+/* The kernels use 32-bit lane instructions: other word widths run scalar. */
+#if WORD_BITS == 32 && defined(__AVX2__)
+#  include <immintrin.h>
+#  define BATCH_VEC 8
+typedef __m256i vec_t;
+#  define V_LOAD(p)      _mm256_loadu_si256((const __m256i *)(const void *)(p))
+#  define V_STORE(p, x)  _mm256_storeu_si256((__m256i *)(void *)(p), (x))
+#  define V_SET1(x)      _mm256_set1_epi32((int)(x))
+#  define V_ADD          _mm256_add_epi32
+#  define V_SUB          _mm256_sub_epi32
+#  define V_AND          _mm256_and_si256
+#  define V_ANDNOT       _mm256_andnot_si256   /* ~a & b */
+#  define V_OR           _mm256_or_si256
+#  define V_XOR          _mm256_xor_si256
+#  define V_CMPEQ        _mm256_cmpeq_epi32
+#  define V_CMPGT        _mm256_cmpgt_epi32
+#  define V_SRL31(x)     _mm256_srli_epi32((x), 31)
+#  define V_ANY(x)       (_mm256_movemask_epi8(x) != 0)
+#elif WORD_BITS == 32 && defined(__SSE2__)
+#  include <emmintrin.h>
+#  define BATCH_VEC 4
+typedef __m128i vec_t;
+#  define V_LOAD(p)      _mm_loadu_si128((const __m128i *)(const void *)(p))
+#  define V_STORE(p, x)  _mm_storeu_si128((__m128i *)(void *)(p), (x))
+#  define V_SET1(x)      _mm_set1_epi32((int)(x))
+#  define V_ADD          _mm_add_epi32
+#  define V_SUB          _mm_sub_epi32
+#  define V_AND          _mm_and_si128
+#  define V_ANDNOT       _mm_andnot_si128      /* ~a & b */
+#  define V_OR           _mm_or_si128
+#  define V_XOR          _mm_xor_si128
+#  define V_CMPEQ        _mm_cmpeq_epi32
+#  define V_CMPGT        _mm_cmpgt_epi32
+#  define V_SRL31(x)     _mm_srli_epi32((x), 31)
+#  define V_ANY(x)       (_mm_movemask_epi8(x) != 0)
+#else
+#  define BATCH_VEC 1    /* no SIMD: every lane takes the scalar path */
+#endif
+
+#if BATCH_VEC > 1
+/* Lanes where m is all-ones take x, the others keep old. */
+#  define V_BLEND(m, x, old)  V_OR(V_AND((m), (x)), V_ANDNOT((m), (old)))
+/* Unsigned a < b, via the signed compare on sign-flipped operands. */
+#  define V_ULT(a, b, bias)   V_CMPGT(V_XOR((b), (bias)), V_XOR((a), (bias)))
+#endif
+
+/* ── Lane state ───────────────────────────────────────────────────────────── */
+
+/* Lane pcs and step counts are 32 bits, compared signed by the kernels. */
+#define BATCH_MAX_PC    ((size_t)INT32_MAX)
+#define BATCH_MAX_STEPS ((size_t)INT32_MAX - 1)
+
+typedef struct {
+    size_t    lanes;
+    uint32_t  halt;              /* prog->count: where lanes stop       */
+    word_t   *regs;              /* caller's SoA register file          */
+    uint32_t *z, *n, *c, *v;     /* SoA flags, unpacked: each 0 or 1   */
+    uint32_t *mask;              /* ~0u for lanes in the current step   */
+    uint32_t *pc;
+    uint32_t *steps;
+    int32_t  *last_dst;
+    int      *status;            /* 0 live or halted, -1 faulted        */
+} Lanes;
+
+#define ROW(L, r)  (&(L)->regs[(size_t)(r) * (L)->lanes])
+
+static void *lane_array(size_t lanes, size_t size)
+{
+    void *p = calloc(lanes, size);
+    if (!p) { perror("calloc"); exit(EXIT_FAILURE); }
+    return p;
+}
+
+static void lanes_init(Lanes *L, const CPUBatch *batch, uint32_t halt)
+{
+    size_t lanes = batch->lanes;
+
+    L->lanes    = lanes;
+    L->halt     = halt;
+    L->regs     = batch->regs;
+    L->z        = lane_array(lanes, sizeof(uint32_t));
+    L->n        = lane_array(lanes, sizeof(uint32_t));
+    L->c        = lane_array(lanes, sizeof(uint32_t));
+    L->v        = lane_array(lanes, sizeof(uint32_t));
+    L->mask     = lane_array(lanes, sizeof(uint32_t));
+    L->pc       = lane_array(lanes, sizeof(uint32_t));
+    L->steps    = lane_array(lanes, sizeof(uint32_t));
+    L->last_dst = lane_array(lanes, sizeof(int32_t));
+    L->status   = lane_array(lanes, sizeof(int));
+
+    if (batch->flags) {
+        for (size_t i = 0; i < lanes; i++) {
+            L->z[i] = alu_flag(batch->flags[i], ALU_FLAG_Z);
+            L->n[i] = alu_flag(batch->flags[i], ALU_FLAG_N);
+            L->c[i] = alu_flag(batch->flags[i], ALU_FLAG_C);
+            L->v[i] = alu_flag(batch->flags[i], ALU_FLAG_V);
+        }
+    }
+}
+
+static void lanes_free(Lanes *L)
+{
+    free(L->z);
+    free(L->n);
+    free(L->c);
+    free(L->v);
+    free(L->mask);
+    free(L->pc);
+    free(L->steps);
+    free(L->last_dst);
+    free(L->status);
+}
+
+static void lane_get_flags(const Lanes *L, size_t i, ALUFlags *f)
+{
+    f->nzcv = alu_nzcv(L->n[i], L->z[i], L->c[i], L->v[i]);
+}
+
+static void lane_set_flags(Lanes *L, size_t i, const ALUFlags *f)
+{
+    L->z[i] = alu_flag(*f, ALU_FLAG_Z);
+    L->n[i] = alu_flag(*f, ALU_FLAG_N);
+    L->c[i] = alu_flag(*f, ALU_FLAG_C);
+    L->v[i] = alu_flag(*f, ALU_FLAG_V);
+}
+
+/* Lane i faulted (the message is printed): out of the step and parked. */
+static void lane_fault(Lanes *L, size_t i)
+{
+    L->status[i] = -1;
+    L->mask[i]   = 0;
+    L->pc[i]     = L->halt;
+}
+
+/* ── Kernels ──────────────────────────────────────────────────────────────── */
+
+/* R[dst] = imm for the masked lanes. */
+static void batch_load_const(Lanes *L, word_t *d, word_t imm)
+{
+    size_t i = 0;
+#if BATCH_VEC > 1
+    vec_t k = V_SET1(imm);
+    for (; i + BATCH_VEC <= L->lanes; i += BATCH_VEC) {
+        vec_t m = V_LOAD(&L->mask[i]);
+        V_STORE(&d[i], V_BLEND(m, k, V_LOAD(&d[i])));
+    }
+#endif
+    for (; i < L->lanes; i++)
+        if (L->mask[i])
+            d[i] = imm;
+}
+
+/*
+ * ADD (sub=0), SUB or CMP (sub=1) for the masked lanes; `write` is 0 for
+ * CMP.  The vector path computes the same Z/N/C/V as the ripple adder
+ * (C is "no borrow" for SUB/CMP); the scalar tail calls the ALU itself.
+ */
+static void batch_addsub(Lanes *L, word_t *d, const word_t *s, int sub,
+                         int write)
+{
+    size_t i = 0;
+#if BATCH_VEC > 1
+    const vec_t one  = V_SET1(1u);
+    const vec_t bias = V_SET1(0x80000000u);
+    const vec_t zero = V_SET1(0u);
+
+    for (; i + BATCH_VEC <= L->lanes; i += BATCH_VEC) {
+        vec_t m = V_LOAD(&L->mask[i]);
+        vec_t a = V_LOAD(&d[i]);
+        vec_t b = V_LOAD(&s[i]);
+        vec_t r, c, v;
+
+        if (sub) {
+            r = V_SUB(a, b);
+            c = V_ANDNOT(V_ULT(a, b, bias), one);
+            v = V_SRL31(V_AND(V_XOR(a, b), V_XOR(a, r)));
+        } else {
+            r = V_ADD(a, b);
+            c = V_AND(V_ULT(r, a, bias), one);
+            v = V_SRL31(V_AND(V_XOR(a, r), V_XOR(b, r)));
+        }
+        vec_t z = V_AND(V_CMPEQ(r, zero), one);
+        vec_t n = V_SRL31(r);
+
+        V_STORE(&L->z[i], V_BLEND(m, z, V_LOAD(&L->z[i])));
+        V_STORE(&L->n[i], V_BLEND(m, n, V_LOAD(&L->n[i])));
+        V_STORE(&L->c[i], V_BLEND(m, c, V_LOAD(&L->c[i])));
+        V_STORE(&L->v[i], V_BLEND(m, v, V_LOAD(&L->v[i])));
+        if (write)
+            V_STORE(&d[i], V_BLEND(m, r, a));
+    }
+#endif
+    for (; i < L->lanes; i++) {
+        if (!L->mask[i])
+            continue;
+        ALUFlags f;
+        word_t   r = sub ? alu_sub(d[i], s[i], &f) : alu_add(d[i], s[i], &f);
+        lane_set_flags(L, i, &f);
+        if (write)
+            d[i] = r;
+    }
+}
+
+/* MUL (or DIV) for the masked lanes; a zero divisor faults that lane. */
+static void batch_muldiv(Lanes *L, word_t *d, const word_t *s, int div,
+                         int src, size_t pc)
+{
+    for (size_t i = 0; i < L->lanes; i++) {
+        if (!L->mask[i])
+            continue;
+        if (div && s[i] == 0u) {
+            cpu_report_div_zero(src, pc);
+            lane_fault(L, i);
+            continue;
+        }
+        ALUFlags f;
+        d[i] = div ? alu_div(d[i], s[i], &f) : alu_mul(d[i], s[i], &f);
+        lane_set_flags(L, i, &f);
+    }
+}
+
+/*
+ * SDIV, SREM or UREM for the masked lanes; a zero divisor, or SDIV's
+ * WORD_SMIN / -1, faults that lane.
+ */
+static void batch_divide(Lanes *L, IROpcode op, word_t *d, const word_t *s,
+                         const IRInstr *in, size_t pc)
+{
+    for (size_t i = 0; i < L->lanes; i++) {
+        if (!L->mask[i])
+            continue;
+        if (s[i] == 0u) {
+            cpu_report_div_zero(in->src, pc);
+            lane_fault(L, i);
+            continue;
+        }
+        if (op == IR_SDIV && d[i] == WORD_SMIN && s[i] == WORD_MAX) {
+            cpu_report_div_overflow(in->dst, in->src, pc);
+            lane_fault(L, i);
+            continue;
+        }
+        ALUFlags f;
+        d[i] = op == IR_SDIV ? alu_sdiv(d[i], s[i], &f)
+             : op == IR_SREM ? alu_srem(d[i], s[i], &f)
+                             : alu_urem(d[i], s[i], &f);
+        lane_set_flags(L, i, &f);
+    }
+}
+
+/*
+ * UMULL/SMULL (low word to d, high word to hi, hi last) or MLA
+ * (d += s * hi) for the masked lanes.
+ */
+static void batch_mul_long(Lanes *L, IROpcode op, word_t *d, const word_t *s,
+                           word_t *hi)
+{
+    for (size_t i = 0; i < L->lanes; i++) {
+        if (!L->mask[i])
+            continue;
+        ALUFlags f;
+        if (op == IR_MLA) {
+            d[i] = alu_mla(d[i], s[i], hi[i], &f);
+        } else {
+            word_t h;
+            d[i]  = op == IR_SMULL ? alu_smull(d[i], s[i], &h, &f)
+                                   : alu_umull(d[i], s[i], &h, &f);
+            hi[i] = h;
+        }
+        lane_set_flags(L, i, &f);
+    }
+}
+
+/*
+ * AND .. ROR for the masked lanes.  These update Z and N and keep V (C is
+ * kept by AND/OR/XOR/NOT), so the vector path covers the bitwise three:
+ * two flag rows blended, two untouched.  The rest go through the ALU.
+ */
+static void batch_logic(Lanes *L, IROpcode op, word_t *d, const word_t *s)
+{
+    size_t i = 0;
+#if BATCH_VEC > 1
+    if (op == IR_AND || op == IR_OR || op == IR_XOR) {
+        const vec_t one  = V_SET1(1u);
+        const vec_t zero = V_SET1(0u);
+
+        for (; i + BATCH_VEC <= L->lanes; i += BATCH_VEC) {
+            vec_t m = V_LOAD(&L->mask[i]);
+            vec_t a = V_LOAD(&d[i]);
+            vec_t b = V_LOAD(&s[i]);
+            vec_t r = op == IR_AND ? V_AND(a, b)
+                    : op == IR_OR  ? V_OR(a, b) : V_XOR(a, b);
+
+            V_STORE(&L->z[i], V_BLEND(m, V_AND(V_CMPEQ(r, zero), one),
+                                      V_LOAD(&L->z[i])));
+            V_STORE(&L->n[i], V_BLEND(m, V_SRL31(r), V_LOAD(&L->n[i])));
+            V_STORE(&d[i], V_BLEND(m, r, a));
+        }
+    }
+#endif
+    for (; i < L->lanes; i++) {
+        if (!L->mask[i])
+            continue;
+        ALUFlags f;
+        lane_get_flags(L, i, &f);
+        d[i] = cpu_logic(op, d[i], s[i], &f);
+        lane_set_flags(L, i, &f);
+    }
+}
+
+static void batch_set_last(Lanes *L, int dst)
+{
+    size_t i = 0;
+#if BATCH_VEC > 1
+    vec_t k = V_SET1((uint32_t)dst);
+    for (; i + BATCH_VEC <= L->lanes; i += BATCH_VEC) {
+        vec_t m = V_LOAD(&L->mask[i]);
+        V_STORE(&L->last_dst[i], V_BLEND(m, k, V_LOAD(&L->last_dst[i])));
+    }
+#endif
+    for (; i < L->lanes; i++)
+        if (L->mask[i])
+            L->last_dst[i] = dst;
+}
+
+/*
+ * pc = taken for the masked lanes whose Z equals `want`, `next` for the
+ * other masked lanes.  A plain advance is want = 2 (never equal).
+ */
+static void batch_set_pc(Lanes *L, uint32_t want, uint32_t taken,
+                         uint32_t next)
+{
+    size_t i = 0;
+#if BATCH_VEC > 1
+    vec_t w = V_SET1(want), t = V_SET1(taken), x = V_SET1(next);
+    for (; i + BATCH_VEC <= L->lanes; i += BATCH_VEC) {
+        vec_t m  = V_LOAD(&L->mask[i]);
+        vec_t to = V_BLEND(V_CMPEQ(V_LOAD(&L->z[i]), w), t, x);
+        V_STORE(&L->pc[i], V_BLEND(m, to, V_LOAD(&L->pc[i])));
+    }
+#endif
+    for (; i < L->lanes; i++)
+        if (L->mask[i])
+            L->pc[i] = L->z[i] == want ? taken : next;
+}
+
+/* ── Step ─────────────────────────────────────────────────────────────────── */
+
+/* Execute the instruction at `pc` for the masked lanes and advance them. */
+static void batch_step(Lanes *L, const IRProgram *prog, uint32_t pc,
+                       Memory *const *mems)
+{
+    const IRInstr *in   = &prog->data[pc];
+    IROpcode       op   = ir_opcode_unfused(in->op);  /* partner runs next */
+    uint32_t       next = pc + 1;
+
+    switch (op) {
+        case IR_LOAD_CONST:
+            batch_load_const(L, ROW(L, in->dst), (word_t)in->imm);
+            batch_set_last(L, in->dst);
+            break;
+
+        case IR_ADD:
+        case IR_SUB:
+            batch_addsub(L, ROW(L, in->dst), ROW(L, in->src),
+                         op == IR_SUB, 1);
+            batch_set_last(L, in->dst);
+            break;
+
+        case IR_CMP:
+            batch_addsub(L, ROW(L, in->dst), ROW(L, in->src), 1, 0);
+            break;
+
+        case IR_MUL:
+        case IR_DIV:
+            batch_muldiv(L, ROW(L, in->dst), ROW(L, in->src),
+                         op == IR_DIV, in->src, pc);
+            batch_set_last(L, in->dst);
+            break;
+
+        case IR_AND:
+        case IR_OR:
+        case IR_XOR:
+        case IR_NOT:
+        case IR_SHL:
+        case IR_LSR:
+        case IR_ASR:
+        case IR_ROR:
+            batch_logic(L, op, ROW(L, in->dst), ROW(L, in->src));
+            batch_set_last(L, in->dst);
+            break;
+
+        case IR_SDIV:
+        case IR_SREM:
+        case IR_UREM:
+            batch_divide(L, op, ROW(L, in->dst), ROW(L, in->src), in, pc);
+            batch_set_last(L, in->dst);
+            break;
+
+        case IR_UMULL:
+        case IR_SMULL:
+        case IR_MLA:
+            batch_mul_long(L, op, ROW(L, in->dst), ROW(L, in->src),
+                           ROW(L, in->addr));
+            batch_set_last(L, in->dst);
+            break;
+
+        case IR_JMP:
+            next = (uint32_t)in->target;
+            break;
+
+        case IR_JZ:
+        case IR_JNZ:
+            /* The only divergence point: each lane picks its own pc. */
+            batch_set_pc(L, op == IR_JZ, (uint32_t)in->target, next);
+            return;
+
+        case IR_LOAD: {
+            word_t *d = ROW(L, in->dst);
+            word_t *a = ROW(L, in->addr);
+            for (size_t i = 0; i < L->lanes; i++) {
+                word_t value;
+                if (!L->mask[i])
+                    continue;
+                if (mem_read_word(mems[i], a[i], &value) != 0)
+                    lane_fault(L, i);
+                else
+                    d[i] = value;
+            }
+            batch_set_last(L, in->dst);
+            break;
+        }
+
+        case IR_STORE: {
+            word_t *s = ROW(L, in->src);
+            word_t *a = ROW(L, in->addr);
+            for (size_t i = 0; i < L->lanes; i++)
+                if (L->mask[i] && mem_write_word(mems[i], a[i], s[i]) != 0)
+                    lane_fault(L, i);
+            break;
+        }
+
+        default:
+            /* Unreachable for a verified program. */
+            for (size_t i = 0; i < L->lanes; i++) {
+                if (L->mask[i]) {
+                    cpu_report_bad_opcode((int)in->op, pc);
+                    lane_fault(L, i);
+                }
+            }
+            return;
+    }
+
+    batch_set_pc(L, 2, 0, next);
+}
+
+/* ── Scheduling ───────────────────────────────────────────────────────────── */
+
+/* Lowest pc of any lane: L->halt once every lane has halted or faulted. */
+static uint32_t batch_lowest_pc(const Lanes *L)
+{
+    uint32_t pc = L->halt;
+    size_t   i  = 0;
+#if BATCH_VEC > 1
+    /* pcs never exceed BATCH_MAX_PC, so signed compares do. */
+    vec_t lo = V_SET1(pc);
+    for (; i + BATCH_VEC <= L->lanes; i += BATCH_VEC) {
+        vec_t p = V_LOAD(&L->pc[i]);
+        lo = V_BLEND(V_CMPGT(lo, p), p, lo);
+    }
+    uint32_t part[BATCH_VEC];
+    V_STORE(part, lo);
+    for (size_t k = 0; k < BATCH_VEC; k++)
+        if (part[k] < pc)
+            pc = part[k];
+#endif
+    for (; i < L->lanes; i++)
+        if (L->pc[i] < pc)
+            pc = L->pc[i];
+    return pc;
+}
+
+/*
+ * mask = the lanes at `pc`, each charged one step; a lane over max_steps
+ * faults instead.  Returns whether any lane is left in the mask.
+ */
+static int batch_mask(Lanes *L, uint32_t pc, uint32_t max_steps)
+{
+    int    active = 0;
+    size_t i      = 0;
+#if BATCH_VEC > 1
+    vec_t at  = V_SET1(pc);
+    vec_t max = V_SET1(max_steps);
+    for (; i + BATCH_VEC <= L->lanes; i += BATCH_VEC) {
+        vec_t m     = V_CMPEQ(V_LOAD(&L->pc[i]), at);
+        vec_t steps = V_SUB(V_LOAD(&L->steps[i]), m);   /* m is 0 or -1 */
+        vec_t over  = V_AND(m, V_CMPGT(steps, max));
+        V_STORE(&L->steps[i], steps);
+        V_STORE(&L->mask[i], V_ANDNOT(over, m));
+        active |= V_ANY(V_ANDNOT(over, m));
+        if (V_ANY(over)) {
+            for (size_t k = i; k < i + BATCH_VEC; k++) {
+                if (L->pc[k] == pc && L->steps[k] > max_steps) {
+                    cpu_report_step_limit(max_steps, pc);
+                    lane_fault(L, k);
+                }
+            }
+        }
+    }
+#endif
+    for (; i < L->lanes; i++) {
+        L->mask[i] = 0;
+        if (L->pc[i] != pc)
+            continue;
+        if (++L->steps[i] > max_steps) {
+            cpu_report_step_limit(max_steps, pc);
+            lane_fault(L, i);
+        } else {
+            L->mask[i] = ~0u;
+            active     = 1;
+        }
+    }
+    return active;
+}
+
+/* ── Entry point ──────────────────────────────────────────────────────────── */
+
+static int batch_refuse(CPUBatch *batch)
+{
+    if (batch->status)
+        for (size_t i = 0; i < batch->lanes; i++)
+            batch->status[i] = -1;
+    return -1;
+}
+
+int cpu_execute_batch(const IRProgram *prog, CPUBatch *batch,
+                      size_t max_steps)
+{
+    if (!prog || prog->count == 0) {
+        fprintf(stderr, "cpu error: empty program\n");
+        return batch_refuse(batch);
+    }
+    if (!prog->verified) {
+        fprintf(stderr, "cpu error: program has not been verified "
+                        "(call ir_program_verify first)\n");
+        return batch_refuse(batch);
+    }
+    if (prog->uses_memory) {
+        int attached = batch->mems != NULL;
+        for (size_t i = 0; attached && i < batch->lanes; i++)
+            attached = batch->mems[i] != NULL;
+        if (!attached) {
+            fprintf(stderr, "cpu error: program uses LOAD/STORE but no "
+                            "memory was attached to every lane\n");
+            return batch_refuse(batch);
+        }
+    }
+    if (prog->count > BATCH_MAX_PC) {
+        fprintf(stderr, "cpu error: program of %zu instructions is too "
+                        "long for a batch\n", prog->count);
+        return batch_refuse(batch);
+    }
+    if (batch->lanes == 0)
+        return 0;
+    if (max_steps == 0)
+        max_steps = CPU_MAX_STEPS;
+    if (max_steps > BATCH_MAX_STEPS)
+        max_steps = BATCH_MAX_STEPS;
+
+    Lanes L;
+    lanes_init(&L, batch, (uint32_t)prog->count);
+
+    for (;;) {
+        /* 1. The lowest pc; every lane past the end has halted. */
+        uint32_t pc = batch_lowest_pc(&L);
+        if (pc == L.halt)
+            break;
+
+        /* 2-3. Active mask, charging each lane one step; execute. */
+        if (batch_mask(&L, pc, (uint32_t)max_steps))
+            batch_step(&L, prog, pc, batch->mems);
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < L.lanes; i++) {
+        if (batch->flags)
+            lane_get_flags(&L, i, &batch->flags[i]);
+        if (batch->status)
+            batch->status[i] = L.status[i];
+        if (batch->results && L.status[i] == 0)
+            batch->results[i] =
+                (long)(sword_t)ROW(&L, L.last_dst[i])[i];
+        failed |= L.status[i] != 0;
+    }
+
+    lanes_free(&L);
+    return failed ? -1 : 0;
+}
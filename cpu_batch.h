@@ -0,0 +1,54 @@
+#ifndef CPU_BATCH_H
+#define CPU_BATCH_H
+
+#include "cpu.h"
+
+/*
+ * Batch execution — one verified IRProgram over many independent register
+ * files ("lanes") in lockstep.
+ *
+ * Registers are stored struct-of-arrays: register r of lane i lives at
+ * regs[r * lanes + i], so each instruction reads and writes one contiguous
+ * row per operand.  On the 32-bit machine, LOAD_CONST, ADD, SUB, CMP, AND,
+ * OR and XOR (including flags) run 8 lanes per host instruction with AVX2
+ * or 4 with SSE2, and a scalar loop finishes the remaining lanes; the other
+ * opcodes, and every opcode at other word widths, loop over lanes.  The
+ * scheduling between instructions (lowest pc, active mask, step counts,
+ * branches) uses the same vectors.  AVX2 is used when the build targets it
+ * (make SIMD=avx2).
+ *
+ * Lanes may diverge at conditional branches.  Each step executes the
+ * instruction at the lowest pc of any live lane, for exactly the lanes
+ * whose pc equals it (the active mask).  Lanes ahead of it wait, so
+ * divergent paths reconverge at the first pc they share again (the end of
+ * an if/else, a loop exit).
+ *
+ * Every lane behaves exactly like cpu_execute_verified with in_state set to
+ * that lane's initial registers and flags: same results, flags, memory
+ * effects and step limit, and the same error messages on stderr.  A lane
+ * that faults (division by zero, bad address, step limit) stops with
+ * status -1 while the others run on; its registers are left as they were
+ * at the fault.
+ */
+
+typedef struct {
+    size_t    lanes;
+    word_t   *regs;     /* [CPU_MAX_REGS * lanes]  in: initial, out: final */
+    ALUFlags *flags;    /* [lanes] in: initial, out: final; NULL = zeroed  */
+    long     *results;  /* [lanes] out: as *out_result; may be NULL        */
+    int      *status;   /* [lanes] out: 0 ok, -1 error; may be NULL        */
+    Memory  **mems;     /* [lanes] per-lane RAM; NULL if no LOAD/STORE     */
+} CPUBatch;
+
+/*
+ * Run `prog` (which must have passed ir_program_verify) over every lane of
+ * `batch`.  max_steps is the per-lane step limit; 0 selects CPU_MAX_STEPS,
+ * and limits past INT32_MAX - 1 are clamped to it.
+ *
+ * Returns 0 if every lane halted normally, -1 if any lane faulted or the
+ * batch was refused (unverified program, or LOAD/STORE without memory).
+ */
+int cpu_execute_batch(const IRProgram *prog, CPUBatch *batch,
+                      size_t max_steps);
+
+#endif /* CPU_BATCH_H */
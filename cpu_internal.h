@@ -0,0 +1,56 @@
+#ifndef CPU_INTERNAL_H
+#define CPU_INTERNAL_H
+
+#include "cpu.h"
+
+/*
+ * Helpers shared by the interpreter cores (cpu.c, cpu_threaded.c).
+ * Not part of the public CPU interface.
+ */
+
+/* Validation — print the canonical "cpu error: ..." message on failure. */
+int cpu_check_reg(int r, const char *role, size_t pc);
+int cpu_check_target(int target, size_t prog_count, size_t pc);
+
+/* Runtime error reports — print the canonical message and return -1. */
+int cpu_report_step_limit(size_t max_steps, size_t pc);
+int cpu_report_div_zero(int src, size_t pc);
+int cpu_report_div_overflow(int dst, int src, size_t pc);
+int cpu_report_no_mem(IROpcode op, size_t pc);
+int cpu_report_bad_opcode(int op, size_t pc);
+
+/*
+ * R[dst] <op> R[src] for the logical and shift opcodes (IR_AND .. IR_ROR),
+ * given a = R[dst], b = R[src].  Updates *f in place (see alu.h).
+ */
+word_t cpu_logic(IROpcode op, word_t a, word_t b, ALUFlags *f);
+
+/* Zero `cpu`, attach `mem`, then load registers and flags from in_state. */
+void cpu_init_state(CPU *cpu, Memory *mem, const CPU *in_state);
+
+/*
+ * Build a TraceEvent for the instruction at cpu->pc and emit it.  `lazy` is
+ * the core's pending flag record (see alu.h); the event carries cpu->flags
+ * with it applied.  Taking its address keeps the record in memory: held in
+ * registers it becomes a merge point in every handler and GCC folds the
+ * threaded core's dispatch back into one indirect jump.
+ */
+void cpu_trace_instr(const TraceSink *trace, const CPU *cpu,
+                     const ALULazyFlags *lazy, const IRInstr *in,
+                     word_t value, uint32_t mem_addr, int taken);
+
+/*
+ * Direct-threaded core (cpu_threaded.c).  cpu_threaded_prepare predecodes
+ * `prog` into a handler stream that refers to no CPU or Memory, so it can
+ * be run any number of times, from any thread, until cpu_threaded_free.
+ * cpu_run_threaded has the same contract as the switch core.
+ */
+typedef struct ThreadedCode ThreadedCode;
+
+ThreadedCode *cpu_threaded_prepare(const IRProgram *prog);
+void cpu_threaded_free(ThreadedCode *tc);
+int cpu_run_threaded(const ThreadedCode *tc, Memory *mem, long *out_result,
+                     const TraceSink *trace, size_t max_steps,
+                     const CPU *in_state, CPU *out_state);
+
+#endif /* CPU_INTERNAL_H */
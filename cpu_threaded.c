@@ -0,0 +1,683 @@
+/*
+ * cpu_threaded.c — direct-threaded interpreter core.
+ *
+ * The switch core (cpu.c) re-decodes the fat IRInstr on every step: it
+ * loads the opcode, range-checks each register index, indexes the register
+ * file and validates jump targets.  This core does all of that once:
+ *
+ *   1. Predecode — each IRInstr becomes a TInsn holding its handler, its
+ *      range-checked register indices, the truncated immediate and a
+ *      pointer to the jump-target TInsn.  A HALT sentinel follows the
+ *      last instruction, so "jump to prog->count" and falling off the end
+ *      need no per-step pc test.  The stream refers to no CPU or Memory,
+ *      so one predecode (cpu_prepare) serves any number of runs.
+ *   2. Dispatch — every handler ends by jumping directly to the next
+ *      handler's address (GCC labels-as-values).  Without GNU C the same
+ *      handler bodies are compiled as the cases of a switch.
+ *
+ * Statically invalid instructions (bad register, bad jump target, unknown
+ * opcode) are predecoded into fault handlers that print exactly what the
+ * switch core would print, when — and only if — execution reaches them.
+ * LOAD/STORE with no memory attached take the same path at run time.
+ */
+
+#include "cpu_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Build with -DCPU_DIRECT_THREADING=0 to force the portable switch. */
+#ifndef CPU_DIRECT_THREADING
+#  if defined(__GNUC__)
+#    define CPU_DIRECT_THREADING 1
+#  else
+#    define CPU_DIRECT_THREADING 0
+#  endif
+#endif
+
+/*
+ * The handler addresses in a predecoded stream belong to one copy of the
+ * dispatch function, so it must never be inlined or cloned.
+ */
+#if CPU_DIRECT_THREADING && defined(__clang__)
+#  define DISPATCH_FN __attribute__((noinline))
+#elif CPU_DIRECT_THREADING
+#  define DISPATCH_FN __attribute__((noinline, noclone))
+#else
+#  define DISPATCH_FN
+#endif
+
+/* ── Predecoded instruction stream ────────────────────────────────────────── */
+
+typedef enum {
+    T_LOAD_CONST,
+    T_ADD,
+    T_SUB,
+    T_MUL,
+    T_DIV,
+    T_CMP,
+    T_JMP,
+    T_JZ,
+    T_JNZ,
+    T_LOAD,
+    T_STORE,
+    T_AND,
+    T_OR,
+    T_XOR,
+    T_NOT,
+    T_SHL,
+    T_LSR,
+    T_ASR,
+    T_ROR,
+    T_SDIV,
+    T_SREM,
+    T_UREM,
+    T_UMULL,
+    T_SMULL,
+    T_MLA,
+    T_HALT,       /* sentinel after the last instruction                    */
+    T_FAULT,      /* statically invalid: report when reached                */
+    T_JZ_FAULT,   /* JZ with an invalid target: faults only if taken        */
+    T_JNZ_FAULT,  /* JNZ with an invalid target: faults only if taken       */
+    T_COUNT
+} THandler;
+
+typedef struct TInsn TInsn;
+
+struct TInsn {
+#if CPU_DIRECT_THREADING
+    const void    *handler; /* label address of the handler                 */
+#endif
+    THandler       kind;    /* handler index (switch dispatch, predecode)   */
+    uint8_t        dst;     /* register operands, checked < CPU_MAX_REGS    */
+    uint8_t        src;
+    uint8_t        addr;
+    word_t         imm;     /* LOAD_CONST immediate, already truncated      */
+    const TInsn   *target;  /* resolved jump target                         */
+    const IRInstr *in;      /* original instruction (traces, fault reports) */
+};
+
+struct ThreadedCode {
+    const IRProgram *prog;
+    TInsn            code[]; /* prog->count instructions, then HALT        */
+};
+
+static int reg_ok(int r)
+{
+    return r >= 0 && r < CPU_MAX_REGS;
+}
+
+/*
+ * Translate prog into code[0..count]; code[count] is the HALT sentinel.
+ * Handler addresses are filled in by cpu_threaded_prepare.
+ */
+static void predecode(TInsn *code, const IRProgram *prog)
+{
+    for (size_t i = 0; i < prog->count; i++) {
+        const IRInstr *in = &prog->data[i];
+        TInsn         *t  = &code[i];
+
+        memset(t, 0, sizeof(*t));
+        t->in   = in;
+        t->kind = T_FAULT;
+
+        /* Superinstructions are predecoded as their first instruction. */
+        IROpcode op = ir_opcode_unfused(in->op);
+
+        switch (op) {
+            case IR_LOAD_CONST:
+                if (reg_ok(in->dst)) {
+                    t->kind = T_LOAD_CONST;
+                    t->dst  = (uint8_t)in->dst;
+                    t->imm  = (word_t)in->imm;
+                }
+                break;
+
+            case IR_ADD:
+            case IR_SUB:
+            case IR_MUL:
+            case IR_DIV:
+            case IR_CMP:
+                if (reg_ok(in->dst) && reg_ok(in->src)) {
+                    t->kind = (THandler)(T_ADD + (op - IR_ADD));
+                    t->dst  = (uint8_t)in->dst;
+                    t->src  = (uint8_t)in->src;
+                }
+                break;
+
+            case IR_JMP:
+            case IR_JZ:
+            case IR_JNZ: {
+                int valid = in->target >= 0
+                         && (size_t)in->target <= prog->count;
+                if (valid) {
+                    t->kind   = (THandler)(T_JMP + (op - IR_JMP));
+                    t->target = &code[in->target];
+                } else if (op == IR_JZ) {
+                    t->kind = T_JZ_FAULT;
+                } else if (op == IR_JNZ) {
+                    t->kind = T_JNZ_FAULT;
+                }
+                break;
+            }
+
+            case IR_AND:
+            case IR_OR:
+            case IR_XOR:
+            case IR_NOT:
+            case IR_SHL:
+            case IR_LSR:
+            case IR_ASR:
+            case IR_ROR:
+                if (reg_ok(in->dst) && reg_ok(in->src)) {
+                    t->kind = (THandler)(T_AND + (op - IR_AND));
+                    t->dst  = (uint8_t)in->dst;
+                    t->src  = (uint8_t)in->src;
+                }
+                break;
+
+            case IR_SDIV:
+            case IR_SREM:
+            case IR_UREM:
+                if (reg_ok(in->dst) && reg_ok(in->src)) {
+                    t->kind = (THandler)(T_SDIV + (op - IR_SDIV));
+                    t->dst  = (uint8_t)in->dst;
+                    t->src  = (uint8_t)in->src;
+                }
+                break;
+
+            case IR_UMULL:
+            case IR_SMULL:
+            case IR_MLA:
+                if (reg_ok(in->dst) && reg_ok(in->src) && reg_ok(in->addr)) {
+                    t->kind = (THandler)(T_UMULL + (op - IR_UMULL));
+                    t->dst  = (uint8_t)in->dst;
+                    t->src  = (uint8_t)in->src;
+                    t->addr = (uint8_t)in->addr;
+                }
+                break;
+
+            case IR_LOAD:
+                if (reg_ok(in->dst) && reg_ok(in->addr)) {
+                    t->kind = T_LOAD;
+                    t->dst  = (uint8_t)in->dst;
+                    t->addr = (uint8_t)in->addr;
+                }
+                break;
+
+            case IR_STORE:
+                if (reg_ok(in->src) && reg_ok(in->addr)) {
+                    t->kind = T_STORE;
+                    t->src  = (uint8_t)in->src;
+                    t->addr = (uint8_t)in->addr;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    memset(&code[prog->count], 0, sizeof(TInsn));
+    code[prog->count].kind = T_HALT;
+}
+
+/*
+ * Report why a T_FAULT instruction is invalid, replaying the switch core's
+ * checks in the same order so the first failing check prints.
+ */
+static int report_fault(const IRInstr *in, size_t prog_count, size_t pc,
+                        const Memory *mem)
+{
+    IROpcode op = ir_opcode_unfused(in->op);
+
+    switch (op) {
+        case IR_LOAD_CONST:
+            return cpu_check_reg(in->dst, "dst", pc);
+
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_CMP:
+        case IR_AND:
+        case IR_OR:
+        case IR_XOR:
+        case IR_NOT:
+        case IR_SHL:
+        case IR_LSR:
+        case IR_ASR:
+        case IR_ROR:
+        case IR_SDIV:
+        case IR_SREM:
+        case IR_UREM:
+            if (cpu_check_reg(in->dst, "dst", pc) != 0) return -1;
+            return cpu_check_reg(in->src, "src", pc);
+
+        case IR_UMULL:
+        case IR_SMULL:
+        case IR_MLA:
+            if (cpu_check_reg(in->dst, "dst", pc) != 0) return -1;
+            if (cpu_check_reg(in->src, "src", pc) != 0) return -1;
+            return cpu_check_reg(in->addr, "addr", pc);
+
+        case IR_JMP:
+        case IR_JZ:
+        case IR_JNZ:
+            return cpu_check_target(in->target, prog_count, pc);
+
+        case IR_LOAD:
+            if (cpu_check_reg(in->dst,  "dst",  pc) != 0) return -1;
+            if (cpu_check_reg(in->addr, "addr", pc) != 0) return -1;
+            if (!mem) return cpu_report_no_mem(op, pc);
+            return -1;
+
+        case IR_STORE:
+            if (cpu_check_reg(in->src,  "src",  pc) != 0) return -1;
+            if (cpu_check_reg(in->addr, "addr", pc) != 0) return -1;
+            if (!mem) return cpu_report_no_mem(op, pc);
+            return -1;
+
+        default:
+            break;
+    }
+    return cpu_report_bad_opcode((int)in->op, pc);
+}
+
+/* ── Dispatch ─────────────────────────────────────────────────────────────── */
+
+#if CPU_DIRECT_THREADING
+#  define HANDLER(k)  L_##k:
+#  define NEXT()      goto *ip->handler
+#else
+#  define HANDLER(k)  case k:
+#  define NEXT()      continue
+#endif
+
+/* Register operand `field` of the current instruction. */
+#define R(field) cpu.regs[ip->field]
+
+/* Every real instruction counts one step against the loop guard. */
+#define STEP()                                                            \
+    do { if (++steps > max_steps) goto step_limit; } while (0)
+
+/* Emit a trace event for the instruction at ip (only if a sink is set). */
+#define TRACE(value, mem_addr, taken)                                     \
+    do {                                                                  \
+        if (trace) {                                                      \
+            cpu.pc = (size_t)(ip - code);                                 \
+            cpu_trace_instr(trace, &cpu, &lazy, ip->in, (value),          \
+                            (mem_addr), (taken));                         \
+        }                                                                 \
+    } while (0)
+
+/*
+ * Two-operand ALU handler body: R[dst] = R[dst] <op> R[src], with the
+ * flags recorded lazily (see cpu.c's run_switch).
+ * Not wrapped in do/while: NEXT() may be `continue` (switch dispatch).
+ */
+#define ALU_OP(fn)                                                        \
+    STEP();                                                               \
+    R(dst) = fn(R(dst), R(src), &lazy);                                   \
+    TRACE(R(dst), 0, 0);                                                  \
+    last = &R(dst);                                                       \
+    ip++;                                                                 \
+    NEXT()
+
+/*
+ * Logical/shift handler body: these update the flags in place (C and V
+ * survive), so any pending lazy flags are materialised first.
+ */
+#define LOGIC_OP(fn)                                                      \
+    STEP();                                                               \
+    alu_lazy_flush(&lazy, &cpu.flags);                                    \
+    R(dst) = fn(R(dst), R(src), &cpu.flags);                              \
+    TRACE(R(dst), 0, 0);                                                  \
+    last = &R(dst);                                                       \
+    ip++;                                                                 \
+    NEXT()
+
+#if CPU_DIRECT_THREADING
+/* Labels-as-values and computed goto are GNU extensions. */
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+/*
+ * The dispatch loop.  Called with `labels` set (and nothing else), it
+ * only hands out its handler table for cpu_threaded_prepare.
+ */
+static DISPATCH_FN int dispatch(const ThreadedCode *tc, Memory *mem,
+                                long *out_result, const TraceSink *trace,
+                                size_t max_steps, const CPU *in_state,
+                                CPU *out_state,
+                                const void *const **labels)
+{
+#if CPU_DIRECT_THREADING
+    static const void *const handlers[T_COUNT] = {
+        [T_LOAD_CONST] = &&L_T_LOAD_CONST,
+        [T_ADD]        = &&L_T_ADD,
+        [T_SUB]        = &&L_T_SUB,
+        [T_MUL]        = &&L_T_MUL,
+        [T_DIV]        = &&L_T_DIV,
+        [T_CMP]        = &&L_T_CMP,
+        [T_JMP]        = &&L_T_JMP,
+        [T_JZ]         = &&L_T_JZ,
+        [T_JNZ]        = &&L_T_JNZ,
+        [T_LOAD]       = &&L_T_LOAD,
+        [T_STORE]      = &&L_T_STORE,
+        [T_AND]        = &&L_T_AND,
+        [T_OR]         = &&L_T_OR,
+        [T_XOR]        = &&L_T_XOR,
+        [T_NOT]        = &&L_T_NOT,
+        [T_SHL]        = &&L_T_SHL,
+        [T_LSR]        = &&L_T_LSR,
+        [T_ASR]        = &&L_T_ASR,
+        [T_ROR]        = &&L_T_ROR,
+        [T_SDIV]       = &&L_T_SDIV,
+        [T_SREM]       = &&L_T_SREM,
+        [T_UREM]       = &&L_T_UREM,
+        [T_UMULL]      = &&L_T_UMULL,
+        [T_SMULL]      = &&L_T_SMULL,
+        [T_MLA]        = &&L_T_MLA,
+        [T_HALT]       = &&L_T_HALT,
+        [T_FAULT]      = &&L_T_FAULT,
+        [T_JZ_FAULT]   = &&L_T_JZ_FAULT,
+        [T_JNZ_FAULT]  = &&L_T_JNZ_FAULT,
+    };
+    if (labels) {
+        *labels = handlers;
+        return 0;
+    }
+#else
+    (void)labels;
+#endif
+
+    CPU cpu;
+    cpu_init_state(&cpu, mem, in_state);
+
+    const TInsn *code   = tc->code;
+    const TInsn *ip     = code;
+    word_t      *last   = &cpu.regs[0];  /* last-written register */
+    size_t       steps  = 0;
+    int          status = 0;
+    ALULazyFlags lazy   = { .op = ALU_LAZY_NONE };  /* pending flags */
+
+#if CPU_DIRECT_THREADING
+    NEXT();
+#else
+    for (;;) switch (ip->kind) {
+#endif
+
+    HANDLER(T_LOAD_CONST) {
+        STEP();
+        R(dst) = ip->imm;
+        /* LOAD_CONST does NOT modify flags. */
+        TRACE(R(dst), 0, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_ADD) { ALU_OP(alu_add_lazy); }
+    HANDLER(T_SUB) { ALU_OP(alu_sub_lazy); }
+    HANDLER(T_MUL) { ALU_OP(alu_mul_lazy); }
+
+    HANDLER(T_DIV) {
+        STEP();
+        if (R(src) == 0u) goto div_zero;
+        R(dst) = alu_div_lazy(R(dst), R(src), &lazy);
+        TRACE(R(dst), 0, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_CMP) {
+        STEP();
+        alu_sub_lazy(R(dst), R(src), &lazy);
+        TRACE(0, 0, 0);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_JMP) {
+        STEP();
+        TRACE(0, 0, 1);
+        ip = ip->target;
+        NEXT();
+    }
+
+    HANDLER(T_JZ) {
+        STEP();
+        if (alu_lazy_zero(&lazy, &cpu.flags)) {
+            TRACE(0, 0, 1);
+            ip = ip->target;
+        } else {
+            TRACE(0, 0, 0);
+            ip++;
+        }
+        NEXT();
+    }
+
+    HANDLER(T_JNZ) {
+        STEP();
+        if (!alu_lazy_zero(&lazy, &cpu.flags)) {
+            TRACE(0, 0, 1);
+            ip = ip->target;
+        } else {
+            TRACE(0, 0, 0);
+            ip++;
+        }
+        NEXT();
+    }
+
+    HANDLER(T_LOAD) {
+        STEP();
+        if (!mem) goto fault;
+        word_t addr  = R(addr);
+        word_t value = 0;
+        if (mem_read_word(mem, addr, &value) != 0) {
+            status = -1;
+            goto done;
+        }
+        R(dst) = (word_t)value;
+        TRACE(value, addr, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_STORE) {
+        STEP();
+        if (!mem) goto fault;
+        word_t addr  = R(addr);
+        word_t value = R(src);
+        if (mem_write_word(mem, addr, value) != 0) {
+            status = -1;
+            goto done;
+        }
+        TRACE(value, addr, 0);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_AND) { LOGIC_OP(alu_and); }
+    HANDLER(T_OR)  { LOGIC_OP(alu_or);  }
+    HANDLER(T_XOR) { LOGIC_OP(alu_xor); }
+    HANDLER(T_SHL) { LOGIC_OP(alu_shl); }
+    HANDLER(T_LSR) { LOGIC_OP(alu_lsr); }
+    HANDLER(T_ASR) { LOGIC_OP(alu_asr); }
+    HANDLER(T_ROR) { LOGIC_OP(alu_ror); }
+
+    HANDLER(T_NOT) {
+        STEP();
+        alu_lazy_flush(&lazy, &cpu.flags);
+        R(dst) = alu_not(R(src), &cpu.flags);
+        TRACE(R(dst), 0, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_SDIV) {
+        STEP();
+        if (R(src) == 0u) goto div_zero;
+        if (R(dst) == WORD_SMIN && R(src) == WORD_MAX) {
+            status = cpu_report_div_overflow(ip->in->dst, ip->in->src,
+                                             (size_t)(ip - code));
+            goto done;
+        }
+        R(dst) = alu_sdiv_lazy(R(dst), R(src), &lazy);
+        TRACE(R(dst), 0, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_SREM) {
+        STEP();
+        if (R(src) == 0u) goto div_zero;
+        R(dst) = alu_srem_lazy(R(dst), R(src), &lazy);
+        TRACE(R(dst), 0, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_UREM) {
+        STEP();
+        if (R(src) == 0u) goto div_zero;
+        R(dst) = alu_urem_lazy(R(dst), R(src), &lazy);
+        TRACE(R(dst), 0, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    /* The high word is stored last: it wins if addr == dst. */
+    HANDLER(T_UMULL) {
+        STEP();
+        word_t hi;
+        word_t lo = alu_mull_lazy(R(dst), R(src), &hi, 0, &lazy);
+        R(dst)  = lo;
+        R(addr) = hi;
+        TRACE(lo, 0, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_SMULL) {
+        STEP();
+        word_t hi;
+        word_t lo = alu_mull_lazy(R(dst), R(src), &hi, 1, &lazy);
+        R(dst)  = lo;
+        R(addr) = hi;
+        TRACE(lo, 0, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_MLA) {
+        STEP();
+        R(dst) = alu_mla_lazy(R(dst), R(src), R(addr), &lazy);
+        TRACE(R(dst), 0, 0);
+        last = &R(dst);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_JZ_FAULT) {
+        STEP();
+        if (alu_lazy_zero(&lazy, &cpu.flags)) goto fault;
+        TRACE(0, 0, 0);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_JNZ_FAULT) {
+        STEP();
+        if (!alu_lazy_zero(&lazy, &cpu.flags)) goto fault;
+        TRACE(0, 0, 0);
+        ip++;
+        NEXT();
+    }
+
+    HANDLER(T_FAULT) {
+        STEP();
+        goto fault;
+    }
+
+    HANDLER(T_HALT) {
+        goto done;
+    }
+
+#if !CPU_DIRECT_THREADING
+    case T_COUNT:
+        goto fault;
+    }
+#endif
+
+fault:
+    status = report_fault(ip->in, tc->prog->count, (size_t)(ip - code), mem);
+    goto done;
+
+div_zero:
+    status = cpu_report_div_zero(ip->in->src, (size_t)(ip - code));
+    goto done;
+
+step_limit:
+    status = cpu_report_step_limit(max_steps, (size_t)(ip - code));
+
+done:
+    cpu.pc = (size_t)(ip - code);
+    alu_lazy_resolve(&lazy, &cpu.flags);
+
+    if (status != 0)
+        return status;
+
+    if (out_result)
+        *out_result = (long)(sword_t)*last;
+    if (out_state)
+        *out_state = cpu;
+    return 0;
+}
+
+#if CPU_DIRECT_THREADING
+#  pragma GCC diagnostic pop
+#endif
+
+/* ── Entry points ─────────────────────────────────────────────────────────── */
+
+ThreadedCode *cpu_threaded_prepare(const IRProgram *prog)
+{
+    ThreadedCode *tc = malloc(sizeof(*tc)
+                              + (prog->count + 1) * sizeof(TInsn));
+    if (!tc) { perror("malloc"); exit(EXIT_FAILURE); }
+    tc->prog = prog;
+    predecode(tc->code, prog);
+
+#if CPU_DIRECT_THREADING
+    const void *const *labels = NULL;
+    dispatch(NULL, NULL, NULL, NULL, 0, NULL, NULL, &labels);
+    for (size_t i = 0; i <= prog->count; i++)
+        tc->code[i].handler = labels[tc->code[i].kind];
+#endif
+    return tc;
+}
+
+void cpu_threaded_free(ThreadedCode *tc)
+{
+    free(tc);
+}
+
+int cpu_run_threaded(const ThreadedCode *tc, Memory *mem, long *out_result,
+                     const TraceSink *trace, size_t max_steps,
+                     const CPU *in_state, CPU *out_state)
+{
+    return dispatch(tc, mem, out_result, trace, max_steps, in_state,
+                    out_state, NULL);
+}
@@ -2,6 +2,8 @@
 
 #include <stdio.h>
 
+#include "word.h"
+
 /* ── Internal helpers ─────────────────────────────────────────────────────── */
 
 static EvalResult make_ok(long v)
@@ -21,10 +23,74 @@ static const char *op_label(BinaryOp op)
         case OP_SUB: return "SUB";
         case OP_MUL: return "MUL";
         case OP_DIV: return "DIV";
+        case OP_MOD: return "MOD";
+        case OP_AND: return "AND";
+        case OP_OR:  return "OR";
+        case OP_XOR: return "XOR";
+        case OP_SHL: return "SHL";
+        case OP_ASR: return "ASR";
+        case OP_LSR: return "LSR";
     }
     return "???";
 }
 
+/*
+ * '/' and '%' compile to SDIV and SREM, so they act on the machine word
+ * too: operands truncated to sword_t, quotient rounded toward zero.  The
+ * one quotient a word cannot hold, WORD_SMIN / -1, is an error as on the
+ * CPU; its remainder is 0.
+ */
+static EvalStatus eval_divide(BinaryOp op, long lhs, long rhs, long *out)
+{
+    sword_t a = (sword_t)(word_t)lhs;
+    sword_t b = (sword_t)(word_t)rhs;
+
+    if (b == 0) {
+        fprintf(stderr, "eval error: division by zero\n");
+        return EVAL_ERR_DIV_ZERO;
+    }
+    if (b == -1) {
+        if (op == OP_MOD) {
+            *out = 0;
+            return EVAL_OK;
+        }
+        if ((word_t)a == WORD_SMIN) {
+            fprintf(stderr, "eval error: signed division overflow\n");
+            return EVAL_ERR_OVERFLOW;
+        }
+    }
+    *out = op == OP_DIV ? (long)(a / b) : (long)(a % b);
+    return EVAL_OK;
+}
+
+/*
+ * Shifts act on the machine word so that the evaluator agrees with the
+ * CPU: the amount is the low byte of the rhs, a logical shift by
+ * WORD_BITS or more gives 0, an arithmetic one the sign fill, and the
+ * result is sign-extended back to long.
+ */
+static long eval_shift(BinaryOp op, long lhs, long rhs)
+{
+    word_t   a = (word_t)lhs;
+    unsigned n = (unsigned)((unsigned long)rhs & 0xFFu);
+    word_t   r;
+
+    if (op == OP_SHL)
+        r = n >= WORD_BITS ? 0 : (word_t)(a << n);
+    else if (op == OP_LSR)
+        r = n >= WORD_BITS ? 0 : (word_t)(a >> n);
+    else {
+        word_t fill = (a >> WORD_MSB) ? WORD_MAX : 0;
+        if (n >= WORD_BITS)
+            r = fill;
+        else if (n == 0)
+            r = a;
+        else
+            r = (word_t)((a >> n) | (word_t)(fill << (WORD_BITS - n)));
+    }
+    return (long)(sword_t)r;
+}
+
 /* ── Recursive evaluator ──────────────────────────────────────────────────── */
 
 EvalResult eval(const Node *node)
@@ -70,11 +136,25 @@ EvalResult eval(const Node *node)
                     result = lhs.value * rhs.value;
                     break;
                 case OP_DIV:
-                    if (rhs.value == 0) {
-                        fprintf(stderr, "eval error: division by zero\n");
-                        return make_err(EVAL_ERR_DIV_ZERO);
-                    }
-                    result = lhs.value / rhs.value;
+                case OP_MOD: {
+                    EvalStatus st = eval_divide(node->binary.op, lhs.value,
+                                                rhs.value, &result);
+                    if (st != EVAL_OK) return make_err(st);
+                    break;
+                }
+                case OP_AND:
+                    result = lhs.value & rhs.value;
+                    break;
+                case OP_OR:
+                    result = lhs.value | rhs.value;
+                    break;
+                case OP_XOR:
+                    result = lhs.value ^ rhs.value;
+                    break;
+                case OP_SHL:
+                case OP_ASR:
+                case OP_LSR:
+                    result = eval_shift(node->binary.op, lhs.value, rhs.value);
                     break;
                 default:
                     fprintf(stderr, "eval error: unknown operator\n");
@@ -85,6 +165,15 @@ EvalResult eval(const Node *node)
             printf("%s %ld %ld -> %ld\n", label, lhs.value, rhs.value, result);
             return make_ok(result);
         }
+
+        case NODE_UNARY_OP: {
+            EvalResult operand = eval(node->unary.operand);
+            if (operand.status != EVAL_OK) return make_err(operand.status);
+
+            long result = ~operand.value;   /* OP_NOT is the only one */
+            printf("NOT %ld -> %ld\n", operand.value, result);
+            return make_ok(result);
+        }
     }
 
     fprintf(stderr, "eval error: unknown node type\n");
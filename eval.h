@@ -13,7 +13,7 @@
 typedef enum {
     EVAL_OK = 0,        /* successful evaluation                */
     EVAL_ERR_DIV_ZERO,  /* division by zero detected            */
-    EVAL_ERR_OVERFLOW,  /* arithmetic overflow (future use)     */
+    EVAL_ERR_OVERFLOW,  /* signed division overflow (MIN / -1)  */
     EVAL_ERR_INTERNAL   /* unexpected node type / NULL node     */
 } EvalStatus;
 
@@ -12,16 +12,20 @@ void ir_program_init(IRProgram *prog)
 {
     prog->data     = malloc(IR_INITIAL_CAPACITY * sizeof(IRInstr));
     if (!prog->data) { perror("malloc"); exit(EXIT_FAILURE); }
-    prog->count    = 0;
-    prog->capacity = IR_INITIAL_CAPACITY;
+    prog->count       = 0;
+    prog->capacity    = IR_INITIAL_CAPACITY;
+    prog->verified    = 0;
+    prog->uses_memory = 0;
 }
 
 void ir_program_free(IRProgram *prog)
 {
     free(prog->data);
     prog->data     = NULL;
-    prog->count    = 0;
-    prog->capacity = 0;
+    prog->count       = 0;
+    prog->capacity    = 0;
+    prog->verified    = 0;
+    prog->uses_memory = 0;
 }
 
 /* ── Append ───────────────────────────────────────────────────────────────── */
@@ -36,6 +40,172 @@ void ir_program_append(IRProgram *prog, IRInstr instr)
         prog->capacity = new_cap;
     }
     prog->data[prog->count++] = instr;
+    prog->verified = 0;   /* any change invalidates a previous verify */
+}
+
+/* ── Superinstruction fusion ─────────────────────────────────────────────── */
+
+/* Fused opcode for the pair (first, second), or first itself if none. */
+static IROpcode fused_opcode(IROpcode first, IROpcode second)
+{
+    switch (first) {
+        case IR_SUB:
+            return second == IR_JNZ ? IR_FUSED_SUB_JNZ : first;
+        case IR_CMP:
+            if (second == IR_JZ)  return IR_FUSED_CMP_JZ;
+            if (second == IR_JNZ) return IR_FUSED_CMP_JNZ;
+            return first;
+        case IR_LOAD_CONST:
+            switch (second) {
+                case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV:
+                case IR_CMP:
+                    return IR_FUSED_CONST_ALU;
+                default:
+                    return first;
+            }
+        default:
+            return first;
+    }
+}
+
+/* Is `second` a valid partner for the already-fused opcode `fused`? */
+static int fusable(IROpcode fused, IROpcode second)
+{
+    return fused_opcode(ir_opcode_unfused(fused), second) == fused;
+}
+
+/* Is pc already the first instruction or the partner of a fused pair? */
+static int in_pair(const IRProgram *prog, size_t pc)
+{
+    const IRInstr *in = prog->data;
+
+    return in[pc].op != ir_opcode_unfused(in[pc].op)
+        || (pc > 0 && in[pc - 1].op != ir_opcode_unfused(in[pc - 1].op));
+}
+
+/*
+ * Two passes: compare/branch pairs first, then LOAD_CONST+ALU among what
+ * is left.  A single greedy pass would take the SUB of a countdown loop
+ * (LOAD_CONST R1, 1 / SUB / JNZ) as the constant's partner, leaving the
+ * loop body, which runs every iteration, unfused.
+ */
+size_t ir_program_fuse(IRProgram *prog)
+{
+    size_t fused = 0;
+
+    for (int branches = 1; branches >= 0; branches--) {
+        for (size_t pc = 0; pc + 1 < prog->count; pc++) {
+            IRInstr *in = &prog->data[pc];
+            IROpcode op = fused_opcode(in->op, prog->data[pc + 1].op);
+
+            /* Pairs never overlap: the partner stays a plain op. */
+            if (op == in->op || in_pair(prog, pc) || in_pair(prog, pc + 1)
+                    || (branches && op == IR_FUSED_CONST_ALU))
+                continue;
+            in->op = op;
+            fused++;
+        }
+    }
+    return fused;
+}
+
+/* ── Verification ─────────────────────────────────────────────────────────── */
+
+static int verify_reg(int r, const char *role, int max_regs, size_t pc)
+{
+    if (r < 0 || r >= max_regs) {
+        fprintf(stderr, "ir error: %s register R%d out of range "
+                        "(max R%d) at pc=%zu\n", role, r, max_regs - 1, pc);
+        return -1;
+    }
+    return 0;
+}
+
+int ir_program_verify(IRProgram *prog, int max_regs)
+{
+    int errors      = 0;
+    int uses_memory = 0;
+
+    for (size_t pc = 0; pc < prog->count; pc++) {
+        const IRInstr *in = &prog->data[pc];
+
+        /* A superinstruction needs its partner to be the next instruction. */
+        if (in->op != ir_opcode_unfused(in->op)
+                && (pc + 1 >= prog->count
+                    || !fusable(in->op, prog->data[pc + 1].op))) {
+            fprintf(stderr, "ir error: fused %s at pc=%zu has no valid "
+                            "partner\n", ir_opcode_name(in->op), pc);
+            errors++;
+        }
+
+        switch (ir_opcode_unfused(in->op)) {
+            case IR_LOAD_CONST:
+                errors += verify_reg(in->dst, "dst", max_regs, pc) != 0;
+                break;
+
+            case IR_ADD:
+            case IR_SUB:
+            case IR_MUL:
+            case IR_DIV:
+            case IR_CMP:
+            case IR_AND:
+            case IR_OR:
+            case IR_XOR:
+            case IR_NOT:
+            case IR_SHL:
+            case IR_LSR:
+            case IR_ASR:
+            case IR_ROR:
+            case IR_SDIV:
+            case IR_SREM:
+            case IR_UREM:
+                errors += verify_reg(in->dst, "dst", max_regs, pc) != 0;
+                errors += verify_reg(in->src, "src", max_regs, pc) != 0;
+                break;
+
+            case IR_UMULL:
+            case IR_SMULL:
+            case IR_MLA:
+                errors += verify_reg(in->dst,  "dst",  max_regs, pc) != 0;
+                errors += verify_reg(in->src,  "src",  max_regs, pc) != 0;
+                errors += verify_reg(in->addr, "addr", max_regs, pc) != 0;
+                break;
+
+            case IR_JMP:
+            case IR_JZ:
+            case IR_JNZ:
+                if (in->target < 0 || (size_t)in->target > prog->count) {
+                    fprintf(stderr, "ir error: jump target %d out of bounds "
+                                    "(program has %zu instructions) "
+                                    "at pc=%zu\n",
+                            in->target, prog->count, pc);
+                    errors++;
+                }
+                break;
+
+            case IR_LOAD:
+                errors += verify_reg(in->dst,  "dst",  max_regs, pc) != 0;
+                errors += verify_reg(in->addr, "addr", max_regs, pc) != 0;
+                uses_memory = 1;
+                break;
+
+            case IR_STORE:
+                errors += verify_reg(in->src,  "src",  max_regs, pc) != 0;
+                errors += verify_reg(in->addr, "addr", max_regs, pc) != 0;
+                uses_memory = 1;
+                break;
+
+            default:
+                fprintf(stderr, "ir error: unknown opcode %d at pc=%zu\n",
+                        (int)in->op, pc);
+                errors++;
+                break;
+        }
+    }
+
+    prog->uses_memory = uses_memory;
+    prog->verified    = (errors == 0);
+    return errors == 0 ? 0 : -1;
 }
 
 /* ── Helpers ──────────────────────────────────────────────────────────────── */
@@ -54,15 +224,47 @@ const char *ir_opcode_name(IROpcode op)
         case IR_JNZ:        return "JNZ";
         case IR_LOAD:       return "LOAD";
         case IR_STORE:      return "STORE";
+        case IR_AND:        return "AND";
+        case IR_OR:         return "OR";
+        case IR_XOR:        return "XOR";
+        case IR_NOT:        return "NOT";
+        case IR_SHL:        return "SHL";
+        case IR_LSR:        return "LSR";
+        case IR_ASR:        return "ASR";
+        case IR_ROR:        return "ROR";
+        case IR_SDIV:       return "SDIV";
+        case IR_SREM:       return "SREM";
+        case IR_UREM:       return "UREM";
+        case IR_UMULL:      return "UMULL";
+        case IR_SMULL:      return "SMULL";
+        case IR_MLA:        return "MLA";
+        case IR_FUSED_SUB_JNZ:
+        case IR_FUSED_CMP_JZ:
+        case IR_FUSED_CMP_JNZ:
+        case IR_FUSED_CONST_ALU:
+            return ir_opcode_name(ir_opcode_unfused(op));
     }
     return "???";
 }
 
+IROpcode ir_opcode_unfused(IROpcode op)
+{
+    switch (op) {
+        case IR_FUSED_SUB_JNZ:   return IR_SUB;
+        case IR_FUSED_CMP_JZ:
+        case IR_FUSED_CMP_JNZ:   return IR_CMP;
+        case IR_FUSED_CONST_ALU: return IR_LOAD_CONST;
+        default:                 return op;
+    }
+}
+
 void ir_program_dump(const IRProgram *prog)
 {
     for (size_t i = 0; i < prog->count; i++) {
         const IRInstr *in = &prog->data[i];
-        switch (in->op) {
+        if (in->op != ir_opcode_unfused(in->op))
+            fprintf(stderr, "      ; fused with pc=%zu\n", i + 1);
+        switch (ir_opcode_unfused(in->op)) {
             case IR_LOAD_CONST:
                 fprintf(stderr, "  %2zu  %-12s R%d, %ld\n",
                         i, ir_opcode_name(in->op), in->dst, in->imm);
@@ -81,6 +283,13 @@ void ir_program_dump(const IRProgram *prog)
                 fprintf(stderr, "  %2zu  %-12s R%d, [R%d]\n",
                         i, ir_opcode_name(in->op), in->src, in->addr);
                 break;
+            case IR_UMULL:
+            case IR_SMULL:
+            case IR_MLA:
+                fprintf(stderr, "  %2zu  %-12s R%d, R%d, R%d\n",
+                        i, ir_opcode_name(in->op), in->dst, in->src,
+                        in->addr);
+                break;
             default:
                 fprintf(stderr, "  %2zu  %-12s R%d, R%d\n",
                         i, ir_opcode_name(in->op), in->dst, in->src);
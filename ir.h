@@ -37,8 +37,45 @@ typedef enum {
     IR_JNZ,        /* if (Z==0) PC = target                                   */
 
     /* ── Level-5: memory access ──────────────────────────────────────────── */
-    IR_LOAD,       /* R[dst] = MEM[R[addr]]    (32-bit word load)             */
-    IR_STORE       /* MEM[R[addr]] = R[src]    (32-bit word store)            */
+    /*
+     * Both move one machine word, WORD_BITS wide (MEM_WORD_SIZE bytes), at
+     * a word-aligned byte address.
+     */
+    IR_LOAD,       /* R[dst] = MEM[R[addr]]    (machine-word load)            */
+    IR_STORE,      /* MEM[R[addr]] = R[src]    (machine-word store)           */
+
+    /* ── Level-6: logical, shift & rotate (flags: see alu.h) ─────────────── */
+    IR_AND,        /* R[dst] = R[dst] & R[src]                                */
+    IR_OR,         /* R[dst] = R[dst] | R[src]                                */
+    IR_XOR,        /* R[dst] = R[dst] ^ R[src]                                */
+    IR_NOT,        /* R[dst] = ~R[src]                                        */
+    IR_SHL,        /* R[dst] = R[dst] << R[src]        (amount: low byte)     */
+    IR_LSR,        /* R[dst] = R[dst] >> R[src]        logical                */
+    IR_ASR,        /* R[dst] = R[dst] >> R[src]        arithmetic             */
+    IR_ROR,        /* R[dst] = R[dst] rotated right by R[src]                 */
+
+    /* ── Level-7: signed divide, remainder & long multiply ───────────────── */
+    /*
+     * IR_DIV is the unsigned divide.  The divides fault on a zero divisor,
+     * SDIV also on WORD_SMIN / -1 (see alu.h for the flags).
+     */
+    IR_SDIV,       /* R[dst] = R[dst] / R[src]          signed, toward zero   */
+    IR_SREM,       /* R[dst] = R[dst] % R[src]          sign of the dividend  */
+    IR_UREM,       /* R[dst] = R[dst] % R[src]          unsigned              */
+    IR_UMULL,      /* R[addr]:R[dst] = R[dst] * R[src]  unsigned, double word */
+    IR_SMULL,      /* R[addr]:R[dst] = R[dst] * R[src]  signed, double word   */
+    IR_MLA,        /* R[dst] = R[dst] + R[src] * R[addr]                      */
+
+    /* ── Internal: superinstructions (written only by ir_program_fuse) ──── */
+    /*
+     * A fused opcode replaces the op of the FIRST instruction of a pair; the
+     * partner at pc+1 is left untouched, so jumps into pc+1 still run it on
+     * its own.  All operand fields keep their original meaning.
+     */
+    IR_FUSED_SUB_JNZ,   /* SUB        at pc, JNZ at pc+1                      */
+    IR_FUSED_CMP_JZ,    /* CMP        at pc, JZ  at pc+1                      */
+    IR_FUSED_CMP_JNZ,   /* CMP        at pc, JNZ at pc+1                      */
+    IR_FUSED_CONST_ALU  /* LOAD_CONST at pc, ADD/SUB/MUL/DIV/CMP at pc+1      */
 } IROpcode;
 
 /* ── Single instruction ───────────────────────────────────────────────────── */
@@ -49,7 +86,8 @@ typedef struct {
     int      src;    /* source register      (arithmetic / CMP / STORE)       */
     long     imm;    /* immediate value      (LOAD_CONST only)                */
     int      target; /* jump destination PC  (JMP/JZ/JNZ only)               */
-    int      addr;   /* register holding memory address (LOAD/STORE only)     */
+    int      addr;   /* memory address register (LOAD/STORE), high-word       */
+                     /* destination (UMULL/SMULL), multiplier (MLA)           */
 } IRInstr;
 
 /* ── Dynamic instruction buffer ──────────────────────────────────────────── */
@@ -58,6 +96,8 @@ typedef struct {
     IRInstr *data;
     size_t   count;
     size_t   capacity;
+    int      verified;    /* set by ir_program_verify; cleared on append  */
+    int      uses_memory; /* program contains LOAD/STORE (valid once verified) */
 } IRProgram;
 
 /* Lifecycle */
@@ -70,6 +110,37 @@ void ir_program_free(IRProgram *prog);
  */
 void ir_program_append(IRProgram *prog, IRInstr instr);
 
+/*
+ * One-time static validation, run at load time before execution.
+ *
+ * Checks every instruction for:
+ *   - a known opcode,
+ *   - register operands in [0, max_regs) for the fields that opcode uses,
+ *   - jump targets in [0, count]  (count itself means "halt").
+ * and records whether the program needs memory (LOAD/STORE present).
+ *
+ * On success marks the program verified and returns 0; a CPU may then run
+ * it without any per-step checks.  On failure prints every problem found
+ * to stderr and returns -1.  Appending an instruction clears the mark.
+ */
+int ir_program_verify(IRProgram *prog, int max_regs);
+
+/*
+ * Superinstruction fusion pass.
+ *
+ * Rewrites SUB+JNZ, CMP+JZ, CMP+JNZ and LOAD_CONST+{ADD,SUB,MUL,DIV,CMP}
+ * pairs so the CPU executes each pair in a single dispatch.  Program
+ * length, pcs, jump targets, traces, flags and step counts are unchanged:
+ * a fused pair still counts (and traces) as two instructions.
+ * Pairs do not overlap; compare/branch pairs take priority, so a loop's
+ * SUB+JNZ is fused even after a LOAD_CONST.  Returns the number of pairs
+ * fused.
+ */
+size_t ir_program_fuse(IRProgram *prog);
+
+/* The opcode a (possibly fused) instruction was written with. */
+IROpcode ir_opcode_unfused(IROpcode op);
+
 /* Debug: dump all instructions to stderr. */
 void ir_program_dump(const IRProgram *prog);
 
@@ -0,0 +1,696 @@
+/*
+ * jit.c — x86-64 code generator for verified IR programs.
+ *
+ * Generated function:   int fn(JitFrame *frame)
+ *
+ * Host register usage inside generated code:
+ *   rbx   frame pointer (register file, flags, budget)   [callee-saved]
+ *   r12   remaining step budget                          [callee-saved]
+ *   r13d  index of the last-written register             [callee-saved]
+ *   eax, ecx, edx, esi, edi   scratch / helper-call arguments
+ *
+ * Return value: one of the JIT_EXIT_* codes; frame->cpu.pc holds the pc of
+ * the faulting instruction for every exit except JIT_EXIT_HALT.
+ */
+
+#define _DEFAULT_SOURCE   /* mmap / MAP_ANONYMOUS */
+
+#include "jit.h"
+#include "cpu_internal.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Generated code uses 32-bit host operations: other word widths interpret. */
+#if WORD_BITS == 32 && defined(__x86_64__) \
+        && (defined(__unix__) || defined(__APPLE__))
+#  define JIT_AVAILABLE 1
+#  include <sys/mman.h>
+#else
+#  define JIT_AVAILABLE 0
+#endif
+
+/* ── Runtime frame shared with generated code ─────────────────────────────── */
+
+/*
+ * Generated code keeps the flags one per byte, where setcc and cmp can
+ * reach them directly; jit_run unpacks cpu.flags into them on entry and
+ * packs them back on a normal exit.
+ */
+enum { JF_Z, JF_N, JF_C, JF_V, JF_COUNT };
+
+typedef struct {
+    CPU      cpu;       /* register file, pc, memory (flags: see flag)    */
+    uint64_t budget;    /* steps remaining                                */
+    int32_t  last_dst;  /* last-written register (for the result)         */
+    uint8_t  flag[JF_COUNT];  /* Z, N, C, V: each 0 or 1                  */
+} JitFrame;
+
+enum {
+    JIT_EXIT_HALT = 0,  /* ran off the end / jumped to prog->count        */
+    JIT_EXIT_STEPS,     /* step budget exhausted                          */
+    JIT_EXIT_DIV_ZERO,  /* DIV/SDIV/SREM/UREM by a zero register          */
+    JIT_EXIT_DIV_OVERFLOW, /* SDIV of WORD_SMIN by -1                     */
+    JIT_EXIT_MEMORY     /* mem_read_word/mem_write_word failed            */
+};
+
+struct JitCode {
+    void    *mem;       /* mmap'd RX pages                                */
+    size_t   size;      /* mapping size                                   */
+    int    (*entry)(JitFrame *);
+    IRInstr *instrs;    /* copy of the program, for error reports         */
+    size_t   count;
+};
+
+/* ── Memory helpers called from generated code ────────────────────────────── */
+
+static int jit_load(JitFrame *f, uint32_t addr, uint32_t dst)
+{
+    word_t value = 0;
+    if (mem_read_word(f->cpu.mem, addr, &value) != 0) return -1;
+    f->cpu.regs[dst] = value;
+    return 0;
+}
+
+static int jit_store(JitFrame *f, uint32_t addr, uint32_t value)
+{
+    return mem_write_word(f->cpu.mem, addr, value);
+}
+
+#if JIT_AVAILABLE
+
+/* ── Code buffer ──────────────────────────────────────────────────────────── */
+
+typedef struct {
+    uint8_t *data;
+    size_t   len;
+    size_t   cap;
+} CodeBuf;
+
+/* A rel32 field to patch once the destination offset is known. */
+typedef struct {
+    size_t at;      /* offset of the rel32 field                          */
+    size_t pc;      /* jump: target pc; stub: faulting pc                 */
+    int    exit;    /* JIT_EXIT_* for stubs, -1 for jumps to a label      */
+} Fixup;
+
+typedef struct {
+    Fixup *data;
+    size_t count;
+    size_t cap;
+} FixupList;
+
+static void emit(CodeBuf *b, const void *bytes, size_t n)
+{
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap * 2 : 4096;
+        while (cap < b->len + n) cap *= 2;
+        uint8_t *grown = realloc(b->data, cap);
+        if (!grown) { perror("realloc"); exit(EXIT_FAILURE); }
+        b->data = grown;
+        b->cap  = cap;
+    }
+    memcpy(b->data + b->len, bytes, n);
+    b->len += n;
+}
+
+static void emit8(CodeBuf *b, uint8_t v)   { emit(b, &v, 1); }
+
+static void emit32(CodeBuf *b, uint32_t v)
+{
+    uint8_t le[4] = { (uint8_t)v, (uint8_t)(v >> 8),
+                      (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+    emit(b, le, 4);
+}
+
+static void emit64(CodeBuf *b, uint64_t v)
+{
+    emit32(b, (uint32_t)v);
+    emit32(b, (uint32_t)(v >> 32));
+}
+
+static void patch32(CodeBuf *b, size_t at, uint32_t v)
+{
+    b->data[at]     = (uint8_t)v;
+    b->data[at + 1] = (uint8_t)(v >> 8);
+    b->data[at + 2] = (uint8_t)(v >> 16);
+    b->data[at + 3] = (uint8_t)(v >> 24);
+}
+
+static void add_fixup(FixupList *l, size_t at, size_t pc, int exit_code)
+{
+    if (l->count == l->cap) {
+        size_t cap = l->cap ? l->cap * 2 : 64;
+        Fixup *grown = realloc(l->data, cap * sizeof(Fixup));
+        if (!grown) { perror("realloc"); exit(EXIT_FAILURE); }
+        l->data = grown;
+        l->cap  = cap;
+    }
+    l->data[l->count++] = (Fixup){ .at = at, .pc = pc, .exit = exit_code };
+}
+
+/*
+ * ModRM + displacement for a [rbx + disp] memory operand.
+ * `reg` is the 3-bit reg/opcode-extension field.
+ */
+static void emit_rbx_mem(CodeBuf *b, int reg, int32_t disp)
+{
+    if (disp >= -128 && disp <= 127) {
+        emit8(b, (uint8_t)(0x40 | ((reg & 7) << 3) | 3));   /* mod=01 */
+        emit8(b, (uint8_t)(int8_t)disp);
+    } else {
+        emit8(b, (uint8_t)(0x80 | ((reg & 7) << 3) | 3));   /* mod=10 */
+        emit32(b, (uint32_t)disp);
+    }
+}
+
+/* opcode bytes followed by a [rbx + disp] operand */
+static void emit_op_mem(CodeBuf *b, const uint8_t *op, size_t n, int reg,
+                        int32_t disp)
+{
+    emit(b, op, n);
+    emit_rbx_mem(b, reg, disp);
+}
+
+/* jcc/jmp with a rel32 to be patched: returns the rel32 offset */
+static size_t emit_jump(CodeBuf *b, const uint8_t *op, size_t n)
+{
+    emit(b, op, n);
+    size_t at = b->len;
+    emit32(b, 0);
+    return at;
+}
+
+/* ── Operand offsets ──────────────────────────────────────────────────────── */
+
+#define REG_OFF(r)   ((int32_t)(offsetof(JitFrame, cpu.regs) \
+                                + (size_t)(r) * sizeof(word_t)))
+#define FLAG_OFF(f)  ((int32_t)(offsetof(JitFrame, flag) + JF_##f))
+#define PC_OFF       ((int32_t)offsetof(JitFrame, cpu.pc))
+#define BUDGET_OFF   ((int32_t)offsetof(JitFrame, budget))
+#define LAST_OFF     ((int32_t)offsetof(JitFrame, last_dst))
+
+/* x86 register numbers */
+enum { EAX = 0, ECX = 1, EDX = 2, ESI = 6, EDI = 7 };
+
+/* setcc opcodes (second byte after 0x0F) */
+enum { SETO = 0x90, SETB = 0x92, SETAE = 0x93, SETE = 0x94, SETS = 0x98 };
+
+static void emit_load_reg(CodeBuf *b, int x86reg, int vreg)
+{
+    static const uint8_t mov_r_m[] = { 0x8B };
+    emit_op_mem(b, mov_r_m, 1, x86reg, REG_OFF(vreg));
+}
+
+static void emit_store_reg(CodeBuf *b, int x86reg, int vreg)
+{
+    static const uint8_t mov_m_r[] = { 0x89 };
+    emit_op_mem(b, mov_m_r, 1, x86reg, REG_OFF(vreg));
+}
+
+static void emit_store_eax(CodeBuf *b, int vreg)
+{
+    emit_store_reg(b, EAX, vreg);
+}
+
+static void emit_setcc(CodeBuf *b, uint8_t cc, int32_t flag_off)
+{
+    const uint8_t op[] = { 0x0F, cc };
+    emit_op_mem(b, op, 2, 0, flag_off);
+}
+
+/* mov r13d, imm32 — record the last-written register */
+static void emit_set_last(CodeBuf *b, int vreg)
+{
+    static const uint8_t op[] = { 0x41, 0xBD };
+    emit(b, op, 2);
+    emit32(b, (uint32_t)vreg);
+}
+
+/* Z/N from eax, C=V=0 (MUL/DIV flag rule) */
+static void emit_zn_clear_cv(CodeBuf *b)
+{
+    static const uint8_t test_eax[] = { 0x85, 0xC0 };
+    static const uint8_t mov_w_imm[] = { 0x66, 0xC7 };
+    emit(b, test_eax, 2);
+    emit_setcc(b, SETE, FLAG_OFF(Z));
+    emit_setcc(b, SETS, FLAG_OFF(N));
+    /* C and V are adjacent bytes: clear both with one 16-bit store. */
+    emit_op_mem(b, mov_w_imm, 2, 0, FLAG_OFF(C));
+    emit8(b, 0);
+    emit8(b, 0);
+}
+
+/* mov rdi, rbx; mov rax, imm64; call rax; test eax, eax */
+static void emit_helper_call(CodeBuf *b, int (*fn)(JitFrame *, uint32_t,
+                                                   uint32_t))
+{
+    static const uint8_t mov_rdi_rbx[] = { 0x48, 0x89, 0xDF };
+    static const uint8_t mov_rax_imm[] = { 0x48, 0xB8 };
+    static const uint8_t call_rax[]    = { 0xFF, 0xD0 };
+    static const uint8_t test_eax[]    = { 0x85, 0xC0 };
+    uint64_t target;
+    memcpy(&target, &fn, sizeof(target));
+
+    emit(b, mov_rdi_rbx, 3);
+    emit(b, mov_rax_imm, 2);
+    emit64(b, target);
+    emit(b, call_rax, 2);
+    emit(b, test_eax, 2);
+}
+
+/* ── Translation ──────────────────────────────────────────────────────────── */
+
+static int translatable(const IRProgram *prog)
+{
+    for (size_t i = 0; i < prog->count; i++) {
+        switch (ir_opcode_unfused(prog->data[i].op)) {
+            case IR_LOAD_CONST: case IR_ADD: case IR_SUB: case IR_MUL:
+            case IR_DIV: case IR_CMP: case IR_JMP: case IR_JZ: case IR_JNZ:
+            case IR_LOAD: case IR_STORE: case IR_AND: case IR_OR:
+            case IR_XOR: case IR_NOT: case IR_SDIV: case IR_SREM:
+            case IR_UREM: case IR_UMULL: case IR_SMULL: case IR_MLA:
+                break;
+            default:
+                return 0;
+        }
+    }
+    return 1;
+}
+
+static void translate(CodeBuf *b, const IRProgram *prog, size_t *labels,
+                      FixupList *jumps, FixupList *stubs)
+{
+    static const uint8_t jc[]   = { 0x0F, 0x82 };
+    static const uint8_t jz[]   = { 0x0F, 0x84 };
+    static const uint8_t jnz[]  = { 0x0F, 0x85 };
+    static const uint8_t jmp[]  = { 0xE9 };
+    static const uint8_t jne[]  = { 0x0F, 0x85 };
+    static const uint8_t je[]   = { 0x0F, 0x84 };
+
+    /* Prologue: push rbx, r12, r13 (keeps rsp 16-byte aligned for calls) */
+    static const uint8_t prologue[] = {
+        0x53,                   /* push rbx      */
+        0x41, 0x54,             /* push r12      */
+        0x41, 0x55,             /* push r13      */
+        0x48, 0x89, 0xFB        /* mov rbx, rdi  */
+    };
+    static const uint8_t mov_r12_m[]  = { 0x4C, 0x8B };
+    static const uint8_t mov_r13d_m[] = { 0x44, 0x8B };
+
+    emit(b, prologue, sizeof(prologue));
+    emit_op_mem(b, mov_r12_m,  2, 4, BUDGET_OFF);   /* r12  = budget   */
+    emit_op_mem(b, mov_r13d_m, 2, 5, LAST_OFF);     /* r13d = last_dst */
+
+    for (size_t pc = 0; pc < prog->count; pc++) {
+        const IRInstr *in = &prog->data[pc];
+        labels[pc] = b->len;
+
+        /* sub r12, 1 ; jc step_limit(pc) */
+        static const uint8_t dec_budget[] = { 0x49, 0x83, 0xEC, 0x01 };
+        emit(b, dec_budget, sizeof(dec_budget));
+        add_fixup(stubs, emit_jump(b, jc, 2), pc, JIT_EXIT_STEPS);
+
+        /*
+         * Superinstructions are translated as their first instruction: in
+         * native code the pair costs no dispatch to begin with.
+         */
+        IROpcode op = ir_opcode_unfused(in->op);
+
+        switch (op) {
+            case IR_LOAD_CONST: {
+                static const uint8_t mov_m_imm[] = { 0xC7 };
+                emit_op_mem(b, mov_m_imm, 1, 0, REG_OFF(in->dst));
+                emit32(b, (uint32_t)in->imm);
+                emit_set_last(b, in->dst);
+                break;
+            }
+
+            case IR_ADD:
+            case IR_SUB:
+            case IR_CMP: {
+                /* mov eax, [d] ; add/sub/cmp eax, [s] */
+                static const uint8_t add_r_m[] = { 0x03 };
+                static const uint8_t sub_r_m[] = { 0x2B };
+                static const uint8_t cmp_r_m[] = { 0x3B };
+                const uint8_t *alu = op == IR_ADD ? add_r_m
+                                   : op == IR_SUB ? sub_r_m : cmp_r_m;
+                emit_load_reg(b, EAX, in->dst);
+                emit_op_mem(b, alu, 1, EAX, REG_OFF(in->src));
+                emit_setcc(b, SETE, FLAG_OFF(Z));
+                emit_setcc(b, SETS, FLAG_OFF(N));
+                emit_setcc(b, op == IR_ADD ? SETB : SETAE, FLAG_OFF(C));
+                emit_setcc(b, SETO, FLAG_OFF(V));
+                if (op != IR_CMP) {
+                    emit_store_eax(b, in->dst);
+                    emit_set_last(b, in->dst);
+                }
+                break;
+            }
+
+            case IR_MUL: {
+                /* mov eax, [d] ; imul eax, [s] */
+                static const uint8_t imul_r_m[] = { 0x0F, 0xAF };
+                emit_load_reg(b, EAX, in->dst);
+                emit_op_mem(b, imul_r_m, 2, EAX, REG_OFF(in->src));
+                emit_store_eax(b, in->dst);
+                emit_zn_clear_cv(b);
+                emit_set_last(b, in->dst);
+                break;
+            }
+
+            case IR_DIV: {
+                /* mov ecx, [s] ; test ecx, ecx ; jz div_zero(pc)
+                 * mov eax, [d] ; xor edx, edx ; div ecx ; mov [d], eax */
+                static const uint8_t test_ecx[] = { 0x85, 0xC9 };
+                static const uint8_t xor_edx[]  = { 0x31, 0xD2 };
+                static const uint8_t div_ecx[]  = { 0xF7, 0xF1 };
+                emit_load_reg(b, ECX, in->src);
+                emit(b, test_ecx, 2);
+                add_fixup(stubs, emit_jump(b, jz, 2), pc, JIT_EXIT_DIV_ZERO);
+                emit_load_reg(b, EAX, in->dst);
+                emit(b, xor_edx, 2);
+                emit(b, div_ecx, 2);
+                emit_store_eax(b, in->dst);
+                emit_zn_clear_cv(b);
+                emit_set_last(b, in->dst);
+                break;
+            }
+
+            case IR_AND:
+            case IR_OR:
+            case IR_XOR:
+            case IR_NOT: {
+                /* mov eax, [d] ; and/or/xor eax, [s]   or
+                 * mov eax, [s] ; not eax ; test eax, eax
+                 * Z/N from the result; C and V are left as they were. */
+                static const uint8_t and_r_m[]  = { 0x23 };
+                static const uint8_t or_r_m[]   = { 0x0B };
+                static const uint8_t xor_r_m[]  = { 0x33 };
+                static const uint8_t not_eax[]  = { 0xF7, 0xD0 };
+                static const uint8_t test_eax[] = { 0x85, 0xC0 };
+                if (op == IR_NOT) {
+                    emit_load_reg(b, EAX, in->src);
+                    emit(b, not_eax, 2);
+                    emit(b, test_eax, 2);
+                } else {
+                    const uint8_t *alu = op == IR_AND ? and_r_m
+                                       : op == IR_OR  ? or_r_m : xor_r_m;
+                    emit_load_reg(b, EAX, in->dst);
+                    emit_op_mem(b, alu, 1, EAX, REG_OFF(in->src));
+                }
+                emit_setcc(b, SETE, FLAG_OFF(Z));
+                emit_setcc(b, SETS, FLAG_OFF(N));
+                emit_store_eax(b, in->dst);
+                emit_set_last(b, in->dst);
+                break;
+            }
+
+            case IR_SDIV:
+            case IR_SREM:
+            case IR_UREM: {
+                /* mov ecx, [s] ; test ecx, ecx ; jz div_zero(pc)
+                 * mov eax, [d] ; then per op:
+                 *   SDIV  trap MIN / -1, then cdq ; idiv ecx
+                 *   SREM  divisor -1 -> 1 (same remainder, no #DE),
+                 *         then cdq ; idiv ecx ; mov eax, edx
+                 *   UREM  xor edx, edx ; div ecx ; mov eax, edx */
+                static const uint8_t test_ecx[]  = { 0x85, 0xC9 };
+                static const uint8_t xor_edx[]   = { 0x31, 0xD2 };
+                static const uint8_t div_ecx[]   = { 0xF7, 0xF1 };
+                static const uint8_t idiv_ecx[]  = { 0xF7, 0xF9 };
+                static const uint8_t cdq[]       = { 0x99 };
+                static const uint8_t mov_eax_edx[] = { 0x89, 0xD0 };
+                /* lea edx, [rcx+1] ; mov esi, eax ; xor esi, 0x80000000 ;
+                 * or esi, edx  -> ZF iff eax == MIN && ecx == -1 */
+                static const uint8_t min_neg1[] = {
+                    0x8D, 0x51, 0x01, 0x89, 0xC6,
+                    0x81, 0xF6, 0x00, 0x00, 0x00, 0x80, 0x09, 0xD6
+                };
+                /* mov edx, 1 ; cmp ecx, -1 ; cmove ecx, edx */
+                static const uint8_t neg1_to_1[] = {
+                    0xBA, 0x01, 0x00, 0x00, 0x00, 0x83, 0xF9, 0xFF,
+                    0x0F, 0x44, 0xCA
+                };
+                emit_load_reg(b, ECX, in->src);
+                emit(b, test_ecx, 2);
+                add_fixup(stubs, emit_jump(b, jz, 2), pc, JIT_EXIT_DIV_ZERO);
+                emit_load_reg(b, EAX, in->dst);
+                if (op == IR_UREM) {
+                    emit(b, xor_edx, 2);
+                    emit(b, div_ecx, 2);
+                } else {
+                    if (op == IR_SDIV) {
+                        emit(b, min_neg1, sizeof(min_neg1));
+                        add_fixup(stubs, emit_jump(b, jz, 2), pc,
+                                  JIT_EXIT_DIV_OVERFLOW);
+                    } else {
+                        emit(b, neg1_to_1, sizeof(neg1_to_1));
+                    }
+                    emit(b, cdq, 1);
+                    emit(b, idiv_ecx, 2);
+                }
+                if (op != IR_SDIV)
+                    emit(b, mov_eax_edx, 2);
+                emit_store_eax(b, in->dst);
+                emit_zn_clear_cv(b);
+                emit_set_last(b, in->dst);
+                break;
+            }
+
+            case IR_UMULL:
+            case IR_SMULL: {
+                /* mov eax, [d] ; mul/imul dword [s]  -> edx:eax
+                 * mov [d], eax ; mov [addr], edx  (high last)
+                 * Z from eax | edx, N from edx, C = V = 0 */
+                static const uint8_t mul_m[]     = { 0xF7 };
+                static const uint8_t mov_ecx_eax[] = { 0x89, 0xC1 };
+                static const uint8_t or_ecx_edx[]  = { 0x09, 0xD1 };
+                static const uint8_t test_edx[]  = { 0x85, 0xD2 };
+                static const uint8_t mov_w_imm[] = { 0x66, 0xC7 };
+                emit_load_reg(b, EAX, in->dst);
+                emit_op_mem(b, mul_m, 1, op == IR_SMULL ? 5 : 4,
+                            REG_OFF(in->src));
+                emit_store_eax(b, in->dst);
+                emit_store_reg(b, EDX, in->addr);
+                emit(b, mov_ecx_eax, 2);
+                emit(b, or_ecx_edx, 2);
+                emit_setcc(b, SETE, FLAG_OFF(Z));
+                emit(b, test_edx, 2);
+                emit_setcc(b, SETS, FLAG_OFF(N));
+                emit_op_mem(b, mov_w_imm, 2, 0, FLAG_OFF(C));
+                emit8(b, 0);
+                emit8(b, 0);
+                emit_set_last(b, in->dst);
+                break;
+            }
+
+            case IR_MLA: {
+                /* mov eax, [s] ; imul eax, [addr] ; add eax, [d] */
+                static const uint8_t imul_r_m[] = { 0x0F, 0xAF };
+                static const uint8_t add_r_m[]  = { 0x03 };
+                emit_load_reg(b, EAX, in->src);
+                emit_op_mem(b, imul_r_m, 2, EAX, REG_OFF(in->addr));
+                emit_op_mem(b, add_r_m, 1, EAX, REG_OFF(in->dst));
+                emit_store_eax(b, in->dst);
+                emit_zn_clear_cv(b);
+                emit_set_last(b, in->dst);
+                break;
+            }
+
+            case IR_JMP:
+                add_fixup(jumps, emit_jump(b, jmp, 1), (size_t)in->target,
+                          -1);
+                break;
+
+            case IR_JZ:
+            case IR_JNZ: {
+                /* cmp byte [Z], 0 ; jne/je target */
+                static const uint8_t cmp_m8_imm[] = { 0x80 };
+                emit_op_mem(b, cmp_m8_imm, 1, 7, FLAG_OFF(Z));
+                emit8(b, 0);
+                add_fixup(jumps, emit_jump(b, op == IR_JZ ? jne : je, 2),
+                          (size_t)in->target, -1);
+                break;
+            }
+
+            case IR_LOAD: {
+                /* jit_load(frame, R[addr], dst) */
+                static const uint8_t mov_edx_imm[] = { 0xBA };
+                emit_load_reg(b, ESI, in->addr);
+                emit(b, mov_edx_imm, 1);
+                emit32(b, (uint32_t)in->dst);
+                emit_helper_call(b, jit_load);
+                add_fixup(stubs, emit_jump(b, jnz, 2), pc, JIT_EXIT_MEMORY);
+                emit_set_last(b, in->dst);
+                break;
+            }
+
+            case IR_STORE: {
+                /* jit_store(frame, R[addr], R[src]) */
+                emit_load_reg(b, ESI, in->addr);
+                emit_load_reg(b, EDX, in->src);
+                emit_helper_call(b, jit_store);
+                add_fixup(stubs, emit_jump(b, jnz, 2), pc, JIT_EXIT_MEMORY);
+                break;
+            }
+
+            default:
+                break;   /* excluded by translatable() */
+        }
+    }
+
+    /* Halt label: jump target prog->count and fall-through off the end. */
+    labels[prog->count] = b->len;
+    static const uint8_t xor_eax[] = { 0x31, 0xC0 };
+    emit(b, xor_eax, 2);
+
+    /* Epilogue: write back budget and last_dst, restore, return eax. */
+    size_t epilogue = b->len;
+    static const uint8_t mov_m_r12[]  = { 0x4C, 0x89 };
+    static const uint8_t mov_m_r13d[] = { 0x44, 0x89 };
+    static const uint8_t restore[] = {
+        0x41, 0x5D,             /* pop r13 */
+        0x41, 0x5C,             /* pop r12 */
+        0x5B,                   /* pop rbx */
+        0xC3                    /* ret     */
+    };
+    emit_op_mem(b, mov_m_r12,  2, 4, BUDGET_OFF);
+    emit_op_mem(b, mov_m_r13d, 2, 5, LAST_OFF);
+    emit(b, restore, sizeof(restore));
+
+    /* Out-of-line exit stubs: mov qword [pc], imm32 ; mov eax, code ; jmp */
+    static const uint8_t mov_q_imm[]   = { 0x48, 0xC7 };
+    static const uint8_t mov_eax_imm[] = { 0xB8 };
+    for (size_t i = 0; i < stubs->count; i++) {
+        const Fixup *f = &stubs->data[i];
+        patch32(b, f->at, (uint32_t)(b->len - (f->at + 4)));
+        emit_op_mem(b, mov_q_imm, 2, 0, PC_OFF);
+        emit32(b, (uint32_t)f->pc);
+        emit(b, mov_eax_imm, 1);
+        emit32(b, (uint32_t)f->exit);
+        size_t at = emit_jump(b, jmp, 1);
+        patch32(b, at, (uint32_t)(epilogue - (at + 4)));
+    }
+
+    for (size_t i = 0; i < jumps->count; i++) {
+        const Fixup *f = &jumps->data[i];
+        patch32(b, f->at, (uint32_t)(labels[f->pc] - (f->at + 4)));
+    }
+}
+
+JitCode *jit_compile(const IRProgram *prog)
+{
+    if (!prog || prog->count == 0 || !prog->verified || !translatable(prog))
+        return NULL;
+
+    CodeBuf   buf    = { 0 };
+    FixupList jumps  = { 0 };
+    FixupList stubs  = { 0 };
+    size_t   *labels = malloc((prog->count + 1) * sizeof(size_t));
+    if (!labels) { perror("malloc"); exit(EXIT_FAILURE); }
+
+    translate(&buf, prog, labels, &jumps, &stubs);
+
+    free(labels);
+    free(jumps.data);
+    free(stubs.data);
+
+    /* Copy into fresh RW pages, then flip them to RX (W^X). */
+    size_t size = (buf.len + 4095u) & ~(size_t)4095u;
+    void  *pages = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED) {
+        free(buf.data);
+        return NULL;
+    }
+    memcpy(pages, buf.data, buf.len);
+    free(buf.data);
+    if (mprotect(pages, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(pages, size);
+        return NULL;
+    }
+
+    JitCode *code = malloc(sizeof(JitCode));
+    IRInstr *copy = malloc(prog->count * sizeof(IRInstr));
+    if (!code || !copy) { perror("malloc"); exit(EXIT_FAILURE); }
+    memcpy(copy, prog->data, prog->count * sizeof(IRInstr));
+
+    code->mem    = pages;
+    code->size   = size;
+    code->instrs = copy;
+    code->count  = prog->count;
+    /* ISO C has no object→function pointer cast; copy the bits instead. */
+    memcpy(&code->entry, &pages, sizeof(code->entry));
+    return code;
+}
+
+void jit_free(JitCode *code)
+{
+    if (!code) return;
+    munmap(code->mem, code->size);
+    free(code->instrs);
+    free(code);
+}
+
+#else  /* !JIT_AVAILABLE */
+
+JitCode *jit_compile(const IRProgram *prog)
+{
+    (void)prog;
+    (void)jit_load;
+    (void)jit_store;
+    return NULL;
+}
+
+void jit_free(JitCode *code)
+{
+    (void)code;
+}
+
+#endif /* JIT_AVAILABLE */
+
+/* ── Execution ────────────────────────────────────────────────────────────── */
+
+int jit_run(const JitCode *code, Memory *mem, long *out_result,
+            size_t max_steps, const CPU *in_state, CPU *out_state)
+{
+    JitFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    cpu_init_state(&frame.cpu, mem, in_state);
+    frame.budget  = max_steps;
+    frame.flag[JF_Z] = (uint8_t)alu_flag(frame.cpu.flags, ALU_FLAG_Z);
+    frame.flag[JF_N] = (uint8_t)alu_flag(frame.cpu.flags, ALU_FLAG_N);
+    frame.flag[JF_C] = (uint8_t)alu_flag(frame.cpu.flags, ALU_FLAG_C);
+    frame.flag[JF_V] = (uint8_t)alu_flag(frame.cpu.flags, ALU_FLAG_V);
+
+    int exit_code = code->entry(&frame);
+
+    switch (exit_code) {
+        case JIT_EXIT_HALT:
+            frame.cpu.pc = code->count;
+            break;
+        case JIT_EXIT_STEPS:
+            return cpu_report_step_limit(max_steps, frame.cpu.pc);
+        case JIT_EXIT_DIV_ZERO:
+            return cpu_report_div_zero(code->instrs[frame.cpu.pc].src,
+                                       frame.cpu.pc);
+        case JIT_EXIT_DIV_OVERFLOW:
+            return cpu_report_div_overflow(code->instrs[frame.cpu.pc].dst,
+                                           code->instrs[frame.cpu.pc].src,
+                                           frame.cpu.pc);
+        default:
+            return -1;   /* memory subsystem already printed the error */
+    }
+
+    frame.cpu.flags.nzcv = alu_nzcv(frame.flag[JF_N], frame.flag[JF_Z],
+                                    frame.flag[JF_C], frame.flag[JF_V]);
+    if (out_result)
+        *out_result = (long)(sword_t)frame.cpu.regs[frame.last_dst];
+    if (out_state)
+        *out_state = frame.cpu;
+    return 0;
+}
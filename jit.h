@@ -0,0 +1,55 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "ir.h"
+#include "cpu.h"
+#include "memory.h"
+
+/*
+ * JIT — x86-64 native code backend for verified IR programs.
+ *
+ * Each IR instruction is translated to a short straight-line sequence of
+ * host instructions operating on the register file in memory:
+ *
+ *   - ADD/SUB/CMP use the host adder; host ZF/SF/CF/OF map directly onto
+ *     Z/N/C/V (C is the inverted host borrow for SUB/CMP, matching the
+ *     a + ~b + 1 carry of alu_sub).
+ *   - MUL/DIV set Z/N from the result and clear C/V, as alu_mul/alu_div do.
+ *   - SDIV/SREM/UREM use the host divider behind explicit zero (and, for
+ *     SDIV, MIN / -1) checks, so the host never raises #DE.  UMULL/SMULL
+ *     use the one-operand widening multiply; MLA is IMUL + ADD.
+ *   - AND/OR/XOR/NOT set Z/N from the result and leave C/V alone.  The
+ *     shifts and ROR carry out ARM shifter semantics with no cheap host
+ *     equivalent and are not translated.
+ *   - LOAD/STORE call into mem_read_word/mem_write_word, so alignment and
+ *     bounds errors are reported by the memory subsystem exactly as in the
+ *     interpreter.
+ *   - Every instruction decrements a step budget, so CPU_MAX_STEPS (or the
+ *     caller's limit) fires at the same pc as in the interpreter.
+ *
+ * Code lives in its own mmap'd pages, written while RW and then flipped to
+ * RX before the first call (never writable and executable at once).
+ *
+ * jit_compile returns NULL when the host is not x86-64/POSIX, when the
+ * machine word is not 32 bits (word.h), when the program has not passed
+ * ir_program_verify, or when it contains an opcode the JIT does not
+ * translate; callers then fall back to the interpreter.
+ */
+
+typedef struct JitCode JitCode;
+
+/* Translate `prog` to native code.  Returns NULL if unsupported. */
+JitCode *jit_compile(const IRProgram *prog);
+
+/* Release the code pages. */
+void jit_free(JitCode *code);
+
+/*
+ * Run compiled code on a CPU backed by `mem`, starting from in_state's
+ * registers and flags (zeroed if NULL).
+ * Same result/error contract as cpu_execute_opts (trace is not supported).
+ */
+int jit_run(const JitCode *code, Memory *mem, long *out_result,
+            size_t max_steps, const CPU *in_state, CPU *out_state);
+
+#endif /* JIT_H */
@@ -74,6 +74,21 @@ Token lexer_next(TokenStream *ts)
         return make_token(TOK_NUMBER, value, start);
     }
 
+    /* Shift operators: <<, >> and >>> (a lone '<' or '>' is invalid). */
+    if (c == '<' || c == '>') {
+        size_t n = 1;
+        while (n < 3 && ts->pos + n < ts->len && ts->src[ts->pos + n] == c)
+            n++;
+        if (c == '<' && n == 2) {
+            ts->pos += 2;
+            return make_token(TOK_SHL, 0, start);
+        }
+        if (c == '>' && n >= 2) {
+            ts->pos += n;
+            return make_token(n == 3 ? TOK_USHR : TOK_SHR, 0, start);
+        }
+    }
+
     ts->pos++; /* consume single-character token */
 
     switch (c) {
@@ -81,6 +96,11 @@ Token lexer_next(TokenStream *ts)
         case '-': return make_token(TOK_MINUS,  0, start);
         case '*': return make_token(TOK_MUL,    0, start);
         case '/': return make_token(TOK_DIV,    0, start);
+        case '%': return make_token(TOK_MOD,    0, start);
+        case '&': return make_token(TOK_AMP,    0, start);
+        case '|': return make_token(TOK_PIPE,   0, start);
+        case '^': return make_token(TOK_CARET,  0, start);
+        case '~': return make_token(TOK_TILDE,  0, start);
         case '(': return make_token(TOK_LPAREN, 0, start);
         case ')': return make_token(TOK_RPAREN, 0, start);
         default:
@@ -107,6 +127,14 @@ const char *token_type_name(TokenType t)
         case TOK_MINUS:   return "-";
         case TOK_MUL:     return "*";
         case TOK_DIV:     return "/";
+        case TOK_MOD:     return "%";
+        case TOK_AMP:     return "&";
+        case TOK_PIPE:    return "|";
+        case TOK_CARET:   return "^";
+        case TOK_TILDE:   return "~";
+        case TOK_SHL:     return "<<";
+        case TOK_SHR:     return ">>";
+        case TOK_USHR:    return ">>>";
         case TOK_LPAREN:  return "(";
         case TOK_RPAREN:  return ")";
         case TOK_EOF:     return "EOF";
@@ -10,6 +10,14 @@ typedef enum {
     TOK_MINUS,
     TOK_MUL,
     TOK_DIV,
+    TOK_MOD,      /* %   */
+    TOK_AMP,      /* &   */
+    TOK_PIPE,     /* |   */
+    TOK_CARET,    /* ^   */
+    TOK_TILDE,    /* ~   */
+    TOK_SHL,      /* <<  */
+    TOK_SHR,      /* >>  arithmetic */
+    TOK_USHR,     /* >>> logical    */
     TOK_LPAREN,
     TOK_RPAREN,
     TOK_EOF,
@@ -11,6 +11,22 @@
  *
  * After the expression pipeline, a hand-written IR program demonstrates
  * the new control-flow instructions.
+ *
+ * Usage: math_sim [--timing] [--cache] [--mem-stats]
+ *                 [--ripple | --adder=NAME] [--muldiv=NAME]
+ *   --timing  also time the CPU run on the 5-stage pipeline model
+ *             (pipeline.h) and print cycles, CPI and stalls.
+ *   --cache   run the Level-5 memory demos through the L1/L2/L3 cache
+ *             hierarchy (cache.h) and print each level and the AMAT.
+ *   --mem-stats  after each Level-5 memory demo, print the Memory's read,
+ *             write and fault counts and its per-page heatmap as CSV.
+ *   --ripple  run ADD/SUB/CMP on the bit-accurate ripple-carry adder
+ *             instead of the native fast path (alu.h).
+ *   --adder=NAME  run them on the named alu.h adder instead: native,
+ *             ripple, cla, kogge-stone, brent-kung or table.
+ *   --muldiv=NAME  run the multiplies and divides on the named alu.h unit:
+ *             native, or iterative (Booth multiplier, non-restoring
+ *             divider; with --timing each step costs an EX cycle).
  */
 
 #include "lexer.h"
@@ -20,7 +36,10 @@
 #include "ir.h"
 #include "codegen.h"
 #include "cpu.h"
+#include "alu.h"
 #include "memory.h"
+#include "pipeline.h"
+#include "cache.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -164,6 +183,58 @@ static void run_loop_demo(void)
 }
 
 /* ── Level-5 demo: load/store with RAM ───────────────────────────────────── */
+
+#define CACHE_LEVELS 3
+
+static int execute_cached(const IRProgram *prog, Memory *mem, long *result);
+
+/*
+ * cpu_execute on `mem`; with `cache`, through the cache_level_config()
+ * L1/L2/L3 hierarchy, printing its summary after a successful run; with
+ * `stats`, then printing the statistics and heatmap of `mem`.
+ */
+static int execute_on_memory(const IRProgram *prog, Memory *mem,
+                             long *result, int cache, int stats)
+{
+    if (stats)
+        mem_heatmap_enable(mem, 1);
+
+    int status = cache ? execute_cached(prog, mem, result)
+                       : cpu_execute(prog, mem, result);
+    if (stats) {
+        printf("\n");
+        mem_print_stats(mem, stdout);
+        mem_heatmap_csv(mem, stdout);
+    }
+    return status;
+}
+
+static int execute_cached(const IRProgram *prog, Memory *mem, long *result)
+{
+    TraceSink text = trace_sink_text(stdout);
+    Cache     level[CACHE_LEVELS];
+    for (int i = 0; i < CACHE_LEVELS; i++) {
+        CacheConfig cfg = cache_level_config(i + 1);
+        if (cache_init(&level[i], &cfg, i == 0 ? &text : NULL) != 0)
+            exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < CACHE_LEVELS; i++)
+        if (cache_connect(&level[i], i + 1 < CACHE_LEVELS ? &level[i + 1]
+                                                          : NULL, mem) != 0)
+            exit(EXIT_FAILURE);
+
+    TraceSink  sink   = cache_sink(&level[0]);
+    CPUOptions opts   = { .trace = &sink };
+    int        status = cpu_execute_opts(prog, mem, result, &opts);
+    if (status == 0) {
+        printf("\n");
+        cache_print_stats(&level[0], stdout);
+    }
+    for (int i = 0; i < CACHE_LEVELS; i++)
+        cache_free(&level[i]);
+    return status;
+}
+
 /*
  * Demonstrates basic load/store:
  *
@@ -175,9 +246,16 @@ static void run_loop_demo(void)
  * Expected: R3 == 42.
  *
  * Second run: stores 0xDEADBEEF, reloads it, verifies round-trip at the
- * 32-bit level.
+ * machine-word level (truncated to WORD_BITS in narrower builds).
+ *
+ * With words of 32 bits or more, a third run stores and reloads at the top
+ * of the sparse 4 GB address space, touching a single page.
+ *
+ * The error demos use an unaligned address (0x102), which needs a word
+ * of more than 16 bits, and one past MEM_SIZE (0x100000000), which only
+ * a 64-bit word can reach.
  */
-static void run_memory_demo(void)
+static void run_memory_demo(int cache, int stats)
 {
     printf("\n══════════════════════════════════════════\n");
     printf(" Level-5 memory demo — basic store/load (value=42)\n");
@@ -206,8 +284,10 @@ static void run_memory_demo(void)
         mem_init(&mem);
 
         long result = 0;
-        int  status = cpu_execute(&prog, &mem, &result);
+        int  status = execute_on_memory(&prog, &mem, &result, cache,
+                                        stats);
         ir_program_free(&prog);
+        mem_free(&mem);
 
         if (status == 0)
             printf("Memory demo result: R3 = %ld  (expected 42)\n", result);
@@ -236,16 +316,56 @@ static void run_memory_demo(void)
         mem_init(&mem);
 
         long result = 0;
-        int  status = cpu_execute(&prog, &mem, &result);
+        int  status = execute_on_memory(&prog, &mem, &result, cache,
+                                        stats);
         ir_program_free(&prog);
+        mem_free(&mem);
 
         if (status == 0)
             printf("Round-trip result: R2 = 0x%08lx  (expected 0xdeadbeef)\n",
-                   (unsigned long)(uint32_t)result);
+                   (unsigned long)(word_t)result);
         else
             fprintf(stderr, "Round-trip demo failed.\n");
     }
 
+#if WORD_BITS >= 32
+    printf("\n══════════════════════════════════════════\n");
+    printf(" Level-5 sparse memory demo — top of 4 GB (0xFFFFFFFC)\n");
+    printf("══════════════════════════════════════════\n");
+    {
+        IRProgram prog;
+        ir_program_init(&prog);
+
+        /* Store 7 in the last word of the address space, reload into R2. */
+        ir_program_append(&prog,
+            (IRInstr){IR_LOAD_CONST, 0, 0, 0xFFFFFFFC, 0, 0}); /* addr */
+        ir_program_append(&prog,
+            (IRInstr){IR_LOAD_CONST, 1, 0, 7,          0, 0}); /* val  */
+        ir_program_append(&prog,
+            (IRInstr){IR_STORE, 0, 1, 0, 0, 0});                /* MEM[R0]=R1 */
+        ir_program_append(&prog,
+            (IRInstr){IR_LOAD,  2, 0, 0, 0, 0});                /* R2=MEM[R0] */
+
+        Memory mem;
+        mem_init(&mem);
+
+        long result = 0;
+        int  status = execute_on_memory(&prog, &mem, &result, cache,
+                                        stats);
+        uint64_t resident = mem.resident;
+        ir_program_free(&prog);
+        mem_free(&mem);
+
+        if (status == 0)
+            printf("Sparse result: R2 = %ld, %llu page(s) resident  "
+                   "(expected 7, 1)\n", result,
+                   (unsigned long long)resident);
+        else
+            fprintf(stderr, "Sparse memory demo failed.\n");
+    }
+#endif
+
+#if WORD_BITS > 16
     printf("\n══════════════════════════════════════════\n");
     printf(" Level-5 error demo — unaligned access (0x102)\n");
     printf("══════════════════════════════════════════\n");
@@ -264,13 +384,17 @@ static void run_memory_demo(void)
         mem_init(&mem);
 
         long result = 0;
-        int  status = cpu_execute(&prog, &mem, &result);
+        int  status = execute_on_memory(&prog, &mem, &result, cache,
+                                        stats);
         ir_program_free(&prog);
+        mem_free(&mem);
 
         printf("Unaligned store returned: %s  (expected: error)\n",
                status != 0 ? "error (correct)" : "success (WRONG!)");
     }
+#endif
 
+#if WORD_BITS > 32
     printf("\n══════════════════════════════════════════\n");
     printf(" Level-5 error demo — out-of-bounds access\n");
     printf("══════════════════════════════════════════\n");
@@ -278,9 +402,9 @@ static void run_memory_demo(void)
         IRProgram prog;
         ir_program_init(&prog);
 
-        /* Address 0x10000 == MEM_SIZE; one word past end. */
+        /* Address 0x100000000 == MEM_SIZE; one word past end. */
         ir_program_append(&prog,
-            (IRInstr){IR_LOAD_CONST, 0, 0, 0x10000, 0, 0});
+            (IRInstr){IR_LOAD_CONST, 0, 0, (long)MEM_SIZE, 0, 0});
         ir_program_append(&prog,
             (IRInstr){IR_LOAD, 1, 0, 0, 0, 0});             /* should fail */
 
@@ -288,18 +412,72 @@ static void run_memory_demo(void)
         mem_init(&mem);
 
         long result = 0;
-        int  status = cpu_execute(&prog, &mem, &result);
+        int  status = execute_on_memory(&prog, &mem, &result, cache,
+                                        stats);
         ir_program_free(&prog);
+        mem_free(&mem);
 
         printf("Out-of-bounds load returned: %s  (expected: error)\n",
                status != 0 ? "error (correct)" : "success (WRONG!)");
     }
+#endif
 }
 
 
 
-int main(void)
+/* Select the alu.h adder called `name`.  Returns 0, or -1 if unknown. */
+static int parse_adder(const char *name)
 {
+    for (int m = 0; m < ALU_MODE_COUNT; m++) {
+        if (strcmp(name, alu_mode_name((ALUMode)m)) == 0) {
+            alu_set_mode((ALUMode)m);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* Select the multiply/divide unit called `name`.  Returns 0, or -1. */
+static int parse_muldiv(const char *name)
+{
+    for (int m = 0; m < ALU_MULDIV_MODE_COUNT; m++) {
+        if (strcmp(name, alu_muldiv_mode_name((ALUMulDivMode)m)) == 0) {
+            alu_set_muldiv_mode((ALUMulDivMode)m);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char **argv)
+{
+    int timing = 0, cache = 0, stats = 0;
+    for (int i = 1; i < argc; i++) {
+        int ok = 1;
+
+        if (strcmp(argv[i], "--timing") == 0)
+            timing = 1;
+        else if (strcmp(argv[i], "--cache") == 0)
+            cache = 1;
+        else if (strcmp(argv[i], "--mem-stats") == 0)
+            stats = 1;
+        else if (strcmp(argv[i], "--ripple") == 0)
+            alu_set_mode(ALU_RIPPLE);
+        else if (strncmp(argv[i], "--adder=", 8) == 0)
+            ok = parse_adder(argv[i] + 8) == 0;
+        else if (strncmp(argv[i], "--muldiv=", 9) == 0)
+            ok = parse_muldiv(argv[i] + 9) == 0;
+        else
+            ok = 0;
+
+        if (!ok) {
+            fprintf(stderr, "usage: %s [--timing] [--cache] [--mem-stats] "
+                            "[--ripple | --adder=NAME] [--muldiv=NAME] "
+                            "< expression\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
     /* ── 1. Read one line from stdin ──────────────────────────────────────── */
     char buf[MAX_INPUT];
     if (!fgets(buf, sizeof(buf), stdin)) {
@@ -357,21 +535,42 @@ int main(void)
 
     ast_free(root);
 
+    /* Validate registers/targets once so the CPU can skip per-step checks. */
+    if (ir_program_verify(&prog, CPU_MAX_REGS) != 0) {
+        ir_program_free(&prog);
+        return EXIT_FAILURE;
+    }
+    ir_program_fuse(&prog);
+
     printf("\nCPU:\n");
+    TraceSink     text     = trace_sink_text(stdout);
+    CPUOptions    cpu_opts = { .trace = &text };
+    PipelineModel pipeline;
+    TraceSink     timed;
+    if (timing) {
+        pipeline_init(&pipeline, NULL, &text);
+        timed          = pipeline_sink(&pipeline);
+        cpu_opts.trace = &timed;
+    }
     long cpu_result = 0;
-    int  cpu_status = cpu_execute(&prog, NULL, &cpu_result);
+    int  cpu_status = cpu_execute_verified(&prog, NULL, &cpu_result,
+                                           &cpu_opts);
+    if (timing && cpu_status == 0) {
+        printf("\n");
+        pipeline_print_stats(&pipeline.stats, stdout);
+    }
 
     ir_program_free(&prog);
 
     if (cpu_status != 0)
         return EXIT_FAILURE;
 
-    /* ── 6. Cross-check at 32-bit level ──────────────────────────────────── */
-    if ((uint32_t)cpu_result != (uint32_t)eval_result.value) {
+    /* ── 6. Cross-check at machine-word level ─────────────────────────────── */
+    if ((word_t)cpu_result != (word_t)eval_result.value) {
         fprintf(stderr, "error: evaluator (0x%08lx) and CPU (0x%08lx) "
-                        "disagree at the 32-bit level — this is a compiler bug\n",
-                (unsigned long)(uint32_t)eval_result.value,
-                (unsigned long)(uint32_t)cpu_result);
+                        "disagree at the word level — this is a compiler bug\n",
+                (unsigned long)(word_t)eval_result.value,
+                (unsigned long)(word_t)cpu_result);
         return EXIT_FAILURE;
     }
 
@@ -380,7 +579,7 @@ int main(void)
 
     run_branch_demo();
     run_loop_demo();
-    run_memory_demo();
+    run_memory_demo(cache, stats);
 
     return EXIT_SUCCESS;
 }
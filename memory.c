@@ -1,89 +1,433 @@
 #include "memory.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#if MEM_STATS
+#  define MEM_COUNT(expr) ((void)(expr)++)
+#else
+#  define MEM_COUNT(expr) ((void)sizeof(expr))  /* not evaluated */
+#endif
+
+#define MEM_VPNS ((uint64_t)MEM_DIR_ENTRIES * MEM_TABLE_ENTRIES)
+
+/* ── Paging ───────────────────────────────────────────────────────────────── */
+
+static void *zalloc(size_t size)
+{
+    void *p = calloc(1, size);
+    if (!p) { perror("calloc"); exit(EXIT_FAILURE); }
+    return p;
+}
+
+/* Page `vpn` if it has been allocated, else NULL. */
+static MemPage *page_lookup(const Memory *mem, uint32_t vpn)
+{
+    const MemTable *t = mem->dir[vpn >> MEM_TABLE_BITS];
+    return t ? t->page[vpn & (MEM_TABLE_ENTRIES - 1u)] : NULL;
+}
+
+/* Page `vpn`, allocating it (and its table) zeroed if need be. */
+static MemPage *page_alloc(Memory *mem, uint32_t vpn)
+{
+    MemTable **t = &mem->dir[vpn >> MEM_TABLE_BITS];
+    if (!*t)
+        *t = zalloc(sizeof(MemTable));
+
+    MemPage **p = &(*t)->page[vpn & (MEM_TABLE_ENTRIES - 1u)];
+    if (!*p) {
+        *p = zalloc(sizeof(MemPage));
+        mem->resident++;
+    }
+    return *p;
+}
+
+/*
+ * Page `vpn` through the one-entry translation cache.  Without `alloc`
+ * a page never written comes back NULL (and is not cached: it reads as
+ * zero until a write allocates it).
+ */
+static inline MemPage *translate(Memory *mem, uint32_t vpn, int alloc)
+{
+    if (mem->last_page && mem->last_vpn == vpn)
+        return mem->last_page;
+
+    MemPage *p = alloc ? page_alloc(mem, vpn) : page_lookup(mem, vpn);
+    if (p) {
+        mem->last_vpn  = vpn;
+        mem->last_page = p;
+    }
+    return p;
+}
+
+/* First allocated page at or after *vpn (updated to its number), or NULL. */
+static MemPage *next_page(const Memory *mem, uint64_t *vpn)
+{
+    while (*vpn < MEM_VPNS) {
+        const MemTable *t = mem->dir[*vpn >> MEM_TABLE_BITS];
+        if (!t) {
+            *vpn = ((*vpn >> MEM_TABLE_BITS) + 1) << MEM_TABLE_BITS;
+            continue;
+        }
+        MemPage *p = t->page[*vpn & (MEM_TABLE_ENTRIES - 1u)];
+        if (p)
+            return p;
+        (*vpn)++;
+    }
+    return NULL;
+}
+
+static int page_is_zero(const MemPage *p)
+{
+    for (uint32_t i = 0; i < MEM_PAGE_SIZE; i++)
+        if (p->data[i] != 0)
+            return 0;
+    return 1;
+}
+
+/* ── Cold reads ───────────────────────────────────────────────────────────── */
+
+static void cold_clear(MemColdReads *c)
+{
+    free(c->key);
+    free(c->reads);
+    memset(c, 0, sizeof(*c));
+}
+
+/* Slot holding `key` (vpn + 1), or the free slot where it belongs. */
+static uint32_t cold_find(const MemColdReads *c, uint32_t key)
+{
+    uint32_t mask = c->size - 1;
+    uint32_t i    = (key * 0x9E3779B1u) & mask;
+
+    while (c->key[i] != 0 && c->key[i] != key)
+        i = (i + 1) & mask;
+    return i;
+}
+
+static void cold_grow(MemColdReads *c)
+{
+    MemColdReads old = *c;
+
+    c->size  = old.size ? old.size * 2 : 64;
+    c->key   = zalloc((size_t)c->size * sizeof(uint32_t));
+    c->reads = zalloc((size_t)c->size * sizeof(uint64_t));
+    for (uint32_t i = 0; i < old.size; i++) {
+        if (old.key[i] != 0) {
+            uint32_t j = cold_find(c, old.key[i]);
+            c->key[j]   = old.key[i];
+            c->reads[j] = old.reads[i];
+        }
+    }
+    free(old.key);
+    free(old.reads);
+}
+
+/* A heatmap read of page `vpn`, which is not allocated. */
+static void cold_count(Memory *mem, uint32_t vpn)
+{
+    MemColdReads *c = &mem->cold;
+
+    if (2 * (c->used + 1) > c->size)
+        cold_grow(c);
+    uint32_t i = cold_find(c, vpn + 1);
+    if (c->key[i] == 0) {
+        c->key[i] = vpn + 1;
+        c->used++;
+    }
+    c->reads[i]++;
+}
+
+static uint64_t cold_reads(const MemColdReads *c, uint32_t vpn)
+{
+    if (c->size == 0)
+        return 0;
+    uint32_t i = cold_find(c, vpn + 1);
+    return c->key[i] != 0 ? c->reads[i] : 0;
+}
+
+static void cold_copy(MemColdReads *dst, const MemColdReads *src)
+{
+    cold_clear(dst);
+    if (src->size == 0)
+        return;
+    *dst       = *src;
+    dst->key   = zalloc((size_t)src->size * sizeof(uint32_t));
+    dst->reads = zalloc((size_t)src->size * sizeof(uint64_t));
+    memcpy(dst->key, src->key, (size_t)src->size * sizeof(uint32_t));
+    memcpy(dst->reads, src->reads, (size_t)src->size * sizeof(uint64_t));
+}
+
 /* ── Lifecycle ────────────────────────────────────────────────────────────── */
 
 void mem_init(Memory *mem)
 {
-    memset(mem->data, 0, sizeof(mem->data));
+    memset(mem, 0, sizeof(*mem));
+    mem->latency_cycles = MEM_LATENCY;
+}
+
+void mem_reset(Memory *mem)
+{
+    MemPage *p;
+
+    if (mem->resident > MEM_RESET_KEEP) {
+        mem_free(mem);
+        return;
+    }
+    for (uint64_t vpn = 0; (p = next_page(mem, &vpn)) != NULL; vpn++)
+        memset(p, 0, sizeof(*p));
+    cold_clear(&mem->cold);
+
+    mem->latency_cycles = MEM_LATENCY;
+    mem->read_count     = 0;
+    mem->write_count    = 0;
+    mem->align_faults   = 0;
+    mem->bounds_faults  = 0;
+    mem->heat_on        = 0;
+}
+
+void mem_free(Memory *mem)
+{
+    for (uint32_t d = 0; d < MEM_DIR_ENTRIES; d++) {
+        MemTable *t = mem->dir[d];
+        if (!t)
+            continue;
+        for (uint32_t i = 0; i < MEM_TABLE_ENTRIES; i++)
+            free(t->page[i]);
+        free(t);
+    }
+    cold_clear(&mem->cold);
+    mem_init(mem);
+}
+
+void mem_copy(Memory *dst, const Memory *src)
+{
+    const MemPage *p;
+
+    if (dst == src)
+        return;
+
+    /* dst's own pages are zeroed unless src's overwrite them below. */
+    MemPage *q;
+    for (uint64_t vpn = 0; (q = next_page(dst, &vpn)) != NULL; vpn++)
+        if (!page_lookup(src, (uint32_t)vpn))
+            memset(q, 0, sizeof(*q));
+    for (uint64_t vpn = 0; (p = next_page(src, &vpn)) != NULL; vpn++)
+        memcpy(page_alloc(dst, (uint32_t)vpn), p, sizeof(*p));
+    cold_copy(&dst->cold, &src->cold);
+
+    dst->latency_cycles = src->latency_cycles;
+    dst->read_count     = src->read_count;
+    dst->write_count    = src->write_count;
+    dst->align_faults   = src->align_faults;
+    dst->bounds_faults  = src->bounds_faults;
+    dst->heat_on        = src->heat_on;
+}
+
+int mem_equal(const Memory *a, const Memory *b)
+{
+    const MemPage *p;
+
+    /* Every page of a against b's (or zero), then b's that a lacks. */
+    for (uint64_t vpn = 0; (p = next_page(a, &vpn)) != NULL; vpn++) {
+        const MemPage *q = page_lookup(b, (uint32_t)vpn);
+        if (q ? memcmp(p->data, q->data, MEM_PAGE_SIZE) != 0
+              : !page_is_zero(p))
+            return 0;
+    }
+    for (uint64_t vpn = 0; (p = next_page(b, &vpn)) != NULL; vpn++)
+        if (!page_lookup(a, (uint32_t)vpn) && !page_is_zero(p))
+            return 0;
+    return 1;
 }
 
 /* ── Internal validation ──────────────────────────────────────────────────── */
 
 /*
- * Validate a 32-bit word access at `addr`.
+ * Validate a word access at `addr`.
  *
  * Checks:
- *   1. alignment: addr % 4 == 0
- *   2. bounds:    addr + 4 <= MEM_SIZE
+ *   1. alignment: addr % MEM_WORD_SIZE == 0
+ *   2. bounds:    addr + MEM_WORD_SIZE <= MEM_SIZE
  *
- * Returns 0 on success, -1 with an stderr message on failure.
+ * Returns 0 on success, -1 with an stderr message (and a fault counted)
+ * on failure.
  */
-static int check_access(uint32_t addr, const char *op)
+static int check_access(Memory *mem, word_t addr, const char *op)
 {
     if (addr % MEM_WORD_SIZE != 0) {
+        MEM_COUNT(mem->align_faults);
         fprintf(stderr,
-                "memory error: unaligned %s at address 0x%08x "
-                "(must be 4-byte aligned)\n", op, (unsigned)addr);
+                "memory error: unaligned %s at address 0x%08llx "
+                "(must be %u-byte aligned)\n", op, (unsigned long long)addr,
+                MEM_WORD_SIZE);
         return -1;
     }
     /*
-     * addr is uint32_t so addr + MEM_WORD_SIZE can overflow if addr is near
-     * UINT32_MAX.  Check addr <= MEM_SIZE - MEM_WORD_SIZE instead to stay safe.
+     * addr + MEM_WORD_SIZE can overflow if addr is near the top of the
+     * word range.  Check addr <= MEM_SIZE - MEM_WORD_SIZE instead.  Only
+     * a 64-bit address can leave the 32-bit address space at all.
      */
-    if (addr > (uint32_t)(MEM_SIZE - MEM_WORD_SIZE)) {
+#if WORD_BITS > 32
+    if ((uint64_t)addr > MEM_SIZE - MEM_WORD_SIZE) {
+        MEM_COUNT(mem->bounds_faults);
         fprintf(stderr,
-                "memory error: %s out of bounds at address 0x%08x "
-                "(memory size = 0x%x)\n", op, (unsigned)addr, MEM_SIZE);
+                "memory error: %s out of bounds at address 0x%08llx "
+                "(memory size = 0x%llx)\n", op, (unsigned long long)addr,
+                (unsigned long long)MEM_SIZE);
         return -1;
     }
+#endif
     return 0;
 }
 
 /* ── Word access ──────────────────────────────────────────────────────────── */
 
 /*
- * Little-endian layout (matching x86 / ARM LE):
+ * Little-endian layout (matching x86 / ARM LE), e.g. for a 32-bit word:
  *   byte[addr+0] = bits  7:0
  *   byte[addr+1] = bits 15:8
  *   byte[addr+2] = bits 23:16
  *   byte[addr+3] = bits 31:24
  *
  * We assemble/disassemble manually to avoid UB from type-punning via a
- * cast through uint32_t* (strict-aliasing rules).
+ * cast through word_t* (strict-aliasing rules).  The byte loops have a
+ * constant trip count of MEM_WORD_SIZE and are fully unrolled.
  *
- * TODO(Level-6): if a cache layer is inserted, these functions should call
- * cache_read_word / cache_write_word instead of accessing data[] directly.
+ * The cache model (cache.h) follows these accesses through the trace, so
+ * they always go straight to the pages.
  */
 
-int mem_read_word(const Memory *mem, uint32_t addr, uint32_t *out)
+int mem_read_word(Memory *mem, word_t addr, word_t *out)
 {
     if (!mem) {
         fprintf(stderr, "memory error: NULL memory pointer on read\n");
         return -1;
     }
-    if (check_access(addr, "read") != 0) return -1;
+    if (check_access(mem, addr, "read") != 0) return -1;
 
-    *out = (uint32_t)mem->data[addr]
-         | ((uint32_t)mem->data[addr + 1] << 8)
-         | ((uint32_t)mem->data[addr + 2] << 16)
-         | ((uint32_t)mem->data[addr + 3] << 24);
+    uint32_t vpn   = (uint32_t)((uint64_t)addr >> MEM_PAGE_BITS);
+    MemPage *page  = translate(mem, vpn, 0);
+    word_t   value = 0;
+    if (page) {
+        const uint8_t *b = &page->data[addr & (MEM_PAGE_SIZE - 1u)];
+        for (unsigned i = 0; i < MEM_WORD_SIZE; i++)
+            value |= (word_t)((word_t)b[i] << (8u * i));
+        MEM_COUNT(page->heat[mem->heat_on][0]);
+    } else if (MEM_STATS && mem->heat_on) {
+        cold_count(mem, vpn);
+    }
+    *out = value;
+    MEM_COUNT(mem->read_count);
     return 0;
 }
 
-int mem_write_word(Memory *mem, uint32_t addr, uint32_t value)
+int mem_write_word(Memory *mem, word_t addr, word_t value)
 {
     if (!mem) {
         fprintf(stderr, "memory error: NULL memory pointer on write\n");
         return -1;
     }
-    if (check_access(addr, "write") != 0) return -1;
+    if (check_access(mem, addr, "write") != 0) return -1;
 
-    mem->data[addr]     = (uint8_t)(value        & 0xFFu);
-    mem->data[addr + 1] = (uint8_t)((value >> 8)  & 0xFFu);
-    mem->data[addr + 2] = (uint8_t)((value >> 16) & 0xFFu);
-    mem->data[addr + 3] = (uint8_t)((value >> 24) & 0xFFu);
+    uint32_t vpn  = (uint32_t)((uint64_t)addr >> MEM_PAGE_BITS);
+    MemPage *page = translate(mem, vpn, 1);
+    uint8_t *b    = &page->data[addr & (MEM_PAGE_SIZE - 1u)];
+    for (unsigned i = 0; i < MEM_WORD_SIZE; i++)
+        b[i] = (uint8_t)((value >> (8u * i)) & 0xFFu);
+    MEM_COUNT(page->heat[mem->heat_on][1]);
+    MEM_COUNT(mem->write_count);
     return 0;
 }
+
+/* ── Statistics ───────────────────────────────────────────────────────────── */
+
+void mem_stats_reset(Memory *mem)
+{
+    MemPage *p;
+
+    mem->read_count    = 0;
+    mem->write_count   = 0;
+    mem->align_faults  = 0;
+    mem->bounds_faults = 0;
+    for (uint64_t vpn = 0; (p = next_page(mem, &vpn)) != NULL; vpn++)
+        memset(p->heat, 0, sizeof(p->heat));
+    cold_clear(&mem->cold);
+}
+
+void mem_heatmap_enable(Memory *mem, int on)
+{
+    MemPage *p;
+
+    mem->heat_on = on != 0;
+    for (uint64_t vpn = 0; (p = next_page(mem, &vpn)) != NULL; vpn++)
+        memset(p->heat, 0, sizeof(p->heat));
+    cold_clear(&mem->cold);
+}
+
+void mem_page_heat(const Memory *mem, uint32_t page, uint64_t *reads,
+                   uint64_t *writes)
+{
+    const MemPage *p = page < MEM_VPNS ? page_lookup(mem, page) : NULL;
+
+    *reads  = (p ? p->heat[1][0] : 0)
+            + (page < MEM_VPNS ? cold_reads(&mem->cold, page) : 0);
+    *writes = p ? p->heat[1][1] : 0;
+}
+
+void mem_print_stats(const Memory *mem, FILE *out)
+{
+    fprintf(out, "MEMORY STATS: reads %llu, writes %llu, alignment faults "
+                 "%llu, bounds faults %llu, resident pages %llu\n",
+            (unsigned long long)mem->read_count,
+            (unsigned long long)mem->write_count,
+            (unsigned long long)mem->align_faults,
+            (unsigned long long)mem->bounds_faults,
+            (unsigned long long)mem->resident);
+}
+
+static int u32_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+void mem_heatmap_csv(const Memory *mem, FILE *out)
+{
+    const MemPage *p;
+
+    fprintf(out, "page,address,reads,writes\n");
+    if (!mem->heat_on)
+        return;
+
+    /* Pages with cold reads, in order, merged with the allocated ones. */
+    const MemColdReads *c    = &mem->cold;
+    uint32_t           *cold = zalloc((c->used ? c->used : 1)
+                                      * sizeof(uint32_t));
+    uint32_t            n    = 0, k = 0;
+    for (uint32_t i = 0; i < c->size; i++)
+        if (c->key[i] != 0)
+            cold[n++] = c->key[i] - 1;
+    qsort(cold, n, sizeof(uint32_t), u32_cmp);
+
+    uint64_t vpn = 0;
+    p = next_page(mem, &vpn);
+    while (p || k < n) {
+        uint64_t page = p && (k == n || vpn <= cold[k]) ? vpn : cold[k];
+        uint64_t reads, writes;
+        mem_page_heat(mem, (uint32_t)page, &reads, &writes);
+        if (reads != 0 || writes != 0)
+            fprintf(out, "%llu,0x%08llx,%llu,%llu\n",
+                    (unsigned long long)page,
+                    (unsigned long long)(page << MEM_PAGE_BITS),
+                    (unsigned long long)reads, (unsigned long long)writes);
+        if (k < n && cold[k] == page)
+            k++;
+        if (p && vpn == page) {
+            vpn++;
+            p = next_page(mem, &vpn);
+        }
+    }
+    free(cold);
+}
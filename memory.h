@@ -3,62 +3,164 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
+
+#include "word.h"
 
 /*
- * Memory subsystem — Level-5 flat RAM.
+ * Memory subsystem — Level-5 RAM, sparse over a 32-bit address space.
  *
  * Design:
- *   - 64 KB flat byte-addressable address space.
- *   - All programmer-visible access is 32-bit word-width (4 bytes).
- *   - Addresses must be 4-byte aligned; violations are fatal errors.
+ *   - 4 GB byte-addressable address space (MEM_SIZE), of which only the
+ *     pages a program writes take host memory.
+ *   - All programmer-visible access is word-width (MEM_WORD_SIZE bytes:
+ *     4 for the default 32-bit machine, see word.h).
+ *   - Addresses must be word-aligned; violations are fatal errors.  A
+ *     64-bit word can also address past MEM_SIZE, which is one too.
  *   - The CPU holds a pointer to Memory but does NOT own it; the caller
- *     (main.c or a test harness) allocates and frees it.
+ *     (main.c or a test harness) allocates it and releases it with
+ *     mem_free.
+ *
+ * Paging: MEM_PAGE_SIZE-byte pages behind a two-level table, a directory
+ * of MEM_DIR_ENTRIES tables of MEM_TABLE_ENTRIES pages, both allocated
+ * zeroed on the first write into their range.  Reads of a page never
+ * written return zero without allocating it.  The last page translated
+ * is remembered, so runs of accesses to one page skip the table walk.
+ * An aligned word never straddles a page.  mem_reset zeroes the pages in
+ * place, so a Memory reused for run after run stops allocating once it
+ * has the pages its programs touch.
  *
  * Forward-compatibility notes (for future levels):
- *   - TODO(Level-6): insert a cache layer between CPU and mem_read/mem_write.
- *     The cache would intercept these calls, check its tag array, and fall
- *     through to mem_read/mem_write only on a miss.
- *   - TODO(Level-6): add `uint64_t read_count, write_count` statistics fields
- *     to Memory so cache hit-rate analysis has ground truth.
- *   - TODO(Level-7): add a `uint32_t latency_cycles` field per access for
- *     pipeline stall simulation.
- *   - The `data` array is kept as a plain flat buffer intentionally so that
- *     a future virtual-memory layer can overlay page tables on top.
+ *   - Level-6: the cache model (cache.h) sits between the CPU and these
+ *     calls as a trace sink: it sees every access the CPU makes, while
+ *     runs without it keep the direct path.
+ *   - Level-6: the statistics below give that analysis its ground truth.
+ *   - Level-7: `latency_cycles` is what an access that misses every cache
+ *     level costs in the cache hierarchy's latency model.
+ *
+ * Statistics: every Memory counts its successful reads and writes and its
+ * alignment and bounds faults, and can keep a per-page read/write
+ * histogram (mem_heatmap_enable) to dump as CSV after a run.  The word
+ * accesses stay branch-free either way: each page has a counter pair for
+ * the heatmap on and one for it off, picked by `heat_on`.  Reads of pages
+ * never written are counted in a small side table instead, so the
+ * heatmap does not change which pages are allocated.
+ * Build with -DMEM_STATS=0 to compile all of it out of the access path.
  */
 
-#define MEM_SIZE (64u * 1024u)   /* 64 KB address space */
-#define MEM_WORD_SIZE 4u         /* 32-bit word = 4 bytes */
+#ifndef MEM_STATS
+#  define MEM_STATS 1
+#endif
+
+#define MEM_ADDR_BITS     32
+#define MEM_SIZE          (UINT64_C(1) << MEM_ADDR_BITS)  /* 4 GB */
+#define MEM_WORD_SIZE     ((unsigned)WORD_BYTES)   /* 4 for a 32-bit word */
+#define MEM_LATENCY       100u   /* default main-memory latency, in cycles */
+#define MEM_PAGE_BITS     12
+#define MEM_PAGE_SIZE     (1u << MEM_PAGE_BITS)    /* 4 KB */
+#define MEM_TABLE_BITS    10
+#define MEM_TABLE_ENTRIES (1u << MEM_TABLE_BITS)
+#define MEM_DIR_BITS      (MEM_ADDR_BITS - MEM_TABLE_BITS - MEM_PAGE_BITS)
+#define MEM_DIR_ENTRIES   (1u << MEM_DIR_BITS)
+#define MEM_RESET_KEEP    1024u  /* pages mem_reset zeroes, not frees (4 MB) */
+
+typedef struct {
+    uint8_t  data[MEM_PAGE_SIZE];
+    uint64_t heat[2][2];      /* [heatmap on][0 read, 1 write] accesses   */
+} MemPage;
+
+typedef struct {
+    MemPage *page[MEM_TABLE_ENTRIES];
+} MemTable;
+
+/* Heatmap reads of pages not allocated: open-addressed, vpn + 1 as key. */
+typedef struct {
+    uint32_t *key;            /* 0 = free                                 */
+    uint64_t *reads;
+    uint32_t  size;           /* power of two, kept at most half full     */
+    uint32_t  used;
+} MemColdReads;
 
 typedef struct {
-    uint8_t data[MEM_SIZE];
-    /* TODO(Level-6): uint64_t read_count, write_count; */
+    MemTable *dir[MEM_DIR_ENTRIES];
+    uint32_t  last_vpn;       /* page number of the last translation ...  */
+    MemPage  *last_page;      /* ... and its page; NULL = none            */
+    uint64_t  resident;       /* pages allocated                          */
+    uint32_t  latency_cycles; /* cycles per access reaching RAM (cache.h) */
+
+    uint64_t  read_count;     /* successful word reads                    */
+    uint64_t  write_count;    /* successful word writes                   */
+    uint64_t  align_faults;   /* accesses rejected as unaligned           */
+    uint64_t  bounds_faults;  /* accesses rejected as out of bounds       */
+    int       heat_on;        /* heatmap slot the accesses count in       */
+    MemColdReads cold;        /* heatmap reads of unallocated pages       */
 } Memory;
 
 /* ── Lifecycle ────────────────────────────────────────────────────────────── */
 
-/* Zero-initialize all RAM.  Must be called before any access. */
+/* Set up an empty Memory (all RAM zero, nothing allocated), statistics
+ * zeroed, latency MEM_LATENCY, heatmap off.  Must be called before any
+ * access. */
 void mem_init(Memory *mem);
 
+/*
+ * Back to the state after mem_init for reuse of an initialised (or static,
+ * zero-filled) Memory, except that allocated pages are zeroed and kept
+ * rather than freed.  With more than MEM_RESET_KEEP resident, as after a
+ * scattered run, they are all released instead.
+ */
+void mem_reset(Memory *mem);
+
+/* Release every page; `mem` is then empty, as after mem_init. */
+void mem_free(Memory *mem);
+
+/* Make initialised `dst` a deep copy of `src`: RAM, latency, statistics.
+ * Pages `dst` already has are reused. */
+void mem_copy(Memory *dst, const Memory *src);
+
+/* 1 if `a` and `b` hold the same bytes everywhere, else 0. */
+int mem_equal(const Memory *a, const Memory *b);
+
 /* ── Word access ──────────────────────────────────────────────────────────── */
 
 /*
- * mem_read_word — load a 32-bit word from address `addr`.
+ * mem_read_word — load a word from address `addr`.
  *
  * Requirements:
- *   addr must be 4-byte aligned.
- *   addr + 4 must be <= MEM_SIZE.
+ *   addr must be MEM_WORD_SIZE-aligned.
+ *   addr + MEM_WORD_SIZE must be <= MEM_SIZE.
  *
- * On success, stores the value in *out and returns 0.
+ * On success, stores the value in *out (0 if never written) and returns 0.
  * On error (bounds / alignment), prints to stderr and returns -1.
  */
-int mem_read_word(const Memory *mem, uint32_t addr, uint32_t *out);
+int mem_read_word(Memory *mem, word_t addr, word_t *out);
 
 /*
- * mem_write_word — store a 32-bit word at address `addr`.
+ * mem_write_word — store a word at address `addr`, allocating its page on
+ * first use.
  *
  * Same alignment and bounds requirements as mem_read_word.
  * On success returns 0; on error prints to stderr and returns -1.
  */
-int mem_write_word(Memory *mem, uint32_t addr, uint32_t value);
+int mem_write_word(Memory *mem, word_t addr, word_t value);
+
+/* ── Statistics ───────────────────────────────────────────────────────────── */
+
+/* Reset the counters and the heatmap (the RAM contents are kept). */
+void mem_stats_reset(Memory *mem);
+
+/* Start (on != 0) or stop keeping the per-page heatmap; clears it. */
+void mem_heatmap_enable(Memory *mem, int on);
+
+/* Heatmap counts of page number `page` (zero if never allocated). */
+void mem_page_heat(const Memory *mem, uint32_t page, uint64_t *reads,
+                   uint64_t *writes);
+
+/* "MEMORY STATS: ..." line: reads, writes, faults and resident pages. */
+void mem_print_stats(const Memory *mem, FILE *out);
+
+/* Heatmap as CSV, "page,address,reads,writes" then one row per page
+ * with any accesses.  Writes just the header if the heatmap is off. */
+void mem_heatmap_csv(const Memory *mem, FILE *out);
 
 #endif /* MEMORY_H */
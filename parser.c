@@ -39,9 +39,8 @@ static Token expect(Parser *p, TokenType expected)
  *
  * Lowest-level production; handles atoms and grouping.
  *
- * NOTE (future Level-2 extension): unary operators can be added here:
- *   factor → ('+' | '-') factor | NUMBER | '(' expr ')'
- * This would require a NODE_UNARY_OP AST node and a corresponding eval case.
+ * NOTE (future Level-2 extension): unary +/- can join '~' in parse_unary:
+ *   unary → ('+' | '-' | '~') unary | factor
  */
 Node *parse_factor(Parser *p)
 {
@@ -70,65 +69,109 @@ Node *parse_factor(Parser *p)
 }
 
 /*
- * term → factor (('*' | '/') factor)*
+ * unary → '~' unary | factor
  *
- * Handles multiplication and division (higher precedence than +/-).
- * Left-associative via the iterative loop.
+ * Bitwise NOT binds tighter than every binary operator, as in C.
  */
-Node *parse_term(Parser *p)
+Node *parse_unary(Parser *p)
 {
     if (p->error) return NULL;
 
-    Node *left = parse_factor(p);
-    if (p->error) { ast_free(left); return NULL; }
-
-    for (;;) {
-        Token t = lexer_peek(p->ts);
-        if (t.type != TOK_MUL && t.type != TOK_DIV)
-            break;
-
-        lexer_next(p->ts); /* consume operator */
-        BinaryOp op = (t.type == TOK_MUL) ? OP_MUL : OP_DIV;
-
-        Node *right = parse_factor(p);
-        if (p->error) { ast_free(left); ast_free(right); return NULL; }
-
-        left = ast_make_binary(op, left, right);
+    if (lexer_peek(p->ts).type == TOK_TILDE) {
+        lexer_next(p->ts); /* consume '~' */
+        Node *operand = parse_unary(p);
+        if (p->error) { ast_free(operand); return NULL; }
+        return ast_make_unary(OP_NOT, operand);
     }
-
-    return left;
+    return parse_factor(p);
 }
 
 /*
- * expr → term (('+' | '-') term)*
+ * One left-associative binary level:  operand (op operand)*
  *
- * Handles addition and subtraction (lowest precedence).
- * Left-associative via the iterative loop.
+ * toks[k] is the token for ops[k].  Shared by every level from term up;
+ * the iterative loop gives left associativity.
  */
-Node *parse_expr(Parser *p)
+static Node *parse_level(Parser *p, Node *(*operand)(Parser *),
+                         const TokenType *toks, const BinaryOp *ops,
+                         size_t n)
 {
     if (p->error) return NULL;
 
-    Node *left = parse_term(p);
+    Node *left = operand(p);
     if (p->error) { ast_free(left); return NULL; }
 
     for (;;) {
-        Token t = lexer_peek(p->ts);
-        if (t.type != TOK_PLUS && t.type != TOK_MINUS)
+        Token  t = lexer_peek(p->ts);
+        size_t k = 0;
+        while (k < n && toks[k] != t.type)
+            k++;
+        if (k == n)
             break;
 
         lexer_next(p->ts); /* consume operator */
-        BinaryOp op = (t.type == TOK_PLUS) ? OP_ADD : OP_SUB;
 
-        Node *right = parse_term(p);
+        Node *right = operand(p);
         if (p->error) { ast_free(left); ast_free(right); return NULL; }
 
-        left = ast_make_binary(op, left, right);
+        left = ast_make_binary(ops[k], left, right);
     }
 
     return left;
 }
 
+/* term → unary (('*' | '/' | '%') unary)* */
+Node *parse_term(Parser *p)
+{
+    static const TokenType toks[] = { TOK_MUL, TOK_DIV, TOK_MOD };
+    static const BinaryOp  ops[]  = { OP_MUL,  OP_DIV,  OP_MOD  };
+    return parse_level(p, parse_unary, toks, ops, 3);
+}
+
+/* sum → term (('+' | '-') term)* */
+Node *parse_sum(Parser *p)
+{
+    static const TokenType toks[] = { TOK_PLUS, TOK_MINUS };
+    static const BinaryOp  ops[]  = { OP_ADD,   OP_SUB    };
+    return parse_level(p, parse_term, toks, ops, 2);
+}
+
+/* shift → sum (('<<' | '>>' | '>>>') sum)* */
+Node *parse_shift(Parser *p)
+{
+    static const TokenType toks[] = { TOK_SHL, TOK_SHR, TOK_USHR };
+    static const BinaryOp  ops[]  = { OP_SHL,  OP_ASR,  OP_LSR   };
+    return parse_level(p, parse_sum, toks, ops, 3);
+}
+
+/* and → shift ('&' shift)* */
+Node *parse_and(Parser *p)
+{
+    static const TokenType toks[] = { TOK_AMP };
+    static const BinaryOp  ops[]  = { OP_AND  };
+    return parse_level(p, parse_shift, toks, ops, 1);
+}
+
+/* xor → and ('^' and)* */
+Node *parse_xor(Parser *p)
+{
+    static const TokenType toks[] = { TOK_CARET };
+    static const BinaryOp  ops[]  = { OP_XOR    };
+    return parse_level(p, parse_and, toks, ops, 1);
+}
+
+/*
+ * expr → xor ('|' xor)*
+ *
+ * Bitwise OR has the lowest precedence.
+ */
+Node *parse_expr(Parser *p)
+{
+    static const TokenType toks[] = { TOK_PIPE };
+    static const BinaryOp  ops[]  = { OP_OR    };
+    return parse_level(p, parse_xor, toks, ops, 1);
+}
+
 /* ── Public entry point ───────────────────────────────────────────────────── */
 
 void parser_init(Parser *p, TokenStream *ts)
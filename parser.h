@@ -20,17 +20,30 @@ void  parser_init(Parser *p, TokenStream *ts);
  * Entry point.  Returns the root AST node, or NULL on error.
  * On success, the entire input must have been consumed (TOK_EOF).
  *
- * Grammar (classic additive/multiplicative precedence):
+ * Grammar (C precedence, lowest first; all binary levels left-associative):
  *
- *   expr   → term   (('+' | '-') term)*
- *   term   → factor (('*' | '/') factor)*
+ *   expr   → xor    ('|' xor)*
+ *   xor    → and    ('^' and)*
+ *   and    → shift  ('&' shift)*
+ *   shift  → sum    (('<<' | '>>' | '>>>') sum)*
+ *   sum    → term   (('+' | '-') term)*
+ *   term   → unary  (('*' | '/' | '%') unary)*
+ *   unary  → '~' unary | factor
  *   factor → NUMBER | '(' expr ')'
+ *
+ * '/' and '%' are signed (truncating toward zero); '>>' is the arithmetic
+ * shift, '>>>' the logical one.
  */
 Node *parser_parse(Parser *p);
 
 /* Individual grammar productions — exposed for unit testing. */
 Node *parse_expr(Parser *p);
+Node *parse_xor(Parser *p);
+Node *parse_and(Parser *p);
+Node *parse_shift(Parser *p);
+Node *parse_sum(Parser *p);
 Node *parse_term(Parser *p);
+Node *parse_unary(Parser *p);
 Node *parse_factor(Parser *p);
 
 #endif /* PARSER_H */
@@ -0,0 +1,219 @@
+#include "pipeline.h"
+
+#include <string.h>
+
+/*
+ * Stage offsets relative to EX: IF = EX-2, ID = EX-1, MEM = EX+1,
+ * WB = EX+2.  Only EX cycles are tracked; everything else follows.
+ */
+#define EX_TO_WB 2
+
+/* ── Configuration ────────────────────────────────────────────────────────── */
+
+PipelineConfig pipeline_default_config(void)
+{
+    return (PipelineConfig){ .forwarding     = 1,
+                             .load_use_stall = 1,
+                             .branch_penalty = 2 };
+}
+
+void pipeline_init(PipelineModel *pm, const PipelineConfig *cfg,
+                   const TraceSink *next)
+{
+    memset(pm, 0, sizeof(*pm));
+    pm->cfg  = cfg ? *cfg : pipeline_default_config();
+    pm->next = next;
+
+    /* The first instruction reaches EX in cycle 3 (IF 1, ID 2). */
+    pm->ex_cycle = 2;
+}
+
+/* ── Hazard model ─────────────────────────────────────────────────────────── */
+
+/* Operands read by `op`, as PIPELINE_OPERANDS indices; returns the count. */
+static int operands_read(const TraceEvent *ev, int out[3])
+{
+    switch (ev->op) {
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_CMP:
+        case IR_AND:
+        case IR_OR:
+        case IR_XOR:
+        case IR_SHL:
+        case IR_LSR:
+        case IR_ASR:
+        case IR_ROR:
+        case IR_SDIV:
+        case IR_SREM:
+        case IR_UREM:
+        case IR_UMULL:
+        case IR_SMULL:
+            out[0] = ev->dst;
+            out[1] = ev->src;
+            return 2;
+        case IR_MLA:
+            out[0] = ev->dst;
+            out[1] = ev->src;
+            out[2] = ev->addr;
+            return 3;
+        case IR_NOT:
+            out[0] = ev->src;
+            return 1;
+        case IR_JZ:
+        case IR_JNZ:
+            out[0] = PIPELINE_FLAGS;
+            return 1;
+        case IR_LOAD:
+            out[0] = ev->addr;
+            return 1;
+        case IR_STORE:
+            out[0] = ev->src;
+            out[1] = ev->addr;
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+/* Record that `operand` is produced by the instruction in EX at `ex`. */
+static void produce(PipelineModel *pm, int operand, uint64_t ex, int load)
+{
+    uint64_t ready;
+
+    if (!pm->cfg.forwarding)
+        ready = ex + EX_TO_WB + 1;  /* read in ID the cycle of WB */
+    else if (load)
+        ready = ex + 1 + pm->cfg.load_use_stall;
+    else
+        ready = ex + 1;             /* EX->EX bypass */
+
+    pm->ready[operand]     = ready;
+    pm->from_load[operand] = (uint8_t)load;
+}
+
+static void timing_emit(void *ctx, const TraceEvent *ev)
+{
+    PipelineModel *pm = ctx;
+    uint64_t       ex = pm->ex_cycle + 1;  /* no hazard: next cycle */
+    int            rd[3];
+    int            n  = operands_read(ev, rd);
+
+    /* Control hazard: slots squashed behind a taken branch before us. */
+    pm->stats.stall_branch += pm->flush;
+    ex       += pm->flush;
+    pm->flush = 0;
+
+    /* Data hazards: wait for the latest operand; blame its producer. */
+    int      blame_load = 0;
+    uint64_t need       = ex;
+    for (int i = 0; i < n; i++) {
+        int r = rd[i];
+        if (r < 0 || r >= PIPELINE_OPERANDS)
+            continue;
+        if (pm->ready[r] > need) {
+            need       = pm->ready[r];
+            blame_load = pm->from_load[r];
+        }
+    }
+    if (need > ex) {
+        if (blame_load)
+            pm->stats.stall_load_use += need - ex;
+        else
+            pm->stats.stall_data += need - ex;
+        ex = need;
+    }
+
+    /* Structural hazard: a multi-step multiply or divide keeps EX busy. */
+    if (ev->iterations > 1) {
+        pm->stats.stall_muldiv += ev->iterations - 1;
+        ex += ev->iterations - 1;
+    }
+
+    /* Results this instruction produces. */
+    switch (ev->op) {
+        case IR_LOAD_CONST:
+            if (ev->dst >= 0 && ev->dst < PIPELINE_FLAGS)
+                produce(pm, ev->dst, ex, 0);
+            break;
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_AND:
+        case IR_OR:
+        case IR_XOR:
+        case IR_NOT:
+        case IR_SHL:
+        case IR_LSR:
+        case IR_ASR:
+        case IR_ROR:
+        case IR_SDIV:
+        case IR_SREM:
+        case IR_UREM:
+        case IR_MLA:
+            if (ev->dst >= 0 && ev->dst < PIPELINE_FLAGS)
+                produce(pm, ev->dst, ex, 0);
+            produce(pm, PIPELINE_FLAGS, ex, 0);
+            break;
+        case IR_UMULL:
+        case IR_SMULL:
+            if (ev->dst >= 0 && ev->dst < PIPELINE_FLAGS)
+                produce(pm, ev->dst, ex, 0);
+            if (ev->addr >= 0 && ev->addr < PIPELINE_FLAGS)
+                produce(pm, ev->addr, ex, 0);
+            produce(pm, PIPELINE_FLAGS, ex, 0);
+            break;
+        case IR_CMP:
+            produce(pm, PIPELINE_FLAGS, ex, 0);
+            break;
+        case IR_LOAD:
+            if (ev->dst >= 0 && ev->dst < PIPELINE_FLAGS)
+                produce(pm, ev->dst, ex, 1);
+            break;
+        default:
+            break;
+    }
+
+    /* A taken branch squashes the younger IF/ID slots; the next
+     * instruction pays for the refetch (the last one never does). */
+    if (ev->op == IR_JMP
+            || ((ev->op == IR_JZ || ev->op == IR_JNZ) && ev->taken))
+        pm->flush = pm->cfg.branch_penalty;
+
+    pm->ex_cycle = ex;
+    pm->stats.instructions++;
+    pm->stats.cycles = ex + EX_TO_WB;   /* run ends as this leaves WB */
+
+    if (pm->next)
+        pm->next->emit(pm->next->ctx, ev);
+}
+
+TraceSink pipeline_sink(PipelineModel *pm)
+{
+    return (TraceSink){ .emit = timing_emit, .ctx = pm };
+}
+
+/* ── Reporting ────────────────────────────────────────────────────────────── */
+
+double pipeline_cpi(const PipelineStats *stats)
+{
+    if (stats->instructions == 0)
+        return 0.0;
+    return (double)stats->cycles / (double)stats->instructions;
+}
+
+void pipeline_print_stats(const PipelineStats *stats, FILE *out)
+{
+    fprintf(out, "PIPELINE: %llu instructions, %llu cycles, CPI %.2f\n",
+            (unsigned long long)stats->instructions,
+            (unsigned long long)stats->cycles, pipeline_cpi(stats));
+    fprintf(out, "  stalls: load-use %llu, data %llu, branch flush %llu, "
+            "mul/div %llu\n",
+            (unsigned long long)stats->stall_load_use,
+            (unsigned long long)stats->stall_data,
+            (unsigned long long)stats->stall_branch,
+            (unsigned long long)stats->stall_muldiv);
+}
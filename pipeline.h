@@ -0,0 +1,82 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "trace.h"
+
+/*
+ * Pipeline timing model — cycle counts for a classic in-order 5-stage
+ * pipeline (IF ID EX MEM WB), computed from the trace of a functional run.
+ *
+ * The model is a TraceSink: attach pipeline_sink() as CPUOptions.trace (or
+ * to a CPUContext) and every dispatched instruction is timed as it
+ * retires.  Runs without it attached take the trace-free path and pay
+ * nothing.
+ *
+ * Timing rules, with instruction i entering EX one cycle after i-1 unless
+ * held back:
+ *   - Data hazards.  Registers and the flags are tracked as operands.  With
+ *     forwarding, an ALU result feeds the very next EX (no stall) and a
+ *     loaded value is ready one cycle later, so a load immediately
+ *     followed by a consumer stalls `load_use_stall` cycles.  Without
+ *     forwarding, consumers wait until the producer's WB (register file
+ *     written in the first half of the cycle, read in the second).
+ *   - Control hazards.  Branches resolve in EX with predict-not-taken, so
+ *     a taken JMP/JZ/JNZ flushes the IF and ID slots behind it:
+ *     `branch_penalty` cycles.
+ *   - Structural hazards.  A multiply or divide run on the iterative unit
+ *     (ALU_MULDIV_ITERATIVE) holds EX for one cycle per step, so anything
+ *     behind it waits `iterations - 1` cycles; native ones take one cycle.
+ *   - The first instruction needs 4 extra cycles to fill the pipeline.
+ */
+
+typedef struct {
+    int      forwarding;      /* EX->EX and MEM->EX bypass paths (1 = on)  */
+    unsigned load_use_stall;  /* bubbles between a load and its consumer  */
+    unsigned branch_penalty;  /* flushed slots per taken branch           */
+} PipelineConfig;
+
+typedef struct {
+    uint64_t instructions;
+    uint64_t cycles;
+    uint64_t stall_load_use;  /* bubbles waiting on a LOAD result         */
+    uint64_t stall_data;      /* bubbles waiting on any other result      */
+    uint64_t stall_branch;    /* slots flushed by taken branches          */
+    uint64_t stall_muldiv;    /* extra EX cycles of iterative MUL/DIV     */
+} PipelineStats;
+
+/* Register file + flags: the operands the hazard detector tracks. */
+#define PIPELINE_OPERANDS 33
+#define PIPELINE_FLAGS    32   /* operand index of the NZCV flags */
+
+typedef struct {
+    PipelineConfig   cfg;
+    PipelineStats    stats;
+    const TraceSink *next;        /* events are forwarded here if non-NULL */
+
+    /* Hazard state. */
+    uint64_t ex_cycle;                         /* EX of the last instr    */
+    uint64_t flush;                            /* slots the next one lost */
+    uint64_t ready[PIPELINE_OPERANDS];         /* earliest consumer EX    */
+    uint8_t  from_load[PIPELINE_OPERANDS];     /* last producer was LOAD  */
+} PipelineModel;
+
+/* Forwarding on, 1-cycle load-use stall, 2-cycle branch penalty. */
+PipelineConfig pipeline_default_config(void);
+
+/* Reset `pm` for a new run.  cfg NULL = defaults; next may be NULL. */
+void pipeline_init(PipelineModel *pm, const PipelineConfig *cfg,
+                   const TraceSink *next);
+
+/* Sink that feeds `pm` (and then pm->next). */
+TraceSink pipeline_sink(PipelineModel *pm);
+
+/* Cycles per instruction of the run so far (0 if nothing ran). */
+double pipeline_cpi(const PipelineStats *stats);
+
+/* "PIPELINE: ..." summary: cycles, CPI and the stall breakdown. */
+void pipeline_print_stats(const PipelineStats *stats, FILE *out);
+
+#endif /* PIPELINE_H */
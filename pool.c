@@ -0,0 +1,362 @@
+/*
+ * pool.c — work-stealing job pool (see pool.h).
+ */
+
+#define _POSIX_C_SOURCE 200809L   /* clock_gettime, sysconf */
+
+#include "pool.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CACHE_LINE 64
+
+/* ── Chase–Lev deque ──────────────────────────────────────────────────────── */
+
+/*
+ * Fixed-capacity Chase–Lev work-stealing deque of job indices, with the
+ * C11 memory orderings of Lê et al., "Correct and Efficient Work-Stealing
+ * for Weak Memory Models" (PPoPP 2013).  The owner pushes and takes at
+ * `bottom`; thieves steal at `top`.  Capacity never has to grow because
+ * every job is pushed before the workers start.
+ */
+
+#define DEQUE_EMPTY (-1)
+#define DEQUE_ABORT (-2)   /* lost a race with another thief; retry later */
+
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic int64_t top;
+    _Alignas(CACHE_LINE) _Atomic int64_t bottom;
+    _Atomic int64_t *buf;
+    int64_t          mask;   /* capacity - 1 (capacity is a power of two) */
+} Deque;
+
+static void deque_init(Deque *d, size_t min_capacity)
+{
+    size_t cap = 1;
+    while (cap < min_capacity)
+        cap <<= 1;
+
+    d->buf = malloc(cap * sizeof(*d->buf));
+    if (!d->buf) { perror("malloc"); exit(EXIT_FAILURE); }
+    d->mask = (int64_t)cap - 1;
+    atomic_init(&d->top, 0);
+    atomic_init(&d->bottom, 0);
+}
+
+static void deque_free(Deque *d)
+{
+    free(d->buf);
+    d->buf = NULL;
+}
+
+/* Owner only. */
+static void deque_push(Deque *d, int64_t x)
+{
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    atomic_store_explicit(&d->buf[b & d->mask], x, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+}
+
+/* Owner only: LIFO end. */
+static int64_t deque_take(Deque *d)
+{
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {   /* empty */
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return DEQUE_EMPTY;
+    }
+
+    int64_t x = atomic_load_explicit(&d->buf[b & d->mask],
+                                     memory_order_relaxed);
+    if (t == b) {  /* last element: race thieves for it */
+        if (!atomic_compare_exchange_strong_explicit(
+                    &d->top, &t, t + 1,
+                    memory_order_seq_cst, memory_order_relaxed))
+            x = DEQUE_EMPTY;
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return x;
+}
+
+/* Any thread: FIFO end. */
+static int64_t deque_steal(Deque *d)
+{
+    int64_t t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (t >= b)
+        return DEQUE_EMPTY;
+
+    int64_t x = atomic_load_explicit(&d->buf[t & d->mask],
+                                     memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(
+                &d->top, &t, t + 1,
+                memory_order_seq_cst, memory_order_relaxed))
+        return DEQUE_ABORT;
+    return x;
+}
+
+/* ── Workers ──────────────────────────────────────────────────────────────── */
+
+typedef struct Pool Pool;
+
+typedef struct {
+    Deque           deque;
+    Pool           *pool;
+    size_t          id;
+    uint32_t        rng;        /* victim selection                  */
+    pthread_t       thread;
+    PoolWorkerStats stats;
+    int             mem_dirty;  /* RAM touched since last zeroing    */
+    Memory          mem;        /* reused by every job on this worker */
+} Worker;
+
+struct Pool {
+    PoolJob        *jobs;
+    const CPUCode **code;       /* per job: its program's prepared code */
+    Worker         *workers;
+    size_t          n_workers;
+    CPUCore         core;
+};
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void run_job(Worker *w, PoolJob *job, const CPUCode *code)
+{
+    const IRProgram *prog = job->prog;
+    Memory          *mem  = NULL;
+
+    /* Only programs that touch RAM pay for resetting it. */
+    if (prog && prog->uses_memory) {
+        if (job->mem_in)
+            mem_copy(&w->mem, job->mem_in);
+        else if (w->mem_dirty)
+            mem_reset(&w->mem);
+        w->mem_dirty = 1;
+        mem = &w->mem;
+    }
+
+    CPUOptions opts = { .max_steps = job->max_steps, .core = w->pool->core,
+                        .code = code };
+    job->result = 0;
+    job->status = cpu_execute_verified(prog, mem, &job->result, &opts);
+
+    if (job->mem_out) {
+        if (mem)
+            mem_copy(job->mem_out, mem);
+        else if (job->mem_in)
+            mem_copy(job->mem_out, job->mem_in);
+        else
+            mem_reset(job->mem_out);
+    }
+}
+
+/* Next job index for `w`: own deque first, then steal.  -1 when done. */
+static int64_t next_job(Worker *w)
+{
+    int64_t x = deque_take(&w->deque);
+    if (x >= 0)
+        return x;
+
+    Pool  *pool = w->pool;
+    size_t n    = pool->n_workers;
+    for (;;) {
+        int aborted = 0;
+        /* xorshift32 start point, then one sweep over every victim. */
+        w->rng ^= w->rng << 13;
+        w->rng ^= w->rng >> 17;
+        w->rng ^= w->rng << 5;
+        size_t start = w->rng % n;
+        for (size_t k = 0; k < n; k++) {
+            Worker *victim = &pool->workers[(start + k) % n];
+            if (victim == w)
+                continue;
+            x = deque_steal(&victim->deque);
+            if (x >= 0) {
+                w->stats.steals++;
+                return x;
+            }
+            aborted |= x == DEQUE_ABORT;
+        }
+        if (!aborted)
+            return -1;   /* nothing is ever pushed again: all drained */
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    Worker *w = arg;
+    int64_t x;
+
+    while ((x = next_job(w)) >= 0) {
+        double t0 = now_seconds();
+        run_job(w, &w->pool->jobs[x], w->pool->code[x]);
+        w->stats.busy_seconds += now_seconds() - t0;
+        w->stats.jobs++;
+    }
+    return NULL;
+}
+
+/* ── Prepared code ────────────────────────────────────────────────────────── */
+
+/*
+ * code[j] = the CPUCode of jobs[j].prog, prepared once per distinct program
+ * (found through an open-addressed table keyed by address) and appended to
+ * *owned for release.  Nothing is prepared for the switch core.
+ */
+static const CPUCode **prepare_code(const PoolJob *jobs, size_t n_jobs,
+                                    CPUCore core, CPUCode ***owned,
+                                    size_t *n_owned)
+{
+    const CPUCode **code = calloc(n_jobs ? n_jobs : 1, sizeof(*code));
+    if (!code) { perror("calloc"); exit(EXIT_FAILURE); }
+    *owned   = NULL;
+    *n_owned = 0;
+    if (core == CPU_CORE_SWITCH)
+        return code;
+
+    size_t size = 1;
+    while (size < 2 * n_jobs)
+        size <<= 1;
+    const IRProgram **key  = calloc(size, sizeof(*key));
+    CPUCode         **slot = calloc(size, sizeof(*slot));
+    *owned = calloc(n_jobs ? n_jobs : 1, sizeof(**owned));
+    if (!key || !slot || !*owned) { perror("calloc"); exit(EXIT_FAILURE); }
+
+    for (size_t j = 0; j < n_jobs; j++) {
+        const IRProgram *prog = jobs[j].prog;
+        size_t i = (size_t)(((uintptr_t)prog >> 4) * 0x9E3779B97F4A7C15ull)
+                 & (size - 1);
+
+        while (slot[i] && key[i] != prog)
+            i = (i + 1) & (size - 1);
+        if (!slot[i]) {
+            key[i]  = prog;
+            slot[i] = (*owned)[(*n_owned)++] = cpu_prepare(prog, core);
+        }
+        code[j] = slot[i];
+    }
+    free(key);
+    free(slot);
+    return code;
+}
+
+/* ── Entry points ─────────────────────────────────────────────────────────── */
+
+size_t pool_default_workers(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1)
+        return 1;
+    return (size_t)n < POOL_MAX_WORKERS ? (size_t)n : POOL_MAX_WORKERS;
+}
+
+int pool_run(PoolJob *jobs, size_t n_jobs, size_t workers, CPUCore core,
+             PoolStats *stats)
+{
+    if (workers == 0)
+        workers = pool_default_workers();
+    if (workers > POOL_MAX_WORKERS)
+        workers = POOL_MAX_WORKERS;
+
+    /* Worker records hold aligned deques: allocate them cache-aligned. */
+    size_t bytes = workers * sizeof(Worker);
+    bytes = (bytes + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    Worker *ws = aligned_alloc(CACHE_LINE, bytes);
+    if (!ws) { perror("aligned_alloc"); exit(EXIT_FAILURE); }
+    memset(ws, 0, bytes);
+
+    CPUCode **owned;
+    size_t    n_owned;
+    Pool pool = { .jobs = jobs, .workers = ws, .n_workers = workers,
+                  .core = core,
+                  .code = prepare_code(jobs, n_jobs, core, &owned,
+                                       &n_owned) };
+
+    size_t per_worker = (n_jobs + workers - 1) / workers;
+    for (size_t i = 0; i < workers; i++) {
+        ws[i].pool = &pool;
+        ws[i].id   = i;
+        ws[i].rng  = (uint32_t)(0x9E3779B9u * (i + 1));
+        deque_init(&ws[i].deque, per_worker ? per_worker : 1);
+        mem_init(&ws[i].mem);
+    }
+
+    /* Deal in reverse so each owner takes its jobs in ascending order. */
+    for (size_t j = n_jobs; j-- > 0; )
+        deque_push(&ws[j % workers].deque, (int64_t)j);
+
+    double t0 = now_seconds();
+
+    /* Worker 0 is the calling thread. */
+    for (size_t i = 1; i < workers; i++) {
+        if (pthread_create(&ws[i].thread, NULL, worker_main, &ws[i]) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    worker_main(&ws[0]);
+    for (size_t i = 1; i < workers; i++)
+        pthread_join(ws[i].thread, NULL);
+
+    double wall = now_seconds() - t0;
+
+    size_t failed = 0;
+    for (size_t j = 0; j < n_jobs; j++)
+        failed += jobs[j].status != 0;
+
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+        stats->workers      = workers;
+        stats->jobs         = n_jobs;
+        stats->failed       = failed;
+        stats->wall_seconds = wall;
+        for (size_t i = 0; i < workers; i++)
+            stats->worker[i] = ws[i].stats;
+    }
+
+    for (size_t i = 0; i < workers; i++) {
+        deque_free(&ws[i].deque);
+        mem_free(&ws[i].mem);
+    }
+    free(ws);
+    for (size_t i = 0; i < n_owned; i++)
+        cpu_code_free(owned[i]);
+    free(owned);
+    free(pool.code);
+
+    return failed ? -1 : 0;
+}
+
+void pool_print_stats(const PoolStats *stats, FILE *out)
+{
+    double wall = stats->wall_seconds > 0.0 ? stats->wall_seconds : 1e-9;
+
+    fprintf(out, "pool: %zu jobs (%zu failed) on %zu workers in %.3f s"
+                 "  %.0f jobs/s\n",
+            stats->jobs, stats->failed, stats->workers, stats->wall_seconds,
+            (double)stats->jobs / wall);
+    for (size_t i = 0; i < stats->workers; i++) {
+        const PoolWorkerStats *w = &stats->worker[i];
+        fprintf(out, "  worker %-2zu %8zu jobs  %6zu stolen  "
+                     "%6.1f%% busy\n",
+                i, w->jobs, w->steals, 100.0 * w->busy_seconds / wall);
+    }
+}
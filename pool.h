@@ -0,0 +1,75 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "cpu.h"
+
+/*
+ * Work-stealing pool — runs many independent (IRProgram, Memory) jobs
+ * across host threads.
+ *
+ * Each worker owns a Chase–Lev deque of job indices, dealt round-robin
+ * before the threads start.  A worker pops from the bottom of its own deque
+ * and, once that is empty, steals from the top of a randomly chosen
+ * victim's, so a worker that drew short jobs helps out the ones that drew
+ * long jobs.  Since no job is added after the start, a worker retires as
+ * soon as a sweep over every deque comes back empty.
+ *
+ * Each worker also owns the Memory its jobs run on; RAM is reset (or
+ * loaded from the job's image) only for programs that use LOAD/STORE, in
+ * place: its pages are zeroed or overwritten, not freed (see mem_reset).
+ * Before the workers start, each distinct program is prepared once for the
+ * core (cpu_prepare: the threaded stream or the JIT's native code), so a
+ * job without LOAD/STORE allocates nothing.
+ *
+ * Jobs run on cpu_execute_verified, trace off, so every program must have
+ * passed ir_program_verify.  Errors go to stderr as usual; the job's
+ * status records the outcome.
+ */
+
+#define POOL_MAX_WORKERS 64
+
+typedef struct {
+    /* in */
+    const IRProgram *prog;      /* verified program                         */
+    const Memory    *mem_in;    /* initial RAM image; NULL for zeroed RAM   */
+    Memory          *mem_out;   /* initialised; gets the final RAM if set   */
+    size_t           max_steps; /* 0 selects CPU_MAX_STEPS                  */
+    /* out */
+    int              status;    /* 0 ok, -1 error                           */
+    long             result;    /* as cpu_execute's *out_result             */
+} PoolJob;
+
+typedef struct {
+    size_t jobs;          /* jobs this worker ran                      */
+    size_t steals;        /* of which were stolen from another deque   */
+    double busy_seconds;  /* time spent inside jobs                    */
+} PoolWorkerStats;
+
+typedef struct {
+    size_t          workers;
+    size_t          jobs;
+    size_t          failed;
+    double          wall_seconds;
+    PoolWorkerStats worker[POOL_MAX_WORKERS];
+} PoolStats;
+
+/* Online host CPUs, clamped to [1, POOL_MAX_WORKERS]. */
+size_t pool_default_workers(void);
+
+/*
+ * Run jobs[0..n_jobs) on `workers` threads (0 selects
+ * pool_default_workers(); clamped to POOL_MAX_WORKERS) running `core`.
+ * Fills each job's status/result and, if non-NULL, *stats.
+ *
+ * Returns 0 if every job succeeded, -1 otherwise.
+ */
+int pool_run(PoolJob *jobs, size_t n_jobs, size_t workers, CPUCore core,
+             PoolStats *stats);
+
+/* Aggregate throughput plus one utilization line per worker. */
+void pool_print_stats(const PoolStats *stats, FILE *out);
+
+#endif /* POOL_H */
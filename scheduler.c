@@ -0,0 +1,212 @@
+/*
+ * scheduler.c — quantum-based round-robin scheduler (see scheduler.h).
+ *
+ * Ready jobs wait in one FIFO ring per priority, guarded by a single mutex.
+ * The lock is held only to pick or requeue a job, never while it runs, so
+ * with quanta of a few hundred instructions or more the queue is not a
+ * bottleneck.
+ */
+
+#define _POSIX_C_SOURCE 200809L   /* clock_gettime, sysconf */
+
+#include "scheduler.h"
+#include "cpu_internal.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SCHED_MAX_THREADS 64
+
+/* ── Ready queues ─────────────────────────────────────────────────────────── */
+
+/* Ring of job indices; each job is queued at most once, so n_jobs fits. */
+typedef struct {
+    size_t *slot;
+    size_t  head;
+    size_t  count;
+    size_t  cap;
+} RunQueue;
+
+static void rq_init(RunQueue *q, size_t cap)
+{
+    q->slot = malloc((cap ? cap : 1) * sizeof(size_t));
+    if (!q->slot) { perror("malloc"); exit(EXIT_FAILURE); }
+    q->head  = 0;
+    q->count = 0;
+    q->cap   = cap ? cap : 1;
+}
+
+static void rq_push(RunQueue *q, size_t job)
+{
+    q->slot[(q->head + q->count) % q->cap] = job;
+    q->count++;
+}
+
+static size_t rq_pop(RunQueue *q)
+{
+    size_t job = q->slot[q->head];
+    q->head = (q->head + 1) % q->cap;
+    q->count--;
+    return job;
+}
+
+/* ── Scheduler state ──────────────────────────────────────────────────────── */
+
+typedef struct {
+    SchedJob        *jobs;
+    CPUContext     **ctx;
+    size_t           quantum;
+    double           t0;
+
+    pthread_mutex_t  lock;
+    pthread_cond_t   ready;       /* a job was queued, or all finished */
+    RunQueue         queue[SCHED_PRIORITIES];
+    size_t           remaining;   /* jobs not yet finished             */
+} Sched;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int job_priority(const SchedJob *job)
+{
+    if (job->priority < 0)
+        return 0;
+    if (job->priority >= SCHED_PRIORITIES)
+        return SCHED_PRIORITIES - 1;
+    return job->priority;
+}
+
+/* Highest-priority ready job, or -1.  Caller holds the lock. */
+static int64_t pick(Sched *s)
+{
+    for (int p = SCHED_PRIORITIES - 1; p >= 0; p--)
+        if (s->queue[p].count)
+            return (int64_t)rq_pop(&s->queue[p]);
+    return -1;
+}
+
+/*
+ * Run one quantum of job `j`.  Returns 1 if the job is finished (its
+ * outputs are filled in), 0 if it should be requeued.
+ */
+static int run_slice(Sched *s, size_t j)
+{
+    SchedJob   *job   = &s->jobs[j];
+    CPUContext *ctx   = s->ctx[j];
+    size_t      limit = job->max_steps ? job->max_steps : CPU_MAX_STEPS;
+    size_t      used  = cpu_steps(ctx);
+    size_t      slice = limit - used < s->quantum ? limit - used : s->quantum;
+
+    CPURunStatus status = cpu_run(ctx, slice);
+    job->slices++;
+
+    if (status == CPU_RUN_BUDGET && cpu_steps(ctx) < limit)
+        return 0;
+
+    if (status == CPU_RUN_BUDGET)
+        cpu_report_step_limit(limit, cpu_state(ctx)->pc);
+    job->status = status == CPU_RUN_HALTED ? 0 : -1;
+    job->result = status == CPU_RUN_HALTED ? cpu_result(ctx) : 0;
+    job->steps  = cpu_steps(ctx);
+    job->finish_seconds = now_seconds() - s->t0;
+    return 1;
+}
+
+static void *thread_main(void *arg)
+{
+    Sched *s = arg;
+
+    pthread_mutex_lock(&s->lock);
+    for (;;) {
+        int64_t j;
+        while ((j = pick(s)) < 0 && s->remaining > 0)
+            pthread_cond_wait(&s->ready, &s->lock);
+        if (j < 0)
+            break;   /* everything finished */
+        pthread_mutex_unlock(&s->lock);
+
+        int done = run_slice(s, (size_t)j);
+
+        pthread_mutex_lock(&s->lock);
+        if (done) {
+            if (--s->remaining == 0)
+                pthread_cond_broadcast(&s->ready);
+        } else {
+            rq_push(&s->queue[job_priority(&s->jobs[j])], (size_t)j);
+            pthread_cond_signal(&s->ready);
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+/* ── Entry point ──────────────────────────────────────────────────────────── */
+
+int scheduler_run(SchedJob *jobs, size_t n_jobs, const SchedOptions *opts)
+{
+    size_t threads = opts ? opts->threads : 0;
+    if (threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (size_t)n : 1;
+    }
+    if (threads > SCHED_MAX_THREADS)
+        threads = SCHED_MAX_THREADS;
+
+    Sched s = {
+        .jobs      = jobs,
+        .quantum   = (opts && opts->quantum) ? opts->quantum
+                                             : SCHED_DEFAULT_QUANTUM,
+        .remaining = n_jobs
+    };
+    s.ctx = malloc((n_jobs ? n_jobs : 1) * sizeof(CPUContext *));
+    if (!s.ctx) { perror("malloc"); exit(EXIT_FAILURE); }
+    for (int p = 0; p < SCHED_PRIORITIES; p++)
+        rq_init(&s.queue[p], n_jobs);
+    pthread_mutex_init(&s.lock, NULL);
+    pthread_cond_init(&s.ready, NULL);
+
+    /* Jobs enter their queues in submission order. */
+    for (size_t j = 0; j < n_jobs; j++) {
+        jobs[j].status = -1;
+        jobs[j].result = 0;
+        jobs[j].steps  = 0;
+        jobs[j].slices = 0;
+        s.ctx[j] = cpu_create(jobs[j].prog, jobs[j].mem, NULL);
+        rq_push(&s.queue[job_priority(&jobs[j])], j);
+    }
+
+    s.t0 = now_seconds();
+
+    /* The calling thread is one of the host threads. */
+    pthread_t tid[SCHED_MAX_THREADS];
+    for (size_t i = 1; i < threads; i++) {
+        if (pthread_create(&tid[i], NULL, thread_main, &s) != 0) {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    thread_main(&s);
+    for (size_t i = 1; i < threads; i++)
+        pthread_join(tid[i], NULL);
+
+    int failed = 0;
+    for (size_t j = 0; j < n_jobs; j++) {
+        failed |= jobs[j].status != 0;
+        cpu_destroy(s.ctx[j]);
+    }
+    for (int p = 0; p < SCHED_PRIORITIES; p++)
+        free(s.queue[p].slot);
+    free(s.ctx);
+    pthread_mutex_destroy(&s.lock);
+    pthread_cond_destroy(&s.ready);
+
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,51 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stddef.h>
+
+#include "cpu.h"
+
+/*
+ * Cooperative scheduler — multiplexes many simulated programs over a fixed
+ * set of host threads.
+ *
+ * Every job gets its own CPUContext.  A host thread takes the most urgent
+ * ready job, runs it for one quantum with cpu_run, and puts it back at the
+ * tail of its priority's queue unless it halted, faulted, or used up its
+ * step budget.  Within a priority, jobs take turns (round robin); a ready
+ * job of higher priority always runs before one of lower priority.
+ *
+ * The per-job budget replaces CPU_MAX_STEPS: a job that exceeds it fails
+ * with the usual step-limit error, but since it only ever holds a thread
+ * for one quantum at a time, it no longer delays the jobs queued behind it.
+ */
+
+#define SCHED_PRIORITIES     4       /* 0 (lowest) .. 3 (highest)          */
+#define SCHED_DEFAULT_QUANTUM 1000u  /* instructions per slice             */
+
+typedef struct {
+    /* in */
+    const IRProgram *prog;
+    Memory          *mem;        /* job's RAM (not owned); NULL if unused */
+    int              priority;   /* clamped to [0, SCHED_PRIORITIES)      */
+    size_t           max_steps;  /* step budget; 0 selects CPU_MAX_STEPS  */
+    /* out */
+    int              status;     /* 0 ok, -1 error                        */
+    long             result;     /* as cpu_execute's *out_result          */
+    size_t           steps;      /* instructions executed                 */
+    size_t           slices;     /* quanta the job was scheduled for      */
+    double           finish_seconds;  /* completion time since the start */
+} SchedJob;
+
+typedef struct {
+    size_t threads;   /* host threads; 0 selects the online CPU count    */
+    size_t quantum;   /* instructions per slice; 0 selects the default   */
+} SchedOptions;
+
+/*
+ * Run jobs[0..n_jobs) to completion.  A NULL `opts` selects the defaults.
+ * Returns 0 if every job halted normally, -1 otherwise.
+ */
+int scheduler_run(SchedJob *jobs, size_t n_jobs, const SchedOptions *opts);
+
+#endif /* SCHEDULER_H */
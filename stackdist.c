@@ -0,0 +1,273 @@
+#include "stackdist.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory.h"
+
+#define EMPTY        UINT32_MAX
+#define MIN_CAPACITY 64u
+#define MIN_MAP      16u
+
+/* ── Configuration ────────────────────────────────────────────────────────── */
+
+static int is_pow2(uint32_t x)
+{
+    return x != 0 && (x & (x - 1)) == 0;
+}
+
+static uint32_t log2u(uint32_t x)
+{
+    uint32_t n = 0;
+    while (x >>= 1)
+        n++;
+    return n;
+}
+
+static void *xcalloc(size_t n, size_t size)
+{
+    void *p = calloc(n, size);
+    if (!p) { perror("calloc"); exit(EXIT_FAILURE); }
+    return p;
+}
+
+static void map_alloc(StackDistStack *s, uint32_t size)
+{
+    s->map_size = size;
+    s->key      = xcalloc(size, sizeof(uint32_t));
+    s->stamp    = malloc((size_t)size * sizeof(uint32_t));
+    if (!s->stamp) { perror("malloc"); exit(EXIT_FAILURE); }
+    memset(s->stamp, 0xFF, (size_t)size * sizeof(uint32_t));  /* EMPTY */
+}
+
+int stackdist_init(StackDist *sd, const StackDistConfig *cfg,
+                   const TraceSink *next)
+{
+    memset(sd, 0, sizeof(*sd));
+    sd->cfg  = *cfg;
+    sd->next = next;
+
+    if (!is_pow2(cfg->line_size) || !is_pow2(cfg->sets)
+            || cfg->line_size < MEM_WORD_SIZE) {
+        fprintf(stderr, "stackdist error: line size (%u) and sets (%u) must "
+                        "be powers of two, line size >= a word\n",
+                cfg->line_size, cfg->sets);
+        return -1;
+    }
+
+    sd->offset_bits = log2u(cfg->line_size);
+    sd->stacks      = xcalloc(cfg->sets, sizeof(StackDistStack));
+    for (uint32_t i = 0; i < cfg->sets; i++) {
+        StackDistStack *s = &sd->stacks[i];
+        s->capacity = MIN_CAPACITY;
+        s->tree     = xcalloc((size_t)s->capacity + 1, sizeof(uint32_t));
+        map_alloc(s, MIN_MAP);
+    }
+    sd->hist_len = 64;
+    sd->hist     = xcalloc(sd->hist_len, sizeof(uint64_t));
+    return 0;
+}
+
+void stackdist_free(StackDist *sd)
+{
+    for (uint32_t i = 0; sd->stacks && i < sd->cfg.sets; i++) {
+        free(sd->stacks[i].tree);
+        free(sd->stacks[i].key);
+        free(sd->stacks[i].stamp);
+    }
+    free(sd->stacks);
+    free(sd->hist);
+    sd->stacks = NULL;
+    sd->hist   = NULL;
+}
+
+/* ── Fenwick tree ─────────────────────────────────────────────────────────── */
+
+static void tree_add(StackDistStack *s, uint32_t pos, int32_t delta)
+{
+    for (; pos <= s->capacity; pos += pos & (0u - pos))
+        s->tree[pos] += (uint32_t)delta;
+}
+
+/* 1s at positions 1..pos. */
+static uint32_t tree_prefix(const StackDistStack *s, uint32_t pos)
+{
+    uint32_t sum = 0;
+
+    for (; pos != 0; pos -= pos & (0u - pos))
+        sum += s->tree[pos];
+    return sum;
+}
+
+/*
+ * The time axis is full: renumber the live stamps 0..live-1 in order,
+ * size the axis to twice that (so the next renumbering is at least `live`
+ * accesses away) and rebuild the tree, all 1s up front.  Stamps are below
+ * the axis length, itself at most twice the live count, so bucketing the
+ * slots by stamp orders them in O(n) without a sort.
+ */
+static void renumber(StackDistStack *s)
+{
+    uint32_t *at = xcalloc(s->capacity, sizeof(uint32_t));  /* slot + 1 */
+    uint32_t  n  = 0;
+
+    for (uint32_t i = 0; i < s->map_size; i++)
+        if (s->stamp[i] != EMPTY)
+            at[s->stamp[i]] = i + 1;
+    for (uint32_t t = 0; t < s->capacity; t++)
+        if (at[t] != 0)
+            s->stamp[at[t] - 1] = n++;
+    free(at);
+
+    s->now      = n;
+    s->capacity = 2 * n > MIN_CAPACITY ? 2 * n : MIN_CAPACITY;
+    free(s->tree);
+    s->tree = xcalloc((size_t)s->capacity + 1, sizeof(uint32_t));
+    for (uint32_t pos = 1; pos <= n; pos++)
+        s->tree[pos] = 1;
+    for (uint32_t pos = 1; pos <= s->capacity; pos++) {
+        uint32_t up = pos + (pos & (0u - pos));
+        if (up <= s->capacity)
+            s->tree[up] += s->tree[pos];
+    }
+}
+
+/* ── Line map ─────────────────────────────────────────────────────────────── */
+
+static uint32_t hash32(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+/* Slot holding `line`, or the free slot where it belongs. */
+static uint32_t map_find(const StackDistStack *s, uint32_t line)
+{
+    uint32_t mask = s->map_size - 1;
+    uint32_t i    = hash32(line) & mask;
+
+    while (s->stamp[i] != EMPTY && s->key[i] != line)
+        i = (i + 1) & mask;
+    return i;
+}
+
+static void map_grow(StackDistStack *s)
+{
+    uint32_t *key   = s->key;
+    uint32_t *stamp = s->stamp;
+    uint32_t  size  = s->map_size;
+
+    map_alloc(s, size * 2);
+    for (uint32_t i = 0; i < size; i++) {
+        if (stamp[i] != EMPTY) {
+            uint32_t j = map_find(s, key[i]);
+            s->key[j]   = key[i];
+            s->stamp[j] = stamp[i];
+        }
+    }
+    free(key);
+    free(stamp);
+}
+
+/* ── Access ───────────────────────────────────────────────────────────────── */
+
+static void hist_count(StackDist *sd, uint32_t dist)
+{
+    if (dist >= sd->hist_len) {
+        size_t len = sd->hist_len;
+        while (len <= dist)
+            len *= 2;
+        uint64_t *h = realloc(sd->hist, len * sizeof(uint64_t));
+        if (!h) { perror("realloc"); exit(EXIT_FAILURE); }
+        memset(h + sd->hist_len, 0, (len - sd->hist_len) * sizeof(uint64_t));
+        sd->hist     = h;
+        sd->hist_len = len;
+    }
+    sd->hist[dist]++;
+    if (dist > sd->max_dist)
+        sd->max_dist = dist;
+}
+
+uint32_t stackdist_access(StackDist *sd, uint32_t addr)
+{
+    uint32_t        line = addr >> sd->offset_bits;
+    StackDistStack *s    = &sd->stacks[line & (sd->cfg.sets - 1u)];
+    uint32_t        dist = UINT32_MAX;
+
+    if (s->now == s->capacity)
+        renumber(s);
+
+    uint32_t slot = map_find(s, line);
+    if (s->stamp[slot] != EMPTY) {
+        uint32_t pos = s->stamp[slot] + 1;
+        dist = s->live - tree_prefix(s, pos);
+        tree_add(s, pos, -1);
+        hist_count(sd, dist);
+    } else {
+        s->key[slot] = line;
+        s->live++;
+        sd->cold++;
+    }
+    s->stamp[slot] = s->now;
+    tree_add(s, ++s->now, 1);
+    sd->accesses++;
+
+    if (s->live * 2 > s->map_size)
+        map_grow(s);
+    return dist;
+}
+
+static void stackdist_emit(void *ctx, const TraceEvent *ev)
+{
+    StackDist *sd = ctx;
+
+    if (ev->op == IR_LOAD || ev->op == IR_STORE)
+        stackdist_access(sd, ev->mem_addr);
+    if (sd->next)
+        sd->next->emit(sd->next->ctx, ev);
+}
+
+TraceSink stackdist_sink(StackDist *sd)
+{
+    return (TraceSink){ .emit = stackdist_emit, .ctx = sd };
+}
+
+/* ── Reporting ────────────────────────────────────────────────────────────── */
+
+uint64_t stackdist_misses(const StackDist *sd, uint32_t ways)
+{
+    uint64_t misses = sd->cold;
+
+    for (size_t d = ways; d < sd->hist_len; d++)
+        misses += sd->hist[d];
+    return misses;
+}
+
+void stackdist_print_curve(const StackDist *sd, FILE *out)
+{
+    const StackDistConfig *k = &sd->cfg;
+
+    fprintf(out, "STACK DISTANCE: %llu accesses, %llu cold, %u B lines, ",
+            (unsigned long long)sd->accesses, (unsigned long long)sd->cold,
+            k->line_size);
+    if (k->sets == 1)
+        fprintf(out, "fully associative\n");
+    else
+        fprintf(out, "%u sets\n", k->sets);
+
+    for (uint64_t ways = 1; ways <= UINT32_MAX; ways *= 2) {
+        uint64_t misses = stackdist_misses(sd, (uint32_t)ways);
+        uint64_t bytes  = ways * k->sets * k->line_size;
+
+        fprintf(out, "  %10llu B (%llu %s): misses %llu, miss ratio %.4f\n",
+                (unsigned long long)bytes, (unsigned long long)ways,
+                k->sets == 1 ? "lines" : "ways", (unsigned long long)misses,
+                sd->accesses ? (double)misses / (double)sd->accesses : 0.0);
+        if (ways > sd->max_dist)
+            break;
+    }
+}
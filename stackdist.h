@@ -0,0 +1,89 @@
+#ifndef STACKDIST_H
+#define STACKDIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "trace.h"
+
+/*
+ * Stack-distance analysis — the LRU miss-ratio curve of a run, for every
+ * cache size at once.
+ *
+ * An access's stack distance is the number of distinct lines touched since
+ * the previous access to its line (infinite on the first: a cold miss).
+ * An LRU cache holding W lines hits exactly the accesses with distance
+ * below W, so one histogram of distances gives the misses of every size
+ * (Mattson et al.).  With `sets` > 1 each set keeps its own stack, indexed
+ * like cache.h (block mod sets), and W is the associativity: the curve is
+ * then that of every LRU cache with this line size and set count.
+ *
+ * Each stack is a Fenwick tree over access times holding a 1 at the time
+ * of each line's latest access, plus a hash map from line to that time:
+ * the distance is the count of 1s after it, O(log n) per access.  When
+ * the time axis fills up, the live stamps are renumbered in order by a
+ * linear bucket pass (amortised O(1) per access), so memory stays
+ * proportional to the distinct lines of a set.
+ *
+ * Like cache.h this is a TraceSink: attach stackdist_sink() as
+ * CPUOptions.trace and every LOAD/STORE of the run is recorded.  Reads and
+ * writes count alike (write-allocate).
+ */
+
+typedef struct {
+    uint32_t line_size;   /* bytes per line (power of two, >= a word)  */
+    uint32_t sets;        /* power of two; 1 = fully associative       */
+} StackDistConfig;
+
+typedef struct {
+    uint32_t *tree;       /* Fenwick tree, 1-based, over time stamps   */
+    uint32_t  capacity;   /* time stamps before the next renumbering   */
+    uint32_t  now;        /* next time stamp                           */
+    uint32_t  live;       /* distinct lines seen (1s in the tree)      */
+    uint32_t *key;        /* open-addressed map: line ...              */
+    uint32_t *stamp;      /* ... -> latest time, UINT32_MAX = free     */
+    uint32_t  map_size;   /* power of two, kept at most half full      */
+} StackDistStack;
+
+typedef struct {
+    StackDistConfig  cfg;
+    const TraceSink *next;       /* events are forwarded here if non-NULL */
+
+    uint32_t        offset_bits; /* log2(line_size)                       */
+    StackDistStack *stacks;      /* cfg.sets of them                      */
+    uint64_t       *hist;        /* hist[d]: accesses at distance d       */
+    size_t          hist_len;    /* entries allocated                     */
+    uint32_t        max_dist;    /* largest finite distance seen          */
+    uint64_t        accesses;
+    uint64_t        cold;        /* first touches of a line               */
+} StackDist;
+
+/*
+ * Set `sd` up for `cfg`; next may be NULL.  Returns 0, or -1 with a
+ * "stackdist error: ..." message if the geometry is invalid.  Release
+ * with stackdist_free.
+ */
+int stackdist_init(StackDist *sd, const StackDistConfig *cfg,
+                   const TraceSink *next);
+
+void stackdist_free(StackDist *sd);
+
+/* Record an access to byte address `addr`.  Returns its stack distance
+ * (within its set), or UINT32_MAX for a cold miss. */
+uint32_t stackdist_access(StackDist *sd, uint32_t addr);
+
+/* Sink that records the LOADs and STOREs of a run (then sd->next). */
+TraceSink stackdist_sink(StackDist *sd);
+
+/* Misses of an LRU cache with `ways` lines per set (per stack). */
+uint64_t stackdist_misses(const StackDist *sd, uint32_t ways);
+
+/*
+ * "STACK DISTANCE: ..." summary and the miss-ratio curve: misses and miss
+ * ratio at 1, 2, 4, ... ways (lines, fully associative) until only cold
+ * misses are left.
+ */
+void stackdist_print_curve(const StackDist *sd, FILE *out);
+
+#endif /* STACKDIST_H */
@@ -0,0 +1,108 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ir.h"
+#include "alu.h"
+
+/*
+ * Trace sinks — where the CPU reports each dispatched instruction.
+ *
+ * The CPU never formats anything itself.  For every instruction it fills a
+ * TraceEvent and hands it to the sink selected for the run; with no sink
+ * attached (trace off) the event is never built, so the hot loop does no
+ * formatting and no stdio at all.
+ *
+ * Built-in sinks:
+ *   - text:   the classic "[CPU pc=N] ..." lines, one per instruction.
+ *   - binary: fixed-size little-endian TraceRecords, suitable for
+ *             post-processing tools; `math_sim_bench` prints its speedup
+ *             over the text sink.
+ *
+ * Custom sinks (timing models, profilers, ...) only need an emit callback.
+ */
+
+/* ── Event ────────────────────────────────────────────────────────────────── */
+
+typedef struct {
+    size_t   pc;       /* address of the instruction that ran               */
+    IROpcode op;       /* opcode as written in the program                  */
+    int      dst;      /* operand fields copied from the IRInstr            */
+    int      src;
+    int      addr;
+    int      target;
+    word_t   value;    /* register value written / loaded / stored          */
+    word_t   value_hi; /* high word written by UMULL/SMULL, else 0          */
+    uint32_t mem_addr; /* effective byte address (LOAD/STORE only)          */
+    ALUFlags flags;    /* flags after the instruction                       */
+    int      taken;    /* 1 if a branch was taken                           */
+    unsigned iterations; /* multiply/divide unit steps (iterative mode)     */
+} TraceEvent;
+
+/* ── Sink ─────────────────────────────────────────────────────────────────── */
+
+typedef struct {
+    void (*emit)(void *ctx, const TraceEvent *ev);
+    void  *ctx;
+} TraceSink;
+
+/* Human-readable text lines written to `out`. */
+TraceSink trace_sink_text(FILE *out);
+
+/* Compact binary TraceRecords written to `out`. */
+TraceSink trace_sink_binary(FILE *out);
+
+/* ── Binary record layout ─────────────────────────────────────────────────── */
+
+/*
+ * One record per instruction, TRACE_RECORD_SIZE bytes, every field
+ * little-endian whatever the host: 20 bytes, or 28 on the 64-bit machine,
+ * which appends the upper halves of value and aux.
+ *
+ *   offset  0  pc        u32
+ *           4  op        u8
+ *           5  dst       u8    operand fields of the IRInstr; addr is the
+ *           6  src       u8    high-word register of UMULL/SMULL and the
+ *           7  addr      u8    multiplier of MLA
+ *           8  value     u32   low 32 bits of the value written
+ *          12  aux       u32   branch target (JMP/JZ/JNZ), byte address
+ *                              (LOAD/STORE), low 32 bits of the high word
+ *                              (UMULL/SMULL), else 0
+ *          16  bits      u8    [3:0] ALUFlags.nzcv (N=bit3 .. V=bit0),
+ *                              [4] branch taken; bytes 17..19 are zero
+ *          20  value_hi  u32   (WORD_BITS > 32) upper half of value
+ *          24  aux_hi    u32   (WORD_BITS > 32) upper half of the high word
+ *
+ * Narrower machines zero-extend into the 32-bit fields.  TraceRecord is the
+ * decoded form; the struct itself is never written.
+ */
+#if WORD_BITS > 32
+#  define TRACE_RECORD_SIZE 28
+#else
+#  define TRACE_RECORD_SIZE 20
+#endif
+
+typedef struct {
+    uint32_t pc;
+    uint8_t  op;
+    uint8_t  dst;
+    uint8_t  src;
+    uint8_t  addr;
+    uint32_t value;
+    uint32_t aux;
+    uint8_t  bits;
+#if WORD_BITS > 32
+    uint32_t value_hi;
+    uint32_t aux_hi;
+#endif
+} TraceRecord;
+
+/* Serialise `rec` into buf[0 .. TRACE_RECORD_SIZE) in the layout above. */
+void trace_record_encode(const TraceRecord *rec, unsigned char *buf);
+
+/* Parse one record written by the binary sink back into `rec`. */
+void trace_record_decode(const unsigned char *buf, TraceRecord *rec);
+
+#endif /* TRACE_H */
@@ -0,0 +1,59 @@
+#ifndef WORD_H
+#define WORD_H
+
+#include <inttypes.h>
+#include <stdint.h>
+
+/*
+ * Machine word — the width of the simulated machine, fixed at compile time.
+ *
+ * Build with -DWORD_BITS=8, 16, 32 (the default) or 64; the Makefile
+ * passes WORD_BITS through.  Every translation unit that touches machine
+ * words (ALU, register file, memory word access, flag logic, the cores) is
+ * written against the macros below, so each build is specialised for one
+ * width with no runtime width checks.  Mixing objects built with different
+ * widths is not supported: `make clean` when changing it.
+ *
+ * Backends tied to 32-bit host instructions (the JIT and the SIMD lanes of
+ * cpu_batch) are compiled in only when WORD_BITS is 32; other widths fall
+ * back to the interpreter and the scalar lane loop.
+ */
+
+#ifndef WORD_BITS
+#  define WORD_BITS 32
+#endif
+
+#if WORD_BITS == 8
+typedef uint8_t  word_t;
+typedef int8_t   sword_t;
+#  define WORD_LOG2  3
+#  define PRIuWORD   PRIu8
+#  define PRIxWORD   PRIx8
+#elif WORD_BITS == 16
+typedef uint16_t word_t;
+typedef int16_t  sword_t;
+#  define WORD_LOG2  4
+#  define PRIuWORD   PRIu16
+#  define PRIxWORD   PRIx16
+#elif WORD_BITS == 32
+typedef uint32_t word_t;
+typedef int32_t  sword_t;
+#  define WORD_LOG2  5
+#  define PRIuWORD   PRIu32
+#  define PRIxWORD   PRIx32
+#elif WORD_BITS == 64
+typedef uint64_t word_t;
+typedef int64_t  sword_t;
+#  define WORD_LOG2  6
+#  define PRIuWORD   PRIu64
+#  define PRIxWORD   PRIx64
+#else
+#  error "WORD_BITS must be 8, 16, 32 or 64"
+#endif
+
+#define WORD_BYTES  (WORD_BITS / 8)
+#define WORD_MSB    (WORD_BITS - 1)             /* sign bit position     */
+#define WORD_MAX    ((word_t)~(word_t)0)        /* all ones              */
+#define WORD_SMIN   ((word_t)((word_t)1 << WORD_MSB))  /* most negative  */
+
+#endif /* WORD_H */